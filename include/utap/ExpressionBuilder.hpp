@@ -25,7 +25,10 @@
 #include "AbstractBuilder.hpp"
 #include "utap.h"
 
+#include <memory_resource>
 #include <stack>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <cassert>
 
@@ -53,9 +56,12 @@ namespace UTAP
         class ExpressionFragments
         {
         private:
-            std::vector<expression_t> data;
+            std::pmr::vector<expression_t> data;
 
         public:
+            explicit ExpressionFragments(std::pmr::memory_resource* resource = std::pmr::get_default_resource()):
+                data{resource}
+            {}
             expression_t& operator[](int idx) { return data[data.size() - idx - 1]; }
             void push(expression_t e) { data.push_back(e); }
             void pop() { data.pop_back(); }
@@ -66,9 +72,12 @@ namespace UTAP
         class TypeFragments
         {
         private:
-            std::vector<type_t> data;
+            std::pmr::vector<type_t> data;
 
         public:
+            explicit TypeFragments(std::pmr::memory_resource* resource = std::pmr::get_default_resource()):
+                data{resource}
+            {}
             type_t& operator[](int idx) { return data[data.size() - idx - 1]; }
             void push(type_t value) { data.push_back(value); }
             void pop()
@@ -93,6 +102,20 @@ namespace UTAP
         /** Frame stack. */
         std::stack<frame_t> frames;
 
+        /** Names of the type definitions visible from the frame stack
+            with their number of declarations. The keys refer to the
+            names of the symbols in the frames. */
+        std::unordered_map<std::string_view, uint32_t> typeNames;
+
+        /** Frames whose type definitions are counted in typeNames. */
+        std::vector<frame_t> typeFrames;
+
+        /** Type definition names in the order they were counted. */
+        std::vector<std::string_view> typeNameList;
+
+        /** Sizes of typeFrames and typeNameList at each pushFrame. */
+        std::vector<std::pair<size_t, size_t>> typeScopes;
+
         /** Pointer to the document under construction. */
         Document& document;
 
@@ -108,6 +131,9 @@ namespace UTAP
         /** Pop the topmost frame. */
         void popFrame();
 
+        /** Record a type definition added to the topmost frame. */
+        void addTypeName(const symbol_t&);
+
         bool resolve(const std::string&, symbol_t&) const;
 
         expression_t makeConstant(int value) const;
@@ -120,6 +146,13 @@ namespace UTAP
          */
         type_t applyPrefix(PREFIX, type_t type);
 
+        /**
+         * Adds the symbols \a expr may read to \a dependencies, together
+         * with the symbols read by the initialisers of the variables and
+         * by the bodies of the functions among them, transitively.
+         */
+        static void collectDependencies(std::set<symbol_t>& dependencies, expression_t expr);
+
         /**
          * If this method returns true, it is allowed to access the
          * private identifiers of a process by prefixing the
@@ -136,9 +169,12 @@ namespace UTAP
         ExpressionFragments& getExpressions();
 
         void addPosition(uint32_t position, uint32_t offset, uint32_t line, const std::string& path) override;
+        void addText(uint32_t position, std::string_view text) override;
 
         void handleError(const TypeException&) override;
         void handleWarning(const TypeException&) override;
+        void handleError(const char* msg) override;
+        void handleWarning(const char* msg) override;
         void typeDuplicate() override;
         void typePop() override;
         void typeBool(PREFIX) override;
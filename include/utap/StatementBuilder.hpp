@@ -62,7 +62,7 @@ namespace UTAP
         virtual variable_t* addVariable(type_t type, const std::string& name, expression_t init, position_t pos) = 0;
         virtual bool addFunction(type_t type, const std::string& name, position_t pos) = 0;
 
-        static void collectDependencies(std::set<symbol_t>&, expression_t);
+        using ExpressionBuilder::collectDependencies;
         static void collectDependencies(std::set<symbol_t>&, type_t);
 
     public:
@@ -0,0 +1,134 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_ASYNCPARSE_H
+#define UTAP_ASYNCPARSE_H
+
+#include "utap/document.h"
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+namespace UTAP
+{
+    /** Progress of a parse reported by parseXMLFileAsync and parseXMLBufferAsync. */
+    struct parse_progress_t
+    {
+        enum phase_t { PARSING, TYPE_CHECKING, DONE };
+        phase_t phase{PARSING};
+        size_t bytes{0};     /**< Bytes of the input consumed */
+        size_t total{0};     /**< Size of the input, or 0 if unknown */
+        size_t templates{0}; /**< Templates parsed */
+    };
+
+    struct parse_options_t
+    {
+        bool newxta{true};
+        std::vector<std::filesystem::path> libpaths;
+        /** Called from the parsing thread after each template, every
+            64 KiB of input and at the start of every phase. */
+        std::function<void(const parse_progress_t&)> progress;
+        /** Runs the parse task; a new thread is started if empty. */
+        std::function<void(std::function<void()>)> executor;
+    };
+
+    /**
+     * Parses and type checks an XML model in the background, like
+     * parseXMLFile. The future holds the document (check its errors),
+     * or an exception if the file cannot be read. The XTA parser is not
+     * reentrant, thus background parses take turns in it element by
+     * element with each other and with the synchronous parse functions;
+     * reading the XML and type checking overlap.
+     */
+    std::future<std::unique_ptr<Document>> parseXMLFileAsync(std::filesystem::path file,
+                                                             parse_options_t options = {});
+
+    /** Parses and type checks an XML model held in \a buffer in the background. */
+    std::future<std::unique_ptr<Document>> parseXMLBufferAsync(std::string buffer, parse_options_t options = {});
+
+    /**
+     * Push interface for XML models arriving in chunks, e.g. over a pipe
+     * or a socket: the chunks are parsed in the background as they are
+     * fed, thus the templates at the start of the model are built while
+     * the rest is still being received. At most \a capacity bytes are
+     * buffered (or one larger chunk): feed() blocks until the parser has
+     * consumed enough. Feeding and finishing must happen on one thread,
+     * and the executor of the options must not run the parse inline.
+     *
+     * A session holds the XTA parser only while it parses one element,
+     * never while it waits for input, thus one thread may feed several
+     * sessions and finish them in any order, and parse synchronously
+     * while sessions are open, as long as the executor runs the parses
+     * of all open sessions at once.
+     *
+     * Example:
+     * \code
+     * auto session = ParseSession{};
+     * while ((n = read(fd, buffer, sizeof buffer)) > 0)
+     *     session.feed({buffer, n});
+     * auto document = session.finish();
+     * \endcode
+     */
+    class ParseSession
+    {
+    public:
+        explicit ParseSession(parse_options_t options = {}, size_t capacity = 1 << 20);
+        ParseSession(const ParseSession&) = delete;
+        ParseSession& operator=(const ParseSession&) = delete;
+        /** Abandons the parse if it was not finished. */
+        ~ParseSession();
+
+        /** Appends a chunk of the model; ignored once the parser has stopped. */
+        void feed(std::string_view chunk);
+
+        /**
+         * Marks the end of the input and waits for the parsed and type
+         * checked document. Throws if the XML reader could not be created.
+         */
+        std::unique_ptr<Document> finish();
+
+    private:
+        const size_t capacity;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<std::string> chunks;
+        size_t offset{0};    // consumed bytes of the first chunk
+        size_t buffered{0};  // unconsumed bytes in chunks
+        bool closed{false};  // no more input
+        bool stopped{false}; // the parser does not read anymore
+        std::future<std::unique_ptr<Document>> result;
+
+        int read(char* buffer, int len);
+        void close();
+    };
+}  // namespace UTAP
+
+#endif /* UTAP_ASYNCPARSE_H */
@@ -25,8 +25,10 @@
 
 #include "utap/common.h"
 
+#include <functional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace UTAP
@@ -101,6 +103,13 @@ namespace UTAP
          */
         virtual void addPosition(uint32_t position, uint32_t offset, uint32_t line, const std::string& path) = 0;
 
+        /**
+         * Called with the text of an element (or of the whole input)
+         * before it is parsed. The first character of the text is at
+         * the given position.
+         */
+        virtual void addText(uint32_t /* position */, std::string_view /* text */) {}
+
         /**
          * Sets the current position. The current position indicates
          * where in the input file the current productions can be
@@ -114,6 +123,10 @@ namespace UTAP
         // Called when a warning is issued
         virtual void handleWarning(const TypeException&) = 0;
 
+        // Same as above, but without creating an exception for the message
+        virtual void handleError(const char* msg) { handleError(TypeException{msg}); }
+        virtual void handleWarning(const char* msg) { handleWarning(TypeException{msg}); }
+
         /**
          * Must return true if and only if name is registered in the
          * symbol table as a named type, for instance, "int" or "bool" or
@@ -501,6 +514,16 @@ int32_t parseXMLFile(const char* filename, UTAP::ParserBuilder*, bool newxta);
 
 int32_t parseXMLFd(int fd, UTAP::ParserBuilder* pb, bool newxta);
 
+/**
+ * Parse XML input obtained from a read function, which is called
+ * with a buffer and its size and returns the number of bytes stored
+ * in the buffer, 0 at the end of the input or -1 on errors. The input
+ * is consumed incrementally as the document is parsed. Like the file
+ * and fd variants, gzip and zstd compressed input is decompressed on
+ * the fly (if the library is built with zlib and libzstd).
+ */
+int32_t parseXMLInput(const std::function<int(char*, int)>& read, UTAP::ParserBuilder* pb, bool newxta);
+
 /**
  * Parse properties from a buffer. The properties are reported using
  * the given ParserBuilder and errors are reported using the
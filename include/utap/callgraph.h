@@ -0,0 +1,97 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_CALLGRAPH_H
+#define UTAP_CALLGRAPH_H
+
+#include "utap/document.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * The call graph of the functions of a type checked document, global
+     * and local to templates, with transitive summaries of their effects.
+     *
+     * Functions calling each other recursively form strongly connected
+     * components which share their summary. Components are summarised
+     * bottom up, callees first, with the effects kept as bit sets over the
+     * variables, so every function is summarised once. External
+     * functions are opaque nodes: their effects are unknown, so functions
+     * calling them are neither pure nor idempotent.
+     *
+     * Unlike function_t::changes and function_t::depends, the summaries
+     * do not count the target of a plain assignment as read, nor
+     * functions as variables.
+     */
+    class CallGraph
+    {
+    public:
+        struct node_t
+        {
+            symbol_t symbol;
+            const function_t* function;
+            std::vector<size_t> callees; /**< Indices of the called functions */
+            size_t component;            /**< Index of the strongly connected component */
+
+            bool isExternal() const;
+        };
+
+        struct summary_t
+        {
+            std::set<symbol_t> reads;  /**< Variables read by the function or the functions it calls */
+            std::set<symbol_t> writes; /**< Variables written by the function or the functions it calls */
+            bool external{false};      /**< Calls an external function */
+            bool random{false};        /**< Draws random numbers */
+            bool recursive{false};     /**< Part of a cycle of calls */
+            /** Writes nothing but its local variables and returns the same for the same arguments */
+            bool pure{false};
+            /** Calling it twice in a row has the same effect as calling it once */
+            bool idempotent{false};
+        };
+
+        explicit CallGraph(Document& document);
+
+        const std::vector<node_t>& getNodes() const { return nodes; }
+
+        /** The components as indices of nodes, callees before callers. */
+        const std::vector<std::vector<size_t>>& getComponents() const { return components; }
+
+        /** Returns the index of the node of a function, or -1. */
+        int32_t find(const symbol_t& function) const;
+
+        /** Returns the summary of a function, which must be a node of the graph. */
+        const summary_t& getSummary(const symbol_t& function) const;
+        const summary_t& getSummary(size_t node) const { return summaries[node]; }
+
+    private:
+        std::vector<node_t> nodes;
+        std::vector<std::vector<size_t>> components;
+        std::vector<summary_t> summaries;
+        std::map<symbol_t, size_t> indices;
+    };
+}  // namespace UTAP
+
+#endif /* UTAP_CALLGRAPH_H */
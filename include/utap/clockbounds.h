@@ -0,0 +1,99 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_CLOCKBOUNDS_H
+#define UTAP_CLOCKBOUNDS_H
+
+#include "utap/document.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace UTAP
+{
+    /**
+     * The maximal constants each clock is compared to, per location of
+     * the processes expanded by SystemView, for the LU-extrapolation of
+     * DBM zones.
+     *
+     * The clocks are the global and local clocks and the elements of
+     * clock arrays of constant size, numbered from 1 like the clocks of
+     * a DBM. A guard or invariant x > c or x >= c gives x the lower
+     * bound c, x < c and x <= c give it the upper bound c, and x == c and
+     * x != c give it both. The bounds of the guards of an edge belong to
+     * its source location, and the bounds of a location are propagated
+     * backwards along the edges not resetting the clock to a constant.
+     * Constants are evaluated after binding the template parameters; a
+     * constant or array index without value, a clock read by a function
+     * called in a guard or invariant, and a clock read by an update which
+     * is not a constant reset get the bound DBM::maxValue. A clock with
+     * no bound in a location has the bound none.
+     */
+    class ClockBounds
+    {
+    public:
+        static constexpr int32_t none = -1;
+
+        /** The bounds of a location, by clock. Clocks without bound are omitted. */
+        struct location_bounds_t
+        {
+            std::map<uint32_t, int32_t> lower;
+            std::map<uint32_t, int32_t> upper;
+        };
+
+        explicit ClockBounds(Document& document);
+
+        /** The number of clocks plus one for the reference clock, the dimension of the DBMs. */
+        uint32_t getDimension() const { return clocks.size(); }
+        /** The names of the clocks, like "P(1).x" or "y[2]", where the reference clock is "t(0)". */
+        const std::vector<std::string>& getClocks() const { return clocks; }
+        /** Returns the index of a clock, or -1. */
+        int32_t find(const std::string& name) const;
+
+        /**
+         * Returns true if some guard or invariant constrains the
+         * difference of two clocks. LU-extrapolation is unsound then.
+         */
+        bool hasDiagonals() const { return diagonals; }
+
+        /** The bounds of a location (by state_t::locNr) of a process (by index in SystemView). */
+        const location_bounds_t& getBounds(uint32_t process, uint32_t location) const;
+
+        /**
+         * Raises the bounds, indexed by clock and sized getDimension(),
+         * to the bounds of a location of a process. Accumulating the
+         * locations of every process of a global state gives the bounds
+         * to pass to DBM::extrapolateLU, starting from none.
+         */
+        void addBounds(uint32_t process, uint32_t location, std::vector<int32_t>& lower,
+                       std::vector<int32_t>& upper) const;
+
+    private:
+        std::vector<std::string> clocks;
+        bool diagonals{false};
+        std::vector<std::vector<location_bounds_t>> locations;  // by process and location
+    };
+}  // namespace UTAP
+
+#endif /* UTAP_CLOCKBOUNDS_H */
@@ -0,0 +1,81 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_CLOCKEQUIVALENCE_H
+#define UTAP_CLOCKEQUIVALENCE_H
+
+#include "utap/document.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * Classes of clocks which are provably equal in every reachable
+     * state, e.g. clocks of different processes which are always reset
+     * on the same synchronisation.
+     *
+     * Clocks are the scalar clocks of the processes expanded by
+     * SystemView. All start at zero, so two clocks are equal if every
+     * edge resetting one of them either resets the other to the same
+     * value, or synchronises on a binary channel (or receives on a
+     * broadcast channel) where every possible partner resets the other
+     * to the same value. Clocks with a rate, or which are written by
+     * anything but a constant assignment in an update, are never merged.
+     */
+    struct clock_equivalence_t
+    {
+        struct clock_instance_t
+        {
+            std::string name; /**< Like "P(1).x" for a local clock */
+            symbol_t symbol;
+            int32_t process; /**< The index of the process in SystemView, or -1 for global clocks */
+        };
+
+        /** Classes with more than one clock, in the order of the slots of SystemView. */
+        std::vector<std::vector<clock_instance_t>> classes;
+
+        /** The number of clocks which could be removed. */
+        size_t redundant() const;
+    };
+
+    clock_equivalence_t findEquivalentClocks(Document& document);
+
+    /**
+     * Replaces every clock of the type checked \a document with an
+     * equivalent clock declared before it, and removes it. A local clock
+     * is replaced by a global clock or another local clock of its template
+     * only if the two are equivalent in every process of the template.
+     * Clocks used by functions or by the arguments of processes and
+     * partial instances, or named by an identifier in the queries of the
+     * document or in \a queries, are kept.
+     * @return the names of the removed clocks.
+     */
+    std::vector<std::string> mergeEquivalentClocks(Document& document, const clock_equivalence_t& equivalence,
+                                                   const std::vector<std::string>& queries = {});
+
+    std::ostream& operator<<(std::ostream& os, const clock_equivalence_t& equivalence);
+}  // namespace UTAP
+
+#endif /* UTAP_CLOCKEQUIVALENCE_H */
@@ -0,0 +1,114 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_COSTMODEL_H
+#define UTAP_COSTMODEL_H
+
+#include "utap/document.h"
+
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace UTAP
+{
+    /** Weights of the static cost model; the unit is a simple integer operation. */
+    struct cost_weights_t
+    {
+        double operation{1};       /**< Arithmetic, logical and relational operators */
+        double variable{1};        /**< Reading a variable; constants are free */
+        double arrayIndex{2};      /**< Indexing an array, on top of the index expression */
+        double division{4};        /**< Division and modulo */
+        double floatingPoint{2};   /**< Operators on doubles, and the built-in functions */
+        double clockConstraint{8}; /**< Comparisons involving clocks, which are zone operations */
+        double call{4};            /**< Calling a user function, on top of its body */
+        double loop{10};           /**< Assumed number of iterations of loops in function bodies */
+
+        // Estimated probabilities of conditions being true
+        double equality{0.1};   /**< Of ==, and 1 - equality for != */
+        double ordering{0.5};   /**< Of <, <=, >= and > */
+        double unknown{0.5};    /**< Of any other condition */
+    };
+
+    /**
+     * Static estimate of the cost of evaluating expressions, and of
+     * the probability that conditions hold (their selectivity). The
+     * cost of a function call includes the cost of its body, where
+     * loops are assumed to run cost_weights_t::loop times. Function
+     * costs are cached, thus the model must not outlive the document.
+     */
+    class CostModel
+    {
+    public:
+        explicit CostModel(cost_weights_t weights = {}): weights{weights} {}
+
+        const cost_weights_t& getWeights() const { return weights; }
+
+        double cost(const expression_t& expr);
+        double cost(const function_t& fun);
+        double selectivity(const expression_t& expr) const;
+
+        /** Expected cost of evaluating the conjunction of \a conjuncts from
+            left to right, stopping at the first false one. */
+        double expectedCost(const std::vector<expression_t>& conjuncts);
+
+    private:
+        cost_weights_t weights;
+        std::unordered_map<const function_t*, double> functions;
+    };
+
+    /** Returns true if evaluating \a expr may fail, i.e. index an array
+        out of bounds, divide by zero or fail inside a function call. */
+    bool mayFail(const expression_t& expr);
+
+    /** The estimated effect of reordering the conjuncts of one template. */
+    struct conjunct_savings_t
+    {
+        std::string templ;
+        size_t expressions{0}; /**< Guards and invariants with more than one conjunct */
+        size_t reordered{0};   /**< Of which the order was changed */
+        double before{0};      /**< Summed expected cost of those expressions before */
+        double after{0};       /**< ... and after reordering */
+    };
+
+    /**
+     * Returns \a expr with its conjuncts ordered by increasing
+     * cost / (1 - selectivity), which minimises the expected cost of
+     * evaluating them, or \a expr itself if the order is unchanged.
+     *
+     * The result is equivalent: conjuncts with side effects keep their
+     * place, and a conjunct which may fail (an array access, a division
+     * or a function call, e.g. "a[i]" in "i < N && a[i] > 0") stays
+     * after all conjuncts it originally followed. Constant true
+     * conjuncts are dropped.
+     */
+    expression_t reorderConjuncts(const expression_t& expr, CostModel& model);
+
+    /** Reorders the guards and invariants of all templates of the type
+        checked \a document and returns the savings per template. */
+    std::vector<conjunct_savings_t> reorderConjuncts(Document& document, CostModel& model);
+
+    std::ostream& operator<<(std::ostream& os, const conjunct_savings_t& savings);
+}  // namespace UTAP
+
+#endif /* UTAP_COSTMODEL_H */
@@ -0,0 +1,181 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_COUNTED_H
+#define UTAP_COUNTED_H
+
+#include <atomic>
+#include <functional>  // less
+#include <utility>     // exchange, forward
+#include <cstddef>
+#include <cstdint>
+
+namespace UTAP
+{
+    /**
+     * Base class of the reference counted objects behind the handles
+     * expression_t, type_t, symbol_t and frame_t.
+     *
+     * The reference count is stored in the object itself, thus no
+     * separate control block is allocated and no weak count is
+     * maintained. By default the count is updated atomically. When
+     * the library is configured with UTAP_NONATOMIC_REFCOUNT (CMake
+     * option ATOMIC_REFCOUNT=OFF) the count is a plain integer: this
+     * is only safe when all handles of a document are copied and
+     * destroyed by one thread at a time.
+     *
+     * When compiled with UTAP_REFCOUNT_STATISTICS, the number of
+     * count updates is recorded and can be read with updates().
+     */
+    class counted_t
+    {
+    public:
+#ifdef UTAP_NONATOMIC_REFCOUNT
+        using count_t = uint32_t;
+#else
+        using count_t = std::atomic<uint32_t>;
+#endif
+        /** Returns the number of count updates so far (0 unless statistics are enabled). */
+        static uint64_t updates() noexcept
+        {
+#ifdef UTAP_REFCOUNT_STATISTICS
+            return update_count;
+#else
+            return 0;
+#endif
+        }
+
+    protected:
+        counted_t() noexcept = default;
+        counted_t(const counted_t&) noexcept {}  // a copy is a new object with its own count
+        counted_t& operator=(const counted_t&) noexcept { return *this; }
+        virtual ~counted_t() noexcept = default;
+
+    private:
+        mutable count_t count{0};
+#ifdef UTAP_REFCOUNT_STATISTICS
+        static inline uint64_t update_count = 0;
+#endif
+
+        void acquire() const noexcept
+        {
+#ifdef UTAP_REFCOUNT_STATISTICS
+            ++update_count;
+#endif
+#ifdef UTAP_NONATOMIC_REFCOUNT
+            ++count;
+#else
+            count.fetch_add(1, std::memory_order_relaxed);
+#endif
+        }
+
+        /** Returns true if the last reference was released. */
+        bool release() const noexcept
+        {
+#ifdef UTAP_REFCOUNT_STATISTICS
+            ++update_count;
+#endif
+#ifdef UTAP_NONATOMIC_REFCOUNT
+            return --count == 0;
+#else
+            return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+#endif
+        }
+
+        template <typename T>
+        friend class counted_ptr;
+    };
+
+    /**
+     * Intrusive smart pointer to a counted_t object. Only the
+     * operations dereferencing the pointer require \a T to be a
+     * complete type, thus it can be used for pImpl handles.
+     */
+    template <typename T>
+    class counted_ptr
+    {
+    private:
+        counted_t* ptr{nullptr};
+
+    public:
+        counted_ptr() noexcept = default;
+        counted_ptr(std::nullptr_t) noexcept {}
+        explicit counted_ptr(T* p) noexcept: ptr{p}
+        {
+            if (ptr)
+                ptr->acquire();
+        }
+        counted_ptr(const counted_ptr& other) noexcept: ptr{other.ptr}
+        {
+            if (ptr)
+                ptr->acquire();
+        }
+        counted_ptr(counted_ptr&& other) noexcept: ptr{std::exchange(other.ptr, nullptr)} {}
+        ~counted_ptr() noexcept
+        {
+            if (ptr && ptr->release())
+                delete ptr;
+        }
+        counted_ptr& operator=(const counted_ptr& other) noexcept
+        {
+            counted_ptr{other}.swap(*this);
+            return *this;
+        }
+        counted_ptr& operator=(counted_ptr&& other) noexcept
+        {
+            counted_ptr{std::move(other)}.swap(*this);
+            return *this;
+        }
+        counted_ptr& operator=(std::nullptr_t) noexcept
+        {
+            counted_ptr{}.swap(*this);
+            return *this;
+        }
+        void swap(counted_ptr& other) noexcept { std::swap(ptr, other.ptr); }
+
+        T* get() const noexcept { return static_cast<T*>(ptr); }
+        T* operator->() const noexcept { return get(); }
+        T& operator*() const noexcept { return *get(); }
+        explicit operator bool() const noexcept { return ptr != nullptr; }
+        /** Returns true if this is the only handle to the object. */
+        bool unique() const noexcept { return ptr != nullptr && ptr->count == 1; }
+
+        friend bool operator==(const counted_ptr& a, const counted_ptr& b) noexcept { return a.ptr == b.ptr; }
+        friend bool operator!=(const counted_ptr& a, const counted_ptr& b) noexcept { return a.ptr != b.ptr; }
+        friend bool operator<(const counted_ptr& a, const counted_ptr& b) noexcept
+        {
+            return std::less<const counted_t*>{}(a.ptr, b.ptr);
+        }
+        friend bool operator==(const counted_ptr& a, std::nullptr_t) noexcept { return a.ptr == nullptr; }
+        friend bool operator!=(const counted_ptr& a, std::nullptr_t) noexcept { return a.ptr != nullptr; }
+        friend bool operator==(std::nullptr_t, const counted_ptr& a) noexcept { return a.ptr == nullptr; }
+        friend bool operator!=(std::nullptr_t, const counted_ptr& a) noexcept { return a.ptr != nullptr; }
+    };
+
+    /** Allocates a new counted object, similar to std::make_shared. */
+    template <typename T, typename... Args>
+    counted_ptr<T> make_counted(Args&&... args)
+    {
+        return counted_ptr<T>{new T(std::forward<Args>(args)...)};
+    }
+}  // namespace UTAP
+
+#endif /* UTAP_COUNTED_H */
@@ -0,0 +1,161 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_DBM_H
+#define UTAP_DBM_H
+
+#include <iosfwd>
+#include <new>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace UTAP
+{
+    /** Allocator of cache line aligned storage. */
+    template <typename T>
+    struct cache_aligned_allocator
+    {
+        using value_type = T;
+        static constexpr std::size_t alignment = 64;
+
+        cache_aligned_allocator() noexcept = default;
+        template <typename U>
+        cache_aligned_allocator(const cache_aligned_allocator<U>&) noexcept
+        {}
+        T* allocate(std::size_t n)
+        {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignment}));
+        }
+        void deallocate(T* p, std::size_t) noexcept { ::operator delete(p, std::align_val_t{alignment}); }
+        template <typename U>
+        bool operator==(const cache_aligned_allocator<U>&) const noexcept
+        {
+            return true;
+        }
+        template <typename U>
+        bool operator!=(const cache_aligned_allocator<U>&) const noexcept
+        {
+            return false;
+        }
+    };
+
+    /**
+     * Difference bound matrix: a zone over the clocks 1 to dimension-1,
+     * where clock 0 is the reference clock which is always zero. Entry
+     * (i,j) bounds the difference x_i - x_j.
+     *
+     * A bound is packed into one integer, raw = 2 * value + (weak ? 1 : 0),
+     * so that the tighter of two bounds is the smaller integer. Values
+     * must stay within +-maxValue for the sums not to overflow.
+     *
+     * The rows are padded with unbounded entries to a multiple of the
+     * cache line and allocated cache line aligned, so that the kernels
+     * work on whole vectors. The AVX2 kernels are used when the processor
+     * supports them, unless another kernel is selected with setKernel().
+     *
+     * All operations keep the matrix closed (canonical), except
+     * constrain() when told not to close it, and an empty zone is marked
+     * by a negative (0,0) entry.
+     */
+    class DBM
+    {
+    public:
+        using raw_t = int32_t;
+
+        static constexpr int32_t maxValue = (1 << 28) - 1;
+        static constexpr raw_t unbounded = INT32_MAX - 1; /**< (infinity, <) */
+        static constexpr raw_t zero = 1;                  /**< (0, <=) */
+
+        static constexpr raw_t bound(int32_t value, bool strict) { return value * 2 + (strict ? 0 : 1); }
+        static constexpr int32_t valueOf(raw_t raw) { return raw >> 1; }
+        static constexpr bool isStrict(raw_t raw) { return (raw & 1) == 0; }
+        /** The sum of two bounds, unbounded if either is. */
+        static constexpr raw_t add(raw_t a, raw_t b)
+        {
+            return a == unbounded || b == unbounded ? unbounded : a + b - ((a | b) & 1);
+        }
+
+        enum kernel_t { SCALAR, AVX2 };
+        static bool isSupported(kernel_t kernel);
+        static kernel_t getKernel();
+        /** Selects the kernels of all DBMs, returns false if they are not supported. */
+        static bool setKernel(kernel_t kernel);
+
+        /** The zone where all clocks are zero. */
+        static DBM createZero(uint32_t dimension);
+        /** The zone of all non-negative clock valuations. */
+        static DBM createUnbounded(uint32_t dimension);
+
+        uint32_t getDimension() const { return dimension; }
+        raw_t operator()(uint32_t i, uint32_t j) const { return bounds[i * stride + j]; }
+        bool isEmpty() const { return bounds[0] < zero; }
+
+        /** Closes the matrix (Floyd-Warshall), returns false if the zone is empty. */
+        bool close();
+        /**
+         * Adds x_i - x_j < or <= the bound, returns false if the zone
+         * becomes empty. The incremental closure, skipped when \a close is
+         * false, requires the matrix to be closed beforehand.
+         */
+        bool constrain(uint32_t i, uint32_t j, raw_t bound, bool close = true);
+        /** Removes the upper bounds of the clocks (delay). */
+        void up();
+        /** Removes the lower bounds of the clocks (past). */
+        void down();
+        /** Resets a clock to a non-negative value. */
+        void reset(uint32_t clock, int32_t value = 0);
+
+        /** Returns true if this zone is included in \a other, of the same dimension. */
+        bool isSubsetOf(const DBM& other) const;
+        /** Returns true if the intersection with \a other, of the same dimension, is not empty. */
+        bool intersects(const DBM& other) const;
+        /** Intersects with \a other, of the same dimension, returns false if the result is empty. */
+        bool intersect(const DBM& other);
+
+        /**
+         * Extra+_LU extrapolation with the maximal lower and upper bounds
+         * each clock is compared to, indexed like the clocks (index 0 is
+         * ignored). A negative bound means that the clock is not compared
+         * to any constant in that direction. Sound for models without
+         * constraints on clock differences.
+         */
+        void extrapolateLU(const std::vector<int32_t>& lower, const std::vector<int32_t>& upper);
+
+        bool operator==(const DBM& other) const;
+        bool operator!=(const DBM& other) const { return !(*this == other); }
+
+    private:
+        uint32_t dimension;
+        uint32_t stride; /**< Row length, padded to whole cache lines */
+        std::vector<raw_t, cache_aligned_allocator<raw_t>> bounds;
+
+        explicit DBM(uint32_t dimension);
+        raw_t* row(uint32_t i) { return bounds.data() + i * stride; }
+        const raw_t* row(uint32_t i) const { return bounds.data() + i * stride; }
+        void markEmpty() { bounds[0] = bound(-1, false); }
+    };
+
+    std::ostream& operator<<(std::ostream& os, const DBM& dbm);
+}  // namespace UTAP
+
+#endif /* UTAP_DBM_H */
@@ -0,0 +1,88 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_DEADCODE_H
+#define UTAP_DEADCODE_H
+
+#include "utap/document.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace UTAP
+{
+    /**
+     * Declarations which do not affect the behaviour of a model.
+     *
+     * A variable is live if it is read by a guard, an invariant, a
+     * synchronisation, a rate, a channel priority, a process argument or
+     * a query, or if it is read by an update (including the before and
+     * after updates) or initialiser of a live variable; anything
+     * else is write-only or unreferenced. Variables which cannot be
+     * removed without rewriting a function body, i.e. the ones used
+     * by a live function, are kept. Functions are dead if no live code
+     * calls them, and templates if no process instantiates them.
+     *
+     * Entities are named like in model_diff_t: global declarations by
+     * their name and template members as "Template.name".
+     */
+    struct dead_code_t
+    {
+        enum entity_t { VARIABLE, CLOCK, FUNCTION, TEMPLATE };
+
+        struct entry_t
+        {
+            entity_t entity;
+            std::string name;
+            uint32_t bits{0};      /**< Bits of state of one instance of a variable */
+            uint32_t instances{1}; /**< Processes owning the variable, 1 for globals */
+        };
+
+        std::vector<entry_t> entries;
+
+        bool empty() const { return entries.empty(); }
+        /** The bits saved in the state vector by removing the variables. */
+        uint64_t stateBits() const;
+        /** The clocks saved, i.e. the reduction of the dimension of zones. */
+        uint32_t clocks() const;
+    };
+
+    /**
+     * Finds the dead declarations of the type checked \a document.
+     * The identifiers in the queries of the document and in \a queries
+     * are considered read.
+     */
+    dead_code_t findDeadCode(Document& document, const std::vector<std::string>& queries = {});
+
+    /**
+     * Like findDeadCode(), and removes the dead declarations from the
+     * document together with the updates assigning dead variables.
+     * Removed templates take their partial instances along.
+     */
+    dead_code_t eliminateDeadCode(Document& document, const std::vector<std::string>& queries = {});
+
+    std::ostream& operator<<(std::ostream& os, const dead_code_t& dead);
+}  // namespace UTAP
+
+#endif /* UTAP_DEADCODE_H */
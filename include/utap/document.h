@@ -31,7 +31,11 @@
 #include <deque>
 #include <list>
 #include <map>
+#include <memory>  // unique_ptr
+#include <memory_resource>
+#include <mutex>
 #include <optional>
+#include <string_view>
 #include <vector>
 
 namespace UTAP
@@ -114,12 +118,15 @@ namespace UTAP
     */
     struct function_t
     {
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
         symbol_t uid;                                  /**< The symbol of the function. */
         std::set<symbol_t> changes{};                  /**< Variables changed by this function. */
         std::set<symbol_t> depends{};                  /**< Variables the function depends on. */
-        std::list<variable_t> variables{};             /**< Local variables. */
+        std::pmr::list<variable_t> variables{};        /**< Local variables. */
         std::unique_ptr<BlockStatement> body{nullptr}; /**< Pointer to the block. */
         function_t() = default;
+        explicit function_t(const allocator_type& alloc);
         std::string toString() const;  // used to write the XML file
     };
 
@@ -165,12 +172,17 @@ namespace UTAP
     struct template_t;
     struct declarations_t
     {
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
         frame_t frame;
-        std::list<variable_t> variables; /**< Variables */
-        std::list<function_t> functions; /**< Functions */
-        std::list<progress_t> progress;  /**< Progress measures */
-        std::list<iodecl_t> iodecl;
-        std::list<gantt_t> ganttChart;
+        std::pmr::list<variable_t> variables; /**< Variables */
+        std::pmr::list<function_t> functions; /**< Functions */
+        std::pmr::list<progress_t> progress;  /**< Progress measures */
+        std::pmr::list<iodecl_t> iodecl;
+        std::pmr::list<gantt_t> ganttChart;
+
+        declarations_t() = default;
+        explicit declarations_t(const allocator_type& alloc);
 
         /** Add function declaration. */
         bool addFunction(type_t type, std::string name, position_t, function_t*&);
@@ -327,17 +339,30 @@ namespace UTAP
      * accept (they must not depend on any free process parameters).
      *
      * If i is an instance, then i.uid.getData() == i.
+     *
+     * Instances are allocator-aware: when stored in a Document, the
+     * mapping is allocated from the memory resource of the document.
      */
     struct instance_t
     {
-        symbol_t uid;                             /**< The name */
-        frame_t parameters;                       /**< The parameters */
-        std::map<symbol_t, expression_t> mapping; /**< The arguments */
-        size_t arguments;
-        size_t unbound;
-        struct template_t* templ;
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+        symbol_t uid;                                  /**< The name */
+        frame_t parameters;                            /**< The parameters */
+        std::pmr::map<symbol_t, expression_t> mapping; /**< The arguments */
+        size_t arguments{0};
+        size_t unbound{0};
+        struct template_t* templ{nullptr};
         std::set<symbol_t> restricted; /**< Restricted variables */
 
+        instance_t() = default;
+        explicit instance_t(const allocator_type& alloc): mapping{alloc} {}
+        instance_t(const instance_t&) = default;
+        instance_t(const instance_t& other, const allocator_type& alloc);
+        instance_t(instance_t&&) = default;
+        instance_t& operator=(const instance_t&) = default;
+        instance_t& operator=(instance_t&&) = default;
+
         std::string writeMapping() const;
         std::string writeParameters() const;
         std::string writeArguments() const;
@@ -354,13 +379,18 @@ namespace UTAP
 
     struct template_t : public instance_t, declarations_t
     {
-        symbol_t init;                          /**< The initial location */
-        frame_t templateset;                    /**< Template set decls */
-        std::deque<state_t> states;             /**< Locations */
-        std::deque<branchpoint_t> branchpoints; /**< Branchpoints */
-        std::deque<edge_t> edges;               /**< Edges */
+        using allocator_type = instance_t::allocator_type;
+
+        symbol_t init;                               /**< The initial location */
+        frame_t templateset;                         /**< Template set decls */
+        std::pmr::deque<state_t> states;             /**< Locations */
+        std::pmr::deque<branchpoint_t> branchpoints; /**< Branchpoints */
+        std::pmr::deque<edge_t> edges;               /**< Edges */
         std::vector<expression_t> dynamicEvals;
-        bool isTA;
+        bool isTA{false};
+
+        template_t() = default;
+        explicit template_t(const allocator_type& alloc);
 
         int addDynamicEval(expression_t t)
         {
@@ -385,10 +415,10 @@ namespace UTAP
         std::deque<condition_t> conditions;   /**< Conditions */
         std::string type;
         std::string mode;
-        bool hasPrechart;
-        bool dynamic;
-        int dynindex;
-        bool isDefined;
+        bool hasPrechart{false};
+        bool dynamic{false};
+        int dynindex{0};
+        bool isDefined{false};
 
         /** Add another instance line to template. */
         instanceLine_t& addInstanceLine();
@@ -510,20 +540,33 @@ namespace UTAP
     {
     public:
         Document();
+        /**
+         * Creates a document whose templates, declarations, locations,
+         * edges and instances are allocated from \a resource. The
+         * resource must outlive the document. Passing a monotonic buffer
+         * resource allows a whole model to be released at once.
+         */
+        explicit Document(std::pmr::memory_resource* resource);
         Document(const Document&);
         virtual ~Document() noexcept;
 
+        /** Returns the memory resource used by the document. */
+        std::pmr::memory_resource* getMemoryResource() const { return resource; }
+
         /** Returns the global declarations of the document. */
         declarations_t& getGlobals();
 
         /** Returns the templates of the document. */
-        std::list<template_t>& getTemplates();
+        std::pmr::list<template_t>& getTemplates();
         const template_t* findTemplate(const std::string& name) const;
         std::vector<template_t*>& getDynamicTemplates();
         template_t* getDynamicTemplate(const std::string& name);
 
         /** Returns the processes of the document. */
-        std::list<instance_t>& getProcesses();
+        std::pmr::list<instance_t>& getProcesses();
+
+        /** Returns the partial instances of templates, e.g. "Q = P(1);". */
+        std::pmr::list<instance_t>& getInstances();
 
         options_t& getOptions();
         void setOptions(const options_t& options);
@@ -531,7 +574,20 @@ namespace UTAP
         /** Returns the queries enclosed in the model. */
         queries_t& getQueries();
 
+        /**
+         * Selects whether the position of every line is recorded while
+         * parsing, which is the default. Otherwise only the first line
+         * and the text of every element are kept, and the lines of
+         * errors and warnings are found by scanning the text when they
+         * are read. This saves time and memory when parsing large
+         * models in batch. The lines of input read from a FILE are
+         * not recovered.
+         */
+        void setLineTracking(bool enabled) { lineTracking = enabled; }
+        bool hasLineTracking() const { return lineTracking; }
+
         void addPosition(uint32_t position, uint32_t offset, uint32_t line, const std::string& path);
+        void addText(uint32_t position, std::string_view text);
         const Positions::line_t& findPosition(uint32_t position) const;
 
         variable_t* addVariableToFunction(function_t*, frame_t, type_t, const std::string&, expression_t initital,
@@ -625,6 +681,7 @@ namespace UTAP
         }
 
     protected:
+        std::pmr::memory_resource* resource;
         bool hasUrgentTrans;
         bool hasPriorities;
         bool hasStrictInv;
@@ -633,23 +690,23 @@ namespace UTAP
         bool hasGuardOnRecvBroadcast;
         int defaultChanPriority;
         std::list<chan_priority_t> chanPriorities;
-        std::map<std::string, int> procPriority;
+        std::pmr::map<std::string, int> procPriority;
         int syncUsed;  // see typechecker
 
         // The list of templates.
-        std::list<template_t> templates;
+        std::pmr::list<template_t> templates;
         // List of dynamic template
-        std::list<template_t> dynamicTemplates;
+        std::pmr::list<template_t> dynamicTemplates;
         std::vector<template_t*> dynamicTemplatesVec;
 
         // The list of template instances.
-        std::list<instance_t> instances;
+        std::pmr::list<instance_t> instances;
 
-        std::list<instance_t> lscInstances;
+        std::pmr::list<instance_t> lscInstances;
         bool modified;
 
         // List of processes.
-        std::list<instance_t> processes;
+        std::pmr::list<instance_t> processes;
 
         // Global declarations
         declarations_t global;
@@ -659,7 +716,7 @@ namespace UTAP
         options_t modelOptions;
         queries_t queries;
 
-        variable_t* addVariable(std::list<variable_t>& variables, frame_t frame, type_t type, const std::string&,
+        variable_t* addVariable(std::pmr::list<variable_t>& variables, frame_t frame, type_t type, const std::string&,
                                 position_t);
 
         std::string location;
@@ -672,10 +729,15 @@ namespace UTAP
         void* lastLibrary();
         void addError(position_t, std::string msg, std::string ctx = "");
         void addWarning(position_t, const std::string& msg, const std::string& ctx = "");
-        bool hasErrors() const { return !errors.empty(); }
-        bool hasWarnings() const { return !warnings.empty(); }
-        const std::vector<error_t>& getErrors() const { return errors; }
-        const std::vector<error_t>& getWarnings() const { return warnings; }
+        /** Adds an error with the static message id \a id, like
+            "$Expression_of_type %s $cannot_be_used_as_an_invariant": each
+            "%s" is replaced by the next of \a args when it is rendered. */
+        void addError(position_t, const char* id, std::vector<std::string> args, std::string ctx);
+        void addWarning(position_t, const char* id, std::vector<std::string> args, std::string ctx);
+        bool hasErrors() const { return !errorRecords.empty(); }
+        bool hasWarnings() const { return !warningRecords.empty(); }
+        const std::vector<error_t>& getErrors() const { return render(errorRecords, errors); }
+        const std::vector<error_t>& getWarnings() const { return render(warningRecords, warnings); }
         void clearErrors() const;
         void clearWarnings() const;
         bool isModified() const;
@@ -685,10 +747,29 @@ namespace UTAP
         const SupportedMethods& getSupportedMethods() const;
 
     private:
+        /** An error or warning as reported. Its message and the lines of
+            its position are formed only when it is rendered as an error_t. */
+        struct diagnostic_t
+        {
+            position_t position;
+            const char* id; /**< Static message id, see addError() */
+            std::vector<std::string> args;
+            std::string context;
+        };
+
+        /** Appends the diagnostics from \a records not yet in \a rendered.
+            Concurrent readers are serialised by renderMutex. */
+        const std::vector<error_t>& render(const std::vector<diagnostic_t>& records,
+                                           std::vector<error_t>& rendered) const;
+
         // TODO: move errors & warnings to ParserBuilder to get rid of mutable
+        mutable std::vector<diagnostic_t> errorRecords;
+        mutable std::vector<diagnostic_t> warningRecords;
         mutable std::vector<error_t> errors;
         mutable std::vector<error_t> warnings;
+        mutable std::mutex renderMutex;
         Positions positions;
+        bool lineTracking{true};
     };
 }  // namespace UTAP
 
@@ -0,0 +1,125 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_ENGINEVIEW_H
+#define UTAP_ENGINEVIEW_H
+
+#include "utap/document.h"
+
+#include <map>
+#include <utility>  // pair
+#include <vector>
+#include <cstdint>
+
+namespace UTAP
+{
+    /**
+     * Dense, engine oriented view of the templates of a type checked
+     * document. The locations and edges of each template are stored
+     * as structure-of-arrays tables, so that successor generation only
+     * touches contiguous arrays of small integers.
+     *
+     * Expressions (invariants, rates, guards, updates, synchronisation
+     * channels and probability weights) are referred to by their index
+     * in one expression table shared by all templates, and channels by
+     * their index in a channel table. Absent expressions are none.
+     *
+     * The view refers to the document: it must not outlive it and it
+     * must be rebuilt if the templates are modified.
+     */
+    class EngineView
+    {
+    public:
+        static constexpr int32_t none = -1;
+
+        /** Flags of a location. */
+        enum location_flag_t : uint8_t { URGENT_LOCATION = 1, COMMITTED_LOCATION = 2, INITIAL_LOCATION = 4 };
+
+        /** The locations of a template, indexed by state_t::locNr. */
+        struct location_table_t
+        {
+            std::vector<int32_t> invariant;       /**< Invariant expression id */
+            std::vector<int32_t> exponentialRate; /**< Exit rate expression id */
+            std::vector<int32_t> costRate;        /**< Cost rate expression id */
+            std::vector<uint8_t> flags;           /**< Bitwise or of location_flag_t */
+            size_t size() const { return flags.size(); }
+        };
+
+        /**
+         * The edges of a template, sorted by source. Source and
+         * destination indices below the number of locations are
+         * locations, the remaining ones are branchpoints numbered
+         * after the locations (see branchpoint()).
+         */
+        struct edge_table_t
+        {
+            std::vector<int32_t> src;          /**< Source location or branchpoint */
+            std::vector<int32_t> dst;          /**< Destination location or branchpoint */
+            std::vector<int32_t> guard;        /**< Guard expression id */
+            std::vector<int32_t> update;       /**< Assignment expression id */
+            std::vector<int32_t> channel;      /**< Channel id */
+            std::vector<int32_t> channelExpr;  /**< Channel (possibly indexed) expression id */
+            std::vector<int32_t> prob;         /**< Probability weight expression id */
+            std::vector<uint8_t> controllable; /**< Controllable (1) or uncontrollable (0) */
+            /** The synchronisation kind, only meaningful if channel is not none */
+            std::vector<Constants::synchronisation_t> syncKind;
+            std::vector<const edge_t*> edge; /**< The edge in the document */
+            /** first[s] to first[s+1] are the edges leaving source s. */
+            std::vector<uint32_t> first;
+            size_t size() const { return src.size(); }
+            /** The range of edge indices leaving \a source. */
+            std::pair<uint32_t, uint32_t> outgoing(int32_t source) const { return {first[source], first[source + 1]}; }
+        };
+
+        /** The tables of one template. */
+        struct template_view_t
+        {
+            const template_t* templ;
+            location_table_t locations;
+            edge_table_t edges;
+            /** Returns the source/destination index of branchpoint \a bpNr. */
+            int32_t branchpoint(int32_t bpNr) const { return static_cast<int32_t>(locations.size()) + bpNr; }
+        };
+
+        explicit EngineView(Document& document);
+
+        const std::vector<template_view_t>& getTemplates() const { return templates; }
+        /** The expression with the given id (no id is given to empty expressions). */
+        const expression_t& getExpression(int32_t id) const { return expressions[id]; }
+        const std::vector<expression_t>& getExpressions() const { return expressions; }
+        /** The channel with the given id. */
+        const symbol_t& getChannel(int32_t id) const { return channels[id]; }
+        const std::vector<symbol_t>& getChannels() const { return channels; }
+
+    private:
+        std::vector<template_view_t> templates;
+        std::vector<expression_t> expressions;
+        std::vector<symbol_t> channels;
+        std::map<expression_t, int32_t> expressionIds;
+        std::map<symbol_t, int32_t> channelIds;
+
+        int32_t addExpression(const expression_t& expr);
+        int32_t addChannel(const expression_t& expr);
+        void addTemplate(const template_t& templ);
+    };
+}  // namespace UTAP
+
+#endif /* UTAP_ENGINEVIEW_H */
@@ -0,0 +1,69 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_EVALUATOR_H
+#define UTAP_EVALUATOR_H
+
+#include "utap/document.h"
+
+#include <map>
+#include <optional>
+#include <set>
+#include <cstdint>
+
+namespace UTAP
+{
+    /**
+     * Evaluates integer expressions whose value is known without
+     * instantiating any template: literals, global and template local
+     * constants with such initialisers, elements of constant arrays and
+     * the integer and boolean operators over these. Anything else, e.g.
+     * parameters, function calls and overflowing operations, has no
+     * value. The values of constants are remembered between calls.
+     */
+    class ConstantEvaluator
+    {
+    public:
+        /** Returns the value of \a expr if it is known. */
+        std::optional<int32_t> evaluate(const expression_t& expr);
+
+        /** Evaluates the bounds of a RANGE type and caches them on the type. */
+        std::optional<range_t<int32_t>> evaluateBounds(type_t type);
+
+    private:
+        std::map<symbol_t, std::optional<int32_t>> constants;
+        std::set<symbol_t> pending;  // constants being evaluated, to stop on cycles
+        std::optional<int32_t> evaluateConstant(const symbol_t& symbol);
+        expression_t getInitialiser(const expression_t& expr);
+    };
+
+    /**
+     * Evaluates the bounds of all ranges and array sizes in the
+     * declarations, parameters and select statements of a type checked
+     * document, and caches them on the types (see type_t::getBounds).
+     * Ranges depending on parameters are left without bounds, and so
+     * are ranges occurring only inside expressions (e.g. quantifiers).
+     * The parse functions in utap.h call this after type checking.
+     */
+    void evaluateBounds(Document& document);
+}  // namespace UTAP
+
+#endif /* UTAP_EVALUATOR_H */
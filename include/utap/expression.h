@@ -23,10 +23,10 @@
 #define UTAP_EXPRESSION_HH
 
 #include "utap/common.h"
+#include "utap/counted.h"
 #include "utap/position.h"
 #include "utap/symbols.h"
 
-#include <memory>  // shared_ptr
 #include <set>
 #include <vector>
 
@@ -69,7 +69,7 @@ namespace UTAP
     {
     private:
         struct expression_data;
-        std::shared_ptr<expression_data> data = nullptr;  // PIMPL pattern with cheap/shallow copying
+        counted_ptr<expression_data> data = nullptr;  // PIMPL pattern with cheap/shallow copying
         expression_t(Constants::kind_t, const position_t&);
 
     public:
@@ -105,10 +105,11 @@ namespace UTAP
         const position_t& getPosition() const;
 
         /** Returns the type of the expression. */
-        type_t getType() const;
+        const type_t& getType() const;
 
-        /** Sets the type of the expression. */
-        void setType(type_t);
+        /** Sets the type of the expression. The type is a property of
+            the shared node, hence this is allowed on const handles. */
+        void setType(type_t) const;
 
         /** Returns the value field of this expression. This
             call is not valid for all expressions. */
@@ -139,7 +140,7 @@ namespace UTAP
         expression_t& operator[](uint32_t);
 
         /** Returns the ith subexpression. */
-        const expression_t operator[](uint32_t) const;
+        const expression_t& operator[](uint32_t) const;
 
         /** Returns the ith subexpression. */
         expression_t& get(uint32_t);
@@ -150,6 +151,22 @@ namespace UTAP
         /** Equality operator */
         bool equal(const expression_t&) const;
 
+        /** Returns true if the expressions have the same structure, where
+            symbols are compared by name rather than by identity. This
+            allows comparing expressions of different documents. */
+        bool equalStructure(const expression_t&) const;
+
+        /** Returns a hash of the structure, consistent with equalStructure(). */
+        size_t hashStructure() const;
+
+        /** Returns the identity of the node, shared by all (shallow) copies
+            of the expression and consistent with operator==. */
+        const void* getIdentity() const;
+
+        /** Returns true if other expressions refer to this node too, i.e.
+            it may be reachable along several paths. */
+        bool isShared() const;
+
         /**
          *  Returns the symbol of a variable reference. The expression
          *  must be a left-hand side value. In case of
@@ -200,11 +217,11 @@ namespace UTAP
 
         /** Less-than operator. Makes it possible to put expression_t
             objects into an STL set. */
-        bool operator<(const expression_t) const;
+        bool operator<(const expression_t&) const;
 
         /** Equality operator. Returns true if the two references point
             to the same expression object. */
-        bool operator==(const expression_t) const;
+        bool operator==(const expression_t&) const;
 
         expression_t subst(symbol_t, expression_t) const;
 
@@ -217,26 +234,28 @@ namespace UTAP
         static expression_t createDouble(double, position_t = {});
 
         /** Create an IDENTIFIER expression */
-        static expression_t createIdentifier(symbol_t, position_t = {});
+        static expression_t createIdentifier(const symbol_t&, const position_t& = {});
 
         /** Create a unary expression */
-        static expression_t createUnary(Constants::kind_t, expression_t, position_t = {}, type_t = {});
+        static expression_t createUnary(Constants::kind_t, const expression_t&, const position_t& = {},
+                                        const type_t& = {});
 
         /** Create a binary expression */
-        static expression_t createBinary(Constants::kind_t, expression_t, expression_t, position_t = {}, type_t = {});
+        static expression_t createBinary(Constants::kind_t, const expression_t&, const expression_t&,
+                                         const position_t& = {}, const type_t& = {});
 
         /** Create a ternary expression */
-        static expression_t createTernary(Constants::kind_t, expression_t, expression_t, expression_t, position_t = {},
-                                          type_t = {});
+        static expression_t createTernary(Constants::kind_t, const expression_t&, const expression_t&,
+                                          const expression_t&, const position_t& = {}, const type_t& = {});
 
         /** Create an n-ary expression */
         static expression_t createNary(Constants::kind_t, std::vector<expression_t> sub, position_t = {}, type_t = {});
 
         /** Create a DOT expression */
-        static expression_t createDot(expression_t, int32_t = -1, position_t = {}, type_t = {});
+        static expression_t createDot(const expression_t&, int32_t = -1, const position_t& = {}, const type_t& = {});
 
         /** Create a SYNC expression */
-        static expression_t createSync(expression_t, Constants::synchronisation_t, position_t = {});
+        static expression_t createSync(const expression_t&, Constants::synchronisation_t, const position_t& = {});
 
         /** Create a DEADLOCK expression */
         static expression_t createDeadlock(position_t = {});
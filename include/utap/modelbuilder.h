@@ -0,0 +1,254 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_MODELBUILDER_H
+#define UTAP_MODELBUILDER_H
+
+#include "utap/DocumentBuilder.hpp"
+#include "utap/document.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace UTAP
+{
+    /**
+     * Typed construction of models without going through the XTA or
+     * XML text. The model is reported to a DocumentBuilder in the same
+     * sequence as the parser would, thus the document is the same as
+     * for the equivalent text, and it is type checked the same way
+     * (see check()). Errors are recorded in the document, located by a
+     * path naming the offending declaration, e.g. "/template/P/edge/A->B".
+     *
+     * Example:
+     * \code
+     * using E = ModelBuilder::Expr;
+     * using T = ModelBuilder::Type;
+     * auto builder = ModelBuilder{document};
+     * builder.declare(T::Chan(), "c");
+     * const auto x = E::id("x");
+     * auto p = ModelBuilder::Template{"P"};
+     * p.declare(T::Clock(), "x")
+     *     .location("A", x <= 5)
+     *     .location("B")
+     *     .initial("A")
+     *     .edge(ModelBuilder::Edge{"A", "B"}.guard(x >= 2).send(E::id("c")).update(x.assign(0)));
+     * builder.add(p);
+     * builder.system({"P"});
+     * builder.check();
+     * \endcode
+     */
+    class ModelBuilder
+    {
+    public:
+        /** An expression recorded for later construction. */
+        class Expr
+        {
+        public:
+            Expr(int32_t value);
+            Expr(double value);
+
+            static Expr id(std::string name);
+            static Expr boolean(bool value);
+            static Expr ifThenElse(Expr condition, Expr then, Expr otherwise);
+            static Expr unary(Constants::kind_t kind, Expr operand);
+            static Expr binary(Constants::kind_t kind, Expr left, Expr right);
+            static Expr assignment(Constants::kind_t kind, Expr left, Expr right);
+
+            Expr operator[](Expr index) const;
+            Expr field(std::string name) const;
+            Expr call(std::vector<Expr> arguments) const;
+            template <typename... Args>
+            Expr operator()(Args&&... arguments) const
+            {
+                return call({Expr(std::forward<Args>(arguments))...});
+            }
+
+            Expr assign(Expr value) const { return assignment(Constants::ASSIGN, *this, std::move(value)); }
+            Expr assignAdd(Expr value) const { return assignment(Constants::ASSPLUS, *this, std::move(value)); }
+            Expr assignSub(Expr value) const { return assignment(Constants::ASSMINUS, *this, std::move(value)); }
+            Expr increment() const;  // post-increment
+            Expr decrement() const;  // post-decrement
+
+            friend Expr operator-(Expr e) { return unary(Constants::MINUS, std::move(e)); }
+            friend Expr operator!(Expr e) { return unary(Constants::NOT, std::move(e)); }
+#define UTAP_MODELBUILDER_BINARY(op, kind) \
+    friend Expr operator op(Expr l, Expr r) { return binary(Constants::kind, std::move(l), std::move(r)); }
+            UTAP_MODELBUILDER_BINARY(+, PLUS)
+            UTAP_MODELBUILDER_BINARY(-, MINUS)
+            UTAP_MODELBUILDER_BINARY(*, MULT)
+            UTAP_MODELBUILDER_BINARY(/, DIV)
+            UTAP_MODELBUILDER_BINARY(%, MOD)
+            UTAP_MODELBUILDER_BINARY(&, BIT_AND)
+            UTAP_MODELBUILDER_BINARY(|, BIT_OR)
+            UTAP_MODELBUILDER_BINARY(^, BIT_XOR)
+            UTAP_MODELBUILDER_BINARY(<<, BIT_LSHIFT)
+            UTAP_MODELBUILDER_BINARY(>>, BIT_RSHIFT)
+            UTAP_MODELBUILDER_BINARY(<, LT)
+            UTAP_MODELBUILDER_BINARY(<=, LE)
+            UTAP_MODELBUILDER_BINARY(==, EQ)
+            UTAP_MODELBUILDER_BINARY(!=, NEQ)
+            UTAP_MODELBUILDER_BINARY(>=, GE)
+            UTAP_MODELBUILDER_BINARY(>, GT)
+            UTAP_MODELBUILDER_BINARY(&&, AND)
+            UTAP_MODELBUILDER_BINARY(||, OR)
+#undef UTAP_MODELBUILDER_BINARY
+
+        private:
+            struct node_t;
+            std::shared_ptr<const node_t> node;
+            explicit Expr(std::shared_ptr<const node_t> node);
+            friend class ModelBuilder;
+        };
+
+        /** A type: a base type with a prefix and array dimensions. */
+        class Type
+        {
+        public:
+            static Type Int();
+            static Type Int(Expr lower, Expr upper);
+            static Type Bool();
+            static Type Double();
+            static Type Clock();
+            static Type Chan();
+            static Type Named(std::string name); /**< A type declared with ModelBuilder::declareType */
+
+            Type constant() const { return withPrefix(ParserBuilder::PREFIX_CONST); }
+            Type urgent() const { return withPrefix(ParserBuilder::PREFIX_URGENT); }
+            Type broadcast() const { return withPrefix(ParserBuilder::PREFIX_BROADCAST); }
+            Type meta() const { return withPrefix(ParserBuilder::PREFIX_SYSTEM_META); }
+            /** Adds an array dimension; the first call gives the outermost dimension. */
+            Type array(Expr size) const;
+
+        private:
+            enum base_t { INT, BOUNDED_INT, BOOL, DOUBLE, CLOCK, CHAN, NAMED };
+            base_t base;
+            int prefix{ParserBuilder::PREFIX_NONE};
+            std::string name;
+            std::vector<Expr> bounds;
+            std::vector<Expr> sizes;
+
+            explicit Type(base_t base): base{base} {}
+            Type withPrefix(int flag) const;
+            friend class ModelBuilder;
+        };
+
+        /** A variable declaration, optionally with an initialiser. */
+        struct declaration_t
+        {
+            Type type;
+            std::string name;
+            std::optional<Expr> init;       /**< Expression initialiser */
+            std::vector<Expr> initialisers; /**< Otherwise, a list initialiser if not empty */
+        };
+
+        struct parameter_t
+        {
+            Type type;
+            std::string name;
+            bool reference{false};
+        };
+
+        class Edge
+        {
+        public:
+            Edge(std::string source, std::string target): source{std::move(source)}, target{std::move(target)} {}
+
+            Edge& select(std::string name, Type type);
+            Edge& guard(Expr expr);
+            Edge& send(Expr channel);
+            Edge& receive(Expr channel);
+            Edge& update(Expr expr); /**< Adds an update, evaluated after the previous ones */
+            Edge& uncontrollable();
+
+        private:
+            std::string source, target;
+            std::vector<std::pair<std::string, Type>> selects;
+            std::optional<Expr> guardExpr;
+            std::optional<Expr> syncExpr;
+            Constants::synchronisation_t syncKind{Constants::SYNC_BANG};
+            std::vector<Expr> updates;
+            bool controllable{true};
+            friend class ModelBuilder;
+        };
+
+        class Template
+        {
+        public:
+            explicit Template(std::string name): name{std::move(name)} {}
+
+            Template& parameter(Type type, std::string name, bool reference = false);
+            Template& declare(Type type, std::string name, std::optional<Expr> init = {});
+            Template& location(std::string name, std::optional<Expr> invariant = {});
+            Template& urgent(std::string location);
+            Template& committed(std::string location);
+            Template& initial(std::string location);
+            Template& edge(Edge edge);
+
+        private:
+            std::string name;
+            std::vector<parameter_t> parameters;
+            std::vector<declaration_t> declarations;
+            std::vector<std::pair<std::string, std::optional<Expr>>> locations;
+            std::vector<std::string> urgentLocations, committedLocations;
+            std::string init;
+            std::vector<Edge> edges;
+            friend class ModelBuilder;
+        };
+
+        /** Starts a model in \a document, declaring the built-in constants unless \a builtins is false. */
+        explicit ModelBuilder(Document& document, bool builtins = true);
+
+        void declare(Type type, const std::string& name, std::optional<Expr> init = {});
+        void declare(const declaration_t& declaration);
+        void declareType(Type type, const std::string& name);
+        void add(const Template& templ);
+        /** Declares the partial instance "name(parameters) = templ(arguments);". */
+        void instantiate(const std::string& name, const std::string& templ, const std::vector<Expr>& arguments,
+                         const std::vector<parameter_t>& parameters = {});
+        /** Declares the system line; completes the model. */
+        void system(const std::vector<std::string>& processes);
+
+        /** Type checks the document like the parse functions do; returns true if there are no errors. */
+        bool check();
+
+    private:
+        Document& document;
+        DocumentBuilder builder;
+        uint32_t position{0};
+
+        void at(const std::string& path);
+        void emit(const Expr& expr);
+        void emitBase(const Type& type);
+        void emitSizes(const Type& type);
+        void emitDeclaration(const declaration_t& declaration);
+        void emitParameter(const parameter_t& parameter);
+        void declareBuiltins();
+        template <typename F>
+        void call(F&& f);
+    };
+}  // namespace UTAP
+
+#endif /* UTAP_MODELBUILDER_H */
@@ -0,0 +1,82 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_MODELDIFF_H
+#define UTAP_MODELDIFF_H
+
+#include "utap/document.h"
+
+#include <iosfwd>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * Structural differences between two versions of a model.
+     *
+     * Entities are named as in the model: global declarations by
+     * their name, template members as "Template.name" and edges as
+     * "Template.Source->Target", followed by "#k" for the k-th of
+     * several edges between the same locations. Positions are not
+     * compared, thus moving a declaration is not a change.
+     */
+    struct model_diff_t
+    {
+        enum change_t { ADDED, REMOVED, CHANGED };
+        enum entity_t { TYPEDEF, VARIABLE, FUNCTION, TEMPLATE, LOCATION, EDGE, PROCESS };
+
+        struct entry_t
+        {
+            change_t change;
+            entity_t entity;
+            std::string name;
+        };
+
+        std::vector<entry_t> entries;
+
+        /** Processes whose behaviour may differ: processes of changed
+            templates, changed processes and processes reading an
+            affected variable. */
+        std::set<std::string> affectedProcesses;
+
+        /** Variables whose value may differ: changed variables and the
+            variables written by affected processes (including local
+            variables, named "Process.name"). Changed functions are
+            included as well. */
+        std::set<std::string> affectedVariables;
+
+        bool empty() const { return entries.empty(); }
+    };
+
+    /**
+     * Computes the differences between two type checked documents.
+     * Expressions are compared by structural hashing, thus the time is
+     * linear in the size of the models, apart from the logarithmic
+     * factor of the name lookups.
+     */
+    model_diff_t diffDocuments(Document& before, Document& after);
+
+    std::ostream& operator<<(std::ostream& os, const model_diff_t& diff);
+}  // namespace UTAP
+
+#endif /* UTAP_MODELDIFF_H */
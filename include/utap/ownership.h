@@ -0,0 +1,86 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_OWNERSHIP_H
+#define UTAP_OWNERSHIP_H
+
+#include "utap/document.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * The processes (as expanded by SystemView) accessing each global
+     * non-constant variable. A variable with a single user is local to
+     * that process in everything but its declaration, and an array is
+     * partitioned if every process accesses a single element of it with
+     * an index which is constant in that process, like state[pid] with a
+     * constant parameter pid, and no two processes access the same one.
+     * Such variables need not be treated as shared by partial order
+     * reduction.
+     */
+    struct ownership_t
+    {
+        struct variable_t
+        {
+            symbol_t symbol;
+            std::set<std::string> users;           /**< The processes reading or writing the variable */
+            std::map<int32_t, std::string> owners; /**< The owners of the elements of a partitioned array */
+            bool direct{true};    /**< Only accessed by the code of templates, not via global functions etc. */
+            bool observed{false}; /**< Mentioned by a query */
+
+            bool isLocal() const { return users.size() == 1; }
+            bool isPartitioned() const { return !owners.empty(); }
+            bool isShared() const { return users.size() > 1 && owners.empty(); }
+        };
+
+        std::vector<variable_t> variables; /**< In the order of declaration */
+
+        const variable_t* find(const std::string& name) const;
+    };
+
+    /**
+     * Analyses the type checked \a document. Queries of the document and
+     * the extra \a queries mark the variables they mention as observed.
+     */
+    ownership_t analyseOwnership(Document& document, const std::vector<std::string>& queries = {});
+
+    /**
+     * Moves the variables which are local to a process into the local
+     * declarations of its template, when the template has no other
+     * processes, and replaces the partitioned arrays used by all
+     * processes of one template with a local variable of the element
+     * type. Only directly accessed and unobserved variables are moved,
+     * and partitioned arrays only when they are not accessed by the
+     * functions of the template and have a uniform initialiser.
+     * @return the names of the promoted variables.
+     */
+    std::vector<std::string> promoteOwnedVariables(Document& document, const ownership_t& ownership);
+
+    std::ostream& operator<<(std::ostream& os, const ownership_t& ownership);
+}  // namespace UTAP
+
+#endif /* UTAP_OWNERSHIP_H */
@@ -26,6 +26,7 @@
 #include <iosfwd>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace UTAP
@@ -78,6 +79,7 @@ namespace UTAP
 
     private:
         std::vector<line_t> elements;
+        std::vector<std::pair<uint32_t, std::string>> texts;
         const line_t& find(uint32_t position, uint32_t first, uint32_t last) const;
 
     public:
@@ -91,6 +93,20 @@ namespace UTAP
          */
         const line_t& find(uint32_t position) const;
 
+        /**
+         * Adds the text of an element starting at the given position,
+         * so that its lines can be recovered when only its first line
+         * has been added.
+         */
+        void addText(uint32_t position, std::string text);
+
+        /**
+         * Same as find(), but when the line found is the first line of
+         * an element whose text has been added, the line containing
+         * the position is computed from the text.
+         */
+        line_t locate(uint32_t position) const;
+
         /** Dump table to stdout. */
         void dump();
     };
@@ -58,6 +58,8 @@ namespace UTAP
 
         void addPosition(uint32_t position, uint32_t offset, uint32_t line, const std::string& path) override;
 
+        using AbstractBuilder::handleError;
+        using AbstractBuilder::handleWarning;
         void handleError(const TypeException&) override;
         void handleWarning(const TypeException&) override;
 
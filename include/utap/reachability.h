@@ -0,0 +1,79 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_REACHABILITY_H
+#define UTAP_REACHABILITY_H
+
+#include "utap/document.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace UTAP
+{
+    /**
+     * Syntactic over-approximation of the locations and edges which may
+     * be used by each process (as expanded by SystemView).
+     *
+     * Starting from the initial locations, an edge may fire unless
+     *  - its guard is false given the constant parameters of the process
+     *    and the declared ranges of the variables,
+     *  - the invariant of its target is false in the same sense, or
+     *  - it synchronises on a channel without a possible partner: a
+     *    binary channel needs an edge with the opposite direction in
+     *    another process, and a broadcast receiver needs a sender.
+     * Partners must themselves be on possibly reachable locations, thus
+     * the analysis iterates until no more locations become reachable.
+     * Clock constraints are assumed to be satisfiable.
+     */
+    struct reachability_t
+    {
+        struct process_t
+        {
+            std::string name;
+            const template_t* templ{nullptr};
+            std::set<const state_t*> locations; /**< The possibly reachable locations */
+            std::set<const edge_t*> edges;      /**< The edges which may fire */
+        };
+
+        std::vector<process_t> processes;
+    };
+
+    reachability_t analyseReachability(Document& document);
+
+    struct pruning_t
+    {
+        size_t edges{0};     /**< Removed edges */
+        size_t locations{0}; /**< Locations left without edges */
+    };
+
+    /**
+     * Removes the edges of the type checked \a document which cannot
+     * fire in any process of their template. Unreachable locations lose
+     * all their edges but are kept, as queries and location numbers
+     * refer to them.
+     */
+    pruning_t pruneUnreachable(Document& document);
+}  // namespace UTAP
+
+#endif /* UTAP_REACHABILITY_H */
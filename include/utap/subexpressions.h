@@ -0,0 +1,81 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_SUBEXPRESSIONS_H
+#define UTAP_SUBEXPRESSIONS_H
+
+#include "utap/costmodel.h"
+#include "utap/document.h"
+
+#include <utility>
+#include <vector>
+
+namespace UTAP
+{
+    /** A value computed once per visit of a location. */
+    struct temporary_t
+    {
+        symbol_t symbol;    /**< The temporary, referred to by the rewritten expressions */
+        expression_t value; /**< May refer to the temporaries computed before it */
+        uint32_t uses{0};   /**< Occurrences replaced by the temporary */
+        bool lazy{false};   /**< The value may fail to evaluate, see eliminateCommonSubexpressions() */
+    };
+
+    /** The common subexpressions of the invariant and the outgoing guards of a location. */
+    struct location_subexpressions_t
+    {
+        const state_t* location{nullptr};
+        std::vector<temporary_t> precompute; /**< In evaluation order */
+        expression_t invariant;              /**< The rewritten invariant */
+        std::vector<std::pair<const edge_t*, expression_t>> guards; /**< The rewritten guards */
+    };
+
+    struct template_subexpressions_t
+    {
+        const template_t* templ{nullptr};
+        frame_t temporaries; /**< The temporaries of all the locations */
+        std::vector<location_subexpressions_t> locations; /**< The locations with temporaries */
+    };
+
+    /**
+     * Finds the subexpressions occurring more than once in the invariant
+     * and the guards of the outgoing edges of each location of the type
+     * checked \a document, and rewrites those expressions to refer to
+     * temporaries instead. The document itself is not changed.
+     *
+     * Only side effect free integer, boolean and double values not
+     * depending on clocks, select variables or variables bound by
+     * quantifiers and sums, and costing at least
+     * \a minimumCost according to \a model, are eliminated. The longest
+     * shared subexpressions are chosen first, thus a temporary may
+     * refer to another one but never to a shared part of itself.
+     *
+     * Temporaries which may fail to evaluate (see mayFail()), e.g.
+     * "a[i]" in "i < N && a[i] > 0", are marked lazy: to preserve the
+     * semantics they must be evaluated on their first use rather than
+     * up front, and then reused for the rest of the visit.
+     */
+    std::vector<template_subexpressions_t> eliminateCommonSubexpressions(Document& document, CostModel& model,
+                                                                         double minimumCost = 3);
+}  // namespace UTAP
+
+#endif /* UTAP_SUBEXPRESSIONS_H */
@@ -24,6 +24,7 @@
 #define UTAP_SYMBOLS_HH
 
 #include "utap/common.h"
+#include "utap/counted.h"
 #include "utap/position.h"
 #include "utap/type.h"
 
@@ -61,7 +62,7 @@ namespace UTAP
     {
     private:
         struct symbol_data;
-        std::shared_ptr<symbol_data> data{nullptr};  // pImpl pattern
+        counted_ptr<symbol_data> data{nullptr};  // pImpl pattern
 
     protected:
         friend class frame_t;
@@ -91,7 +92,7 @@ namespace UTAP
         frame_t getFrame();  // TODO: consider removing this method (mostly unused)
 
         /** Returns the type of this symbol. */
-        type_t getType() const;
+        const type_t& getType() const;
 
         /** Alters the type of this symbol */
         void setType(type_t);
@@ -137,7 +138,7 @@ namespace UTAP
     {
     private:
         struct frame_data;
-        std::shared_ptr<frame_data> data{nullptr};  // pImpl pattern
+        counted_ptr<frame_data> data{nullptr};  // pImpl pattern
 
     protected:
         friend class symbol_t;
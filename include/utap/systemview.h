@@ -0,0 +1,130 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_SYSTEMVIEW_H
+#define UTAP_SYSTEMVIEW_H
+
+#include "utap/document.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace UTAP
+{
+    class ConstantEvaluator;
+
+    /**
+     * Instantiated view of the processes of a type checked document,
+     * where the parameters of every process are bound once and for all.
+     *
+     * Process sets (processes with unbound parameters) are expanded to
+     * one process per value of the unbound parameters, named like
+     * "P(1,2)". A set is kept as one process if the ranges of its
+     * parameters cannot be evaluated.
+     *
+     * Every non-constant variable, i.e. every global variable, every
+     * local variable of a process and every parameter passed by value,
+     * has a slot. The symbols of a template (its parameters followed by
+     * its local variables) are numbered densely by getIndex(), so that
+     * the slot of a symbol in a process is found by indexing
+     * process_t::slots. Reference parameters refer to the slot of the
+     * variable they are bound to.
+     *
+     * The view refers to the document: it must not outlive it.
+     */
+    class SystemView
+    {
+    public:
+        static constexpr int32_t none = -1;
+
+        enum binding_kind_t : uint8_t {
+            VALUE,      /**< A constant with known value */
+            REFERENCE,  /**< A reference to (an element of) a variable */
+            EXPRESSION  /**< Any other argument, e.g. a constant double */
+        };
+
+        /** The argument of a template parameter in a process. */
+        struct binding_t
+        {
+            binding_kind_t kind{EXPRESSION};
+            int32_t value{0};     /**< The value of a VALUE */
+            int32_t slot{none};   /**< The referred slot, or the own slot of a parameter passed by value */
+            expression_t argument; /**< The argument, with unbound parameters replaced by their values */
+        };
+
+        struct process_t
+        {
+            std::string name;
+            const instance_t* instance{nullptr}; /**< The process (set) of the document */
+            const template_t* templ{nullptr};
+            std::vector<int32_t> values;        /**< The values of the unbound parameters of the set */
+            std::vector<binding_t> parameters;  /**< Indexed like the parameters of the template */
+            std::vector<int32_t> slots;         /**< Indexed by getIndex() */
+        };
+
+        /** A slot: a variable of the system. */
+        struct slot_t
+        {
+            symbol_t symbol;
+            int32_t process; /**< The process owning the variable, or none for globals */
+        };
+
+        explicit SystemView(Document& document);
+
+        const std::vector<process_t>& getProcesses() const { return processes; }
+        const std::vector<slot_t>& getSlots() const { return slots; }
+
+        /**
+         * Returns the index of a parameter or local variable among the
+         * symbols of a template, or none.
+         */
+        int32_t getIndex(const template_t& templ, const symbol_t& symbol) const;
+
+        /**
+         * Returns the slot of a global variable or of a symbol of the
+         * template of a process, or none if it has no slot (e.g. a
+         * constant).
+         */
+        int32_t getSlot(int32_t process, const symbol_t& symbol) const;
+
+        /**
+         * Returns \a expr, an expression of the template of \a process,
+         * with the parameters of the template replaced by their values or
+         * arguments in the process.
+         */
+        static expression_t bind(const process_t& process, expression_t expr);
+
+    private:
+        std::vector<process_t> processes;
+        std::vector<slot_t> slots;
+        std::map<symbol_t, int32_t> globalSlots;
+        std::map<const template_t*, std::map<symbol_t, int32_t>> indices;
+
+        const std::map<symbol_t, int32_t>& getIndices(const template_t& templ);
+        void addProcess(const instance_t& instance, const std::vector<int32_t>& values, ConstantEvaluator& evaluator);
+        int32_t addSlot(const symbol_t& symbol, int32_t process);
+    };
+}  // namespace UTAP
+
+#endif /* UTAP_SYSTEMVIEW_H */
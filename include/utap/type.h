@@ -24,9 +24,11 @@
 #define UTAP_TYPE_HH
 
 #include "utap/common.h"
+#include "utap/counted.h"
 #include "utap/position.h"
+#include "utap/range.h"
 
-#include <memory>  // shared_ptr
+#include <optional>
 #include <string>
 #include <cstdint>
 
@@ -96,7 +98,7 @@ namespace UTAP
     private:
         struct child_t;
         struct type_data;
-        std::shared_ptr<type_data> data;
+        counted_ptr<type_data> data;
 
     public:
         explicit type_t(Constants::kind_t kind, const position_t& pos, size_t size);
@@ -129,10 +131,10 @@ namespace UTAP
         bool operator<(const type_t&) const;
 
         /** Returns the \a i'th child. */
-        const type_t operator[](uint32_t) const;
+        const type_t& operator[](uint32_t) const;
 
         /** Returns the \a i'th child. */
-        const type_t get(uint32_t) const;
+        const type_t& get(uint32_t) const;
 
         /** Returns the \a i'th label. */
         const std::string& getLabel(uint32_t) const;
@@ -181,6 +183,16 @@ namespace UTAP
          */
         std::pair<expression_t, expression_t> getRange() const;
 
+        /**
+         * Returns the evaluated bounds of a RANGE type, if they are
+         * known. They are set by evaluateBounds() for ranges whose
+         * bounds do not depend on parameters. @pre isRange().
+         */
+        std::optional<range_t<int32_t>> getBounds() const;
+
+        /** Sets the evaluated bounds of a RANGE type. */
+        void setBounds(const range_t<int32_t>& bounds);
+
         /** Generates string representation of the type. */
         std::string toString() const;
 
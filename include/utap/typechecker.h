@@ -28,6 +28,8 @@
 #include "utap/statement.h"
 
 #include <set>
+#include <unordered_set>
+#include <vector>
 
 namespace UTAP
 {
@@ -62,19 +64,20 @@ namespace UTAP
         function_t* function; /**< Current function being type checked. */
         bool refinementWarnings;
 
+        /** Reports the message \a id with \a args, see Document::addError(). */
         template <class T>
-        void handleError(T, const std::string&);
+        void handleError(T, const char* id, std::vector<std::string> args = {});
         template <class T>
-        void handleWarning(T, const std::string&);
+        void handleWarning(T, const char* id, std::vector<std::string> args = {});
 
         expression_t checkInitialiser(type_t type, expression_t init);
         bool areAssignmentCompatible(type_t lvalue, type_t rvalue, bool init = false) const;
         bool areInlineIfCompatible(type_t thenArg, type_t elseArg) const;
         bool areEqCompatible(type_t t1, type_t t2) const;
         bool areEquivalent(type_t, type_t) const;
-        bool isLValue(expression_t) const;
-        bool isModifiableLValue(expression_t) const;
-        bool isUniqueReference(expression_t expr) const;
+        bool isLValue(const expression_t&) const;
+        bool isModifiableLValue(const expression_t&) const;
+        bool isUniqueReference(const expression_t& expr) const;
         bool isParameterCompatible(type_t param, expression_t arg);
         bool checkParameterCompatible(type_t param, expression_t arg);
         void checkIgnoredValue(expression_t expr);
@@ -118,12 +121,24 @@ namespace UTAP
 
         bool checkDynamicExpressions(Statement* stat);
         /** Type check an expression */
-        bool checkExpression(expression_t);
+        bool checkExpression(const expression_t&);
         bool checkSpawnParameterCompatible(type_t param, expression_t arg);
 
     private:
+        struct identity_hash
+        {
+            size_t operator()(const expression_t& expr) const { return std::hash<const void*>{}(expr.getIdentity()); }
+        };
+
         int syncUsed;  // Keep track of sync declarations, 0->nothing, 1->IO, 2->CSP, -1->error.
         template_t* temp;
+        /** Shared nodes checked successfully during the current visit, as subst(), instances and typedefs make
+            the same subtree reachable along many paths. Holding the nodes keeps their identities unique. */
+        std::unordered_set<expression_t, identity_hash> checked;
+        /** Set when the node being checked depends on the current template (spawn, exit). */
+        bool contextual{false};
+
+        bool checkNode(const expression_t& expr);
 
         /** check expressions used in (SMC) properties, these functions provide:
             1) consistent semantic checks by code reuse,
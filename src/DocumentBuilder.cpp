@@ -72,9 +72,9 @@ void DocumentBuilder::addSelectSymbolToFrame(const std::string& id, frame_t& fra
     }
 
     if (!type.isScalar() && !type.isInteger()) {
-        handleError(TypeException{"$Scalar_set_or_integer_expected"});
+        handleError("$Scalar_set_or_integer_expected");
     } else if (!type.is(RANGE)) {
-        handleError(TypeException{"$Range_expected"});
+        handleError("$Range_expected");
     } else {
         symbol_t uid;
         if (resolve(id, uid)) {
@@ -143,12 +143,12 @@ void DocumentBuilder::procBegin(const char* name, const bool isTA, const string&
     if (currentTemplate) {
         /* check if parameters match */
         if (currentTemplate->parameters.getSize() != params.getSize()) {
-            handleError(TypeException{"Inconsistent parameters"});
+            handleError("Inconsistent parameters");
         } else {
             for (size_t i = 0; i < params.getSize(); i++) {
                 if (params[i].getName() != currentTemplate->parameters[i].getName() ||
                     params[i].getType().getKind() != currentTemplate->parameters[i].getType().getKind())
-                    handleError(TypeException{"Inconsistent parameters"});
+                    handleError("Inconsistent parameters");
             }
         }
         currentTemplate->isDefined = true;
@@ -205,9 +205,9 @@ void DocumentBuilder::procStateCommit(const char* name)
 {
     symbol_t uid;
     if (!resolve(name, uid) || !uid.getType().isLocation()) {
-        handleError(TypeException{"$Location_expected"});
+        handleError("$Location_expected");
     } else if (uid.getType().is(URGENT)) {
-        handleError(TypeException{"$States_cannot_be_committed_and_urgent_at_the_same_time"});
+        handleError("$States_cannot_be_committed_and_urgent_at_the_same_time");
     } else {
         uid.setType(uid.getType().createPrefix(COMMITTED, position));
     }
@@ -218,9 +218,9 @@ void DocumentBuilder::procStateUrgent(const char* name)
     symbol_t uid;
 
     if (!resolve(name, uid) || !uid.getType().isLocation()) {
-        handleError(TypeException{"$Location_expected"});
+        handleError("$Location_expected");
     } else if (uid.getType().is(COMMITTED)) {
-        handleError(TypeException{"$States_cannot_be_committed_and_urgent_at_the_same_time"});
+        handleError("$States_cannot_be_committed_and_urgent_at_the_same_time");
     } else {
         uid.setType(uid.getType().createPrefix(URGENT, position));
     }
@@ -232,7 +232,7 @@ void DocumentBuilder::procStateInit(const char* name)
 {
     symbol_t uid;
     if (!resolve(name, uid) || !uid.getType().isLocation()) {
-        handleError(TypeException{"$Location_expected"});
+        handleError("$Location_expected");
     } else {
         currentTemplate->init = uid;
     }
@@ -243,10 +243,10 @@ void DocumentBuilder::procEdgeBegin(const char* from, const char* to, const bool
     symbol_t fid, tid;
 
     if (!resolve(from, fid) || (!fid.getType().isLocation() && !fid.getType().isBranchpoint())) {
-        handleError(TypeException{"$No_such_location_or_branchpoint_(source)"});
+        handleError("$No_such_location_or_branchpoint_(source)");
         pushFrame(frame_t::createFrame(frames.top()));  // dummy frame for upcoming popFrame
     } else if (!resolve(to, tid) || (!tid.getType().isLocation() && !tid.getType().isBranchpoint())) {
-        handleError(TypeException{"$No_such_location_or_branchpoint_(destination)"});
+        handleError("$No_such_location_or_branchpoint_(destination)");
         pushFrame(frame_t::createFrame(frames.top()));  // dummy frame for upcoming popFrame
     } else {
         currentEdge = &currentTemplate->addEdge(fid, tid, control, actname);
@@ -265,7 +265,7 @@ void DocumentBuilder::procSelect(const char* id) { addSelectSymbolToFrame(id, cu
 void DocumentBuilder::procGuard()
 {
     if (!currentEdge) {
-        handleError(TypeException("Must be declared inside of an edge"));
+        handleError("Must be declared inside of an edge");
         return;
     }
 
@@ -276,7 +276,7 @@ void DocumentBuilder::procGuard()
 void DocumentBuilder::procSync(synchronisation_t type)
 {
     if (!currentEdge) {
-        handleError(TypeException("Must be declared inside of an edge"));
+        handleError("Must be declared inside of an edge");
         return;
     }
 
@@ -287,7 +287,7 @@ void DocumentBuilder::procSync(synchronisation_t type)
 void DocumentBuilder::procUpdate()
 {
     if (!currentEdge) {
-        handleError(TypeException("Must be declared inside of an edge"));
+        handleError("Must be declared inside of an edge");
         return;
     }
 
@@ -298,7 +298,7 @@ void DocumentBuilder::procUpdate()
 void DocumentBuilder::procProb()
 {
     if (!currentEdge) {
-        handleError(TypeException("Must be declared inside of an edge"));
+        handleError("Must be declared inside of an edge");
         return;
     }
 
@@ -322,7 +322,7 @@ void DocumentBuilder::instantiationBegin(const char* name, size_t parameters, co
      */
     symbol_t id;
     if (!resolve(templ_name, id) || (id.getType().getKind() != INSTANCE && id.getType().getKind() != LSCINSTANCE)) {
-        handleError(TypeException{"$Not_a_template"});
+        handleError("$Not_a_template");
     }
 
     /* Push parameters to frame stack.
@@ -353,9 +353,9 @@ void DocumentBuilder::instantiationEnd(const char* name, size_t parameters, cons
          */
         size_t expected = id.getType().size();
         if (arguments < expected) {
-            handleError(TypeException{"$Too_few_arguments"});
+            handleError("$Too_few_arguments");
         } else if (arguments > expected) {
-            handleError(TypeException{"$Too_many_arguments"});
+            handleError("$Too_many_arguments");
         } else {
             /* Collect arguments from expression stack.
              */
@@ -480,7 +480,7 @@ void DocumentBuilder::instanceName(const char* name, bool templ)
         if (resolve(string(name), uid) && (uid.getType().getKind() == INSTANCE)) {
             template_t* t = static_cast<template_t*>(uid.getData());
             if (t->parameters.getSize() > 0) {
-                handleError(TypeException{"$Wrong_number_of_arguments_in_instance_line_name"});
+                handleError("$Wrong_number_of_arguments_in_instance_line_name");
             }
         }
     }
@@ -520,9 +520,9 @@ void DocumentBuilder::instanceNameEnd(const char* name, size_t arguments)
          */
         size_t expected = id.getType().size();
         if (arguments < expected) {
-            handleError(TypeException{"$Too_few_arguments"});
+            handleError("$Too_few_arguments");
         } else if (arguments > expected) {
-            handleError(TypeException{"$Too_many_arguments"});
+            handleError("$Too_many_arguments");
         } else {
             /* Collect arguments from expression stack.
              */
@@ -569,9 +569,9 @@ void DocumentBuilder::procMessage(const char* from, const char* to, const int lo
 {
     symbol_t fid, tid;
     if (!resolve(from, fid) || !fid.getType().isInstanceLine()) {
-        handleError(TypeException{"$No_such_instance_line_(source)"});
+        handleError("$No_such_instance_line_(source)");
     } else if (!resolve(to, tid) || !tid.getType().isInstanceLine()) {
-        handleError(TypeException{"$No_such_instance_line_(destination)"});
+        handleError("$No_such_instance_line_(destination)");
     } else {
         currentMessage = &currentTemplate->addMessage(fid, tid, loc, pch);
     }
@@ -596,14 +596,14 @@ void DocumentBuilder::procCondition(const vector<string>& anchors, const int loc
     for (const auto& anchor : anchors) {
         symbol_t anchorid;
         if (!resolve(anchor.c_str(), anchorid) || !anchorid.getType().isInstanceLine()) {
-            handleError(TypeException{"$No_such_instance_line_(anchor)"});
+            handleError("$No_such_instance_line_(anchor)");
             error = true;
         } else if (!error) {
             v_anchorid.push_back(anchorid);
         }
     }
     if (pch && hot) {
-        handleWarning(TypeException{"$In_the_prechart_all_conditions_are_cold"});
+        handleWarning("$In_the_prechart_all_conditions_are_cold");
         isHot = false;
     }
     if (!error) {
@@ -627,7 +627,7 @@ void DocumentBuilder::procLscUpdate(const char* anchor, const int loc, const boo
     symbol_t anchorid;
 
     if (!resolve(anchor, anchorid) || !anchorid.getType().isInstanceLine()) {
-        handleError(TypeException{"$No_such_instance_line_(anchor)"});
+        handleError("$No_such_instance_line_(anchor)");
     } else {
         currentUpdate = &currentTemplate->addUpdate(anchorid, loc, pch);
         currentUpdate->label = makeConstant(1);
@@ -683,7 +683,7 @@ void DocumentBuilder::queryComment(const char* comment)
 void DocumentBuilder::queryOptions(const char* key, const char* value)
 {
     if (key == nullptr) {
-        handleError(TypeException{"options tag found without attribute 'key'"});
+        handleError("options tag found without attribute 'key'");
     }
     currentQuery->options.push_back(option_t{key, value == nullptr ? "" : value});
 }
@@ -731,11 +731,11 @@ void DocumentBuilder::expectationValue(const char* res, const char* type, const
 void DocumentBuilder::expectResource(const char* type, const char* value, const char* unit)
 {
     if (type == nullptr) {
-        handleError(TypeException{"missing name of resource in expectation"});
+        handleError("missing name of resource in expectation");
         return;
     }
     if (value == nullptr) {
-        handleError(TypeException{"missing value of resource in expectation"});
+        handleError("missing value of resource in expectation");
     }
     currentExpectation->resources.push_back(
         resource_t{type, value, unit == nullptr ? std::nullopt : std::make_optional(unit)});
@@ -754,7 +754,7 @@ void DocumentBuilder::queryEnd()
 void DocumentBuilder::modelOption(const char* key, const char* value)
 {
     if (key == nullptr) {
-        handleError(TypeException{"options tag found without attribute 'key'"});
+        handleError("options tag found without attribute 'key'");
     }
     document.getOptions().emplace_back(key, value == nullptr ? "" : value);
 }
@@ -21,6 +21,7 @@
 
 #include "utap/ExpressionBuilder.hpp"
 
+#include <algorithm>
 #include <vector>
 #include <cassert>
 #include <cinttypes>
@@ -50,7 +51,8 @@ void ExpressionBuilder::ExpressionFragments::pop(uint32_t n)
         pop();
 }
 
-ExpressionBuilder::ExpressionBuilder(Document& doc): document{doc}
+ExpressionBuilder::ExpressionBuilder(Document& doc):
+    fragments{doc.getMemoryResource()}, typeFragments{doc.getMemoryResource()}, document{doc}
 {
     pushFrame(document.getGlobals().frame);
     scalar_count = 0;
@@ -61,13 +63,58 @@ void ExpressionBuilder::addPosition(uint32_t position, uint32_t offset, uint32_t
     document.addPosition(position, offset, line, path);
 }
 
+void ExpressionBuilder::addText(uint32_t position, std::string_view text) { document.addText(position, text); }
+
 void ExpressionBuilder::handleError(const TypeException& ex) { document.addError(position, ex.what()); }
 
 void ExpressionBuilder::handleWarning(const TypeException& ex) { document.addWarning(position, ex.what()); }
 
-void ExpressionBuilder::pushFrame(frame_t frame) { frames.push(std::move(frame)); }
+void ExpressionBuilder::handleError(const char* msg) { document.addError(position, msg); }
+
+void ExpressionBuilder::handleWarning(const char* msg) { document.addWarning(position, msg); }
+
+/**
+ * Pushes the frame and counts the type definitions of the frame and of
+ * those parents that are not already counted. Usually the parent is the
+ * current top frame, thus only the new frame is scanned.
+ */
+void ExpressionBuilder::pushFrame(frame_t frame)
+{
+    typeScopes.emplace_back(typeFrames.size(), typeNameList.size());
+    auto f = frame;
+    while (std::find(typeFrames.begin(), typeFrames.end(), f) == typeFrames.end()) {
+        for (uint32_t i = 0; i < f.getSize(); ++i) {
+            if (f[i].getType().getKind() == TYPEDEF)
+                addTypeName(f[i]);
+        }
+        typeFrames.push_back(f);
+        if (!f.hasParent())
+            break;
+        f = f.getParent();
+    }
+    frames.push(std::move(frame));
+}
+
+void ExpressionBuilder::popFrame()
+{
+    const auto [frameCount, nameCount] = typeScopes.back();
+    typeScopes.pop_back();
+    while (typeNameList.size() > nameCount) {
+        auto it = typeNames.find(typeNameList.back());
+        if (--it->second == 0)
+            typeNames.erase(it);
+        typeNameList.pop_back();
+    }
+    typeFrames.resize(frameCount);
+    frames.pop();
+}
 
-void ExpressionBuilder::popFrame() { frames.pop(); }
+void ExpressionBuilder::addTypeName(const symbol_t& symbol)
+{
+    const auto& name = symbol.getName();
+    typeNameList.push_back(name);
+    ++typeNames[name];
+}
 
 bool ExpressionBuilder::resolve(const std::string& name, symbol_t& uid) const
 {
@@ -79,6 +126,9 @@ ExpressionBuilder::ExpressionFragments& ExpressionBuilder::getExpressions() { re
 
 bool ExpressionBuilder::isType(const char* name)
 {
+    // Most identifiers are not type names, so rule them out without resolving
+    if (typeNames.find(name) == typeNames.end())
+        return false;
     symbol_t uid;
     if (!resolve(name, uid)) {
         return false;
@@ -167,7 +217,7 @@ void ExpressionBuilder::typeVoid()
     typeFragments.push(type);
 }
 
-static void collectDependencies(std::set<symbol_t>& dependencies, expression_t expr)
+void ExpressionBuilder::collectDependencies(std::set<symbol_t>& dependencies, expression_t expr)
 {
     std::set<symbol_t> symbols;
     expr.collectPossibleReads(symbols);
@@ -176,9 +226,16 @@ static void collectDependencies(std::set<symbol_t>& dependencies, expression_t e
         symbols.erase(s);
         if (dependencies.find(s) == dependencies.end()) {
             dependencies.insert(s);
-            if (auto* data = s.getData(); data) {
-                variable_t* v = static_cast<variable_t*>(data);
-                v->expr.collectPossibleReads(symbols);
+            if (auto d = s.getData(); d) {
+                if (auto t = s.getType(); !(t.isFunction() || t.isExternalFunction())) {
+                    // assume is its variable, which is not always true
+                    variable_t* v = static_cast<variable_t*>(d);
+                    v->expr.collectPossibleReads(symbols);
+                } else if (auto* fun = static_cast<function_t*>(d); fun->body) {
+                    // the function is not type checked yet, so collect what its body reads
+                    CollectDependenciesVisitor visitor{symbols};
+                    fun->body->accept(&visitor);
+                }
             }
         }
     }
@@ -320,7 +377,7 @@ void ExpressionBuilder::exprCallEnd(uint32_t n)
     case EXTERNAL_FUNCTION:
     case FUNCTION:
         if (expr.size() != id.getType().size()) {
-            handleError(TypeException{"$Wrong_number_of_arguments"});
+            handleError("$Wrong_number_of_arguments");
         }
         e = expression_t::createNary(id.getType().getKind() == FUNCTION ? FUNCALL : EFUNCALL, expr, position,
                                      id.getType()[0]);
@@ -328,7 +385,7 @@ void ExpressionBuilder::exprCallEnd(uint32_t n)
 
     case PROCESSSET:
         if (expr.size() - 1 != id.getType().size()) {
-            handleError(TypeException{"$Wrong_number_of_arguments"});
+            handleError("$Wrong_number_of_arguments");
         }
         instance = static_cast<instance_t*>(id.getSymbol().getData());
 
@@ -353,7 +410,7 @@ void ExpressionBuilder::exprCallEnd(uint32_t n)
         break;
 
     default:
-        handleError(TypeException{"$Function_expected"});
+        handleError("$Function_expected");
         e = makeConstant(0);
         break;
     }
@@ -613,7 +670,7 @@ void ExpressionBuilder::exprForAllBegin(const char* name)
     symbol_t symbol = frames.top().addSymbol(name, type, position);
 
     if (!type.isInteger() && !type.isScalar()) {
-        handleError(TypeException{"$Quantifier_must_range_over_integer_or_scalar_set"});
+        handleError("$Quantifier_must_range_over_integer_or_scalar_set");
     }
 }
 
@@ -678,7 +735,7 @@ void ExpressionBuilder::exprProbaQualitative(Constants::kind_t pathType, Constan
 void ExpressionBuilder::exprMinMaxExp(Constants::kind_t kind, PRICETYPE ptype, Constants::kind_t quant)
 {
     if (quant != Constants::DIAMOND) {
-        handleError(TypeException{"$Wrong_path_quantifier"});
+        handleError("$Wrong_path_quantifier");
     }
 
     auto boundVar = fragments[4];
@@ -705,7 +762,7 @@ void ExpressionBuilder::exprMinMaxExp(Constants::kind_t kind, PRICETYPE ptype, C
     case PROBAPRICE:  // use boolean expression
         price = control;
         break;
-    default: handleError(TypeException{"$Unknown_price_type"});
+    default: handleError("$Unknown_price_type");
     }
 
     assert(nb <= fragments.size());
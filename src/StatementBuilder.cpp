@@ -52,28 +52,6 @@ StatementBuilder::~StatementBuilder() noexcept
         delete b;
 }
 
-void StatementBuilder::collectDependencies(std::set<symbol_t>& dependencies, expression_t expr)
-{
-    std::set<symbol_t> symbols;
-    expr.collectPossibleReads(symbols);
-    while (!symbols.empty()) {
-        symbol_t s = *symbols.begin();
-        symbols.erase(s);
-        if (dependencies.find(s) == dependencies.end()) {
-            dependencies.insert(s);
-            if (auto d = s.getData(); d) {
-                if (auto t = s.getType(); !(t.isFunction() || t.isExternalFunction())) {
-                    // assume is its variable, which is not always true
-                    variable_t* v = static_cast<variable_t*>(d);
-                    v->expr.collectPossibleReads(symbols);
-                } else {
-                    // TODO; fixme.
-                }
-            }
-        }
-    }
-}
-
 void StatementBuilder::collectDependencies(std::set<symbol_t>& dependencies, type_t type)
 {
     if (type.getKind() == RANGE) {
@@ -121,7 +99,7 @@ void StatementBuilder::typeArrayOfType(size_t n)
     }
 
     if ((!size.isInteger() && !size.isScalar()) || !size.is(RANGE)) {
-        handleError(TypeException{"$Array_must_be_defined_over_an_integer_range_or_a_scalar_set"});
+        handleError("$Array_must_be_defined_over_an_integer_range_or_a_scalar_set");
     }
 }
 
@@ -152,7 +130,7 @@ void StatementBuilder::structField(const char* name)
 
     // Constant fields are not allowed
     if (type.is(CONSTANT)) {
-        handleError(TypeException{"$Constant_fields_not_allowed_in_struct"});
+        handleError("$Constant_fields_not_allowed_in_struct");
     }
 
     fields.push_back(type);
@@ -165,7 +143,7 @@ void StatementBuilder::structField(const char* name)
      */
     type_t base = type.stripArray();
     if (!base.isRecord() && !base.isScalar() && !base.isIntegral()) {
-        handleError(TypeException{"$Invalid_type_in_structure"});
+        handleError("$Invalid_type_in_structure");
     }
 }
 
@@ -183,7 +161,7 @@ void StatementBuilder::declTypeDef(const char* name)
         throw DuplicateDefinitionError(name);
     }
 
-    frames.top().addSymbol(name, type, position);
+    addTypeName(frames.top().addSymbol(name, type, position));
 }
 
 static bool initRec(type_t type, int thisTypeOnly)
@@ -253,15 +231,15 @@ void StatementBuilder::declVar(const char* name, bool hasInit)
 
     // Check whether initialiser is allowed/required
     if (hasInit && !initialisable(type)) {
-        handleError(TypeException{"$Cannot_have_initialiser"});
+        handleError("$Cannot_have_initialiser");
     }
 
     if (!hasInit && mustInitialise(type)) {
-        handleError(TypeException{"$Constants_must_have_an_initialiser"});
+        handleError("$Constants_must_have_an_initialiser");
     }
 
     if (currentFun && !initialisable(type)) {
-        handleError(TypeException{"$Type_is_not_allowed_in_functions"});
+        handleError("$Type_is_not_allowed_in_functions");
     }
 
     // Add variable to document
@@ -403,7 +381,7 @@ void StatementBuilder::declFuncEnd()
      * statement is a return statement.
      */
     if (!currentFun->uid.getType()[0].isVoid() && !currentFun->body->returns()) {
-        handleError(TypeException{"$Return_statement_expected"});
+        handleError("$Return_statement_expected");
     }
 
     /* Pop outer function block.
@@ -424,7 +402,7 @@ void StatementBuilder::dynamicLoadLib(const char* lib)
     // check that we have a library
     size_t len = strlen(lib);
     if (len <= 2) {
-        handleError(TypeException{"Cannot_load_empty_library_path"});
+        handleError("Cannot_load_empty_library_path");
         return;
     }
 
@@ -629,16 +607,16 @@ void StatementBuilder::exprStatement()
 void StatementBuilder::returnStatement(bool args)
 {  // 1 expr if argument is true
     if (!currentFun) {
-        handleError(TypeException{"$Cannot_return_outside_of_function_declaration"});
+        handleError("$Cannot_return_outside_of_function_declaration");
     } else {
         /* Only functions with non-void return type are allowed to have
          * arguments on return.
          */
         type_t return_type = currentFun->uid.getType()[0];
         if (return_type.isVoid() && args) {
-            handleError(TypeException{"$return_with_a_value_in_function_returning_void"});
+            handleError("$return_with_a_value_in_function_returning_void");
         } else if (!return_type.isVoid() && !args) {
-            handleError(TypeException{"$return_with_no_value_in_function_returning_non-void"});
+            handleError("$return_with_no_value_in_function_returning_non-void");
         }
 
         std::unique_ptr<ReturnStatement> stat;
@@ -670,6 +648,6 @@ void StatementBuilder::exprCallBegin()
      * the type checker.
      */
     if (currentFun != nullptr && currentFun->uid == fragments[0].getSymbol()) {
-        handleError(TypeException{"$Recursion_is_not_allowed"});
+        handleError("$Recursion_is_not_allowed");
     }
 }
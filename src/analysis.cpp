@@ -0,0 +1,79 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "analysis.h"
+
+#include <cctype>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    void addIdentifiers(const string& text, std::set<string>& identifiers)
+    {
+        for (size_t i = 0; i < text.size();) {
+            const auto c = static_cast<unsigned char>(text[i]);
+            if (std::isalpha(c) || c == '_') {
+                auto j = i + 1;
+                while (j < text.size() && (std::isalnum(static_cast<unsigned char>(text[j])) || text[j] == '_'))
+                    ++j;
+                identifiers.insert(text.substr(i, j - i));
+                i = j;
+            } else {
+                ++i;
+            }
+        }
+    }
+}  // namespace
+
+void UTAP::splitUpdate(const expression_t& update, vector<expression_t>& items)
+{
+    if (update.empty())
+        return;
+    if (update.getKind() == COMMA) {
+        splitUpdate(update[0], items);
+        splitUpdate(update[1], items);
+    } else {
+        items.push_back(update);
+    }
+}
+
+std::set<string> UTAP::queriedIdentifiers(Document& document, const vector<string>& queries)
+{
+    auto identifiers = std::set<string>{};
+    for (const auto& query : document.getQueries())
+        addIdentifiers(query.formula, identifiers);
+    for (const auto& query : queries)
+        addIdentifiers(query, identifiers);
+    return identifiers;
+}
+
+void UTAP::updateProcessTypes(Document& document)
+{
+    for (auto& process : document.getProcesses())
+        if (process.unbound == 0)
+            process.uid.setType(type_t::createProcess(process.templ->frame));
+}
@@ -0,0 +1,53 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_ANALYSIS_H
+#define UTAP_ANALYSIS_H
+
+#include "utap/document.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+/* Helpers shared by the analyses and transformations of documents. */
+
+namespace UTAP
+{
+    /** Appends the expressions of an update, separated by commas, to \a items. */
+    void splitUpdate(const expression_t& update, std::vector<expression_t>& items);
+
+    /**
+     * Returns the identifiers occurring in the queries of \a document and
+     * in \a queries. Qualified names like "P(1).x" give "P" and "x".
+     */
+    std::set<std::string> queriedIdentifiers(Document& document, const std::vector<std::string>& queries);
+
+    /**
+     * Recreates the types of the processes, which list the members of
+     * their templates, after declarations were added to or removed from
+     * the templates.
+     */
+    void updateProcessTypes(Document& document);
+}  // namespace UTAP
+
+#endif /* UTAP_ANALYSIS_H */
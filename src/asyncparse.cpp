@@ -0,0 +1,249 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/asyncparse.h"
+
+#include "utap/DocumentBuilder.hpp"
+#include "utap/evaluator.h"
+#include "utap/typechecker.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <cstring>
+
+using namespace UTAP;
+
+namespace
+{
+    using read_t = std::function<int(char*, int)>;
+
+    constexpr size_t report_interval = 64 * 1024;
+
+    class Reporter
+    {
+        const std::function<void(const parse_progress_t&)>& callback;
+        size_t reported{0};
+
+    public:
+        parse_progress_t progress;
+
+        Reporter(const std::function<void(const parse_progress_t&)>& callback, size_t total): callback{callback}
+        {
+            progress.total = total;
+        }
+
+        void report()
+        {
+            reported = progress.bytes;
+            if (callback)
+                callback(progress);
+        }
+
+        void report(parse_progress_t::phase_t phase)
+        {
+            progress.phase = phase;
+            report();
+        }
+
+        void consumed(size_t bytes)
+        {
+            progress.bytes += bytes;
+            if (progress.bytes - reported >= report_interval)
+                report();
+        }
+    };
+
+    /** Counts the templates as they are completed. */
+    class ProgressBuilder : public DocumentBuilder
+    {
+        Reporter& reporter;
+
+    public:
+        ProgressBuilder(Document& document, std::vector<std::filesystem::path> paths, Reporter& reporter):
+            DocumentBuilder{document, std::move(paths)}, reporter{reporter}
+        {}
+
+        void procEnd() override
+        {
+            DocumentBuilder::procEnd();
+            ++reporter.progress.templates;
+            reporter.report();
+        }
+    };
+
+    std::unique_ptr<Document> parse(const read_t& input, size_t total, const parse_options_t& options)
+    {
+        auto document = std::make_unique<Document>();
+        auto reporter = Reporter{options.progress, total};
+        reporter.report(parse_progress_t::PARSING);
+        auto read = [&](char* buffer, int len) {
+            const auto count = input(buffer, len);
+            if (count > 0)
+                reporter.consumed(count);
+            return count;
+        };
+        {
+            // the XML reader only holds the parser to parse each element, see parserMutex()
+            auto builder = ProgressBuilder{*document, options.libpaths, reporter};
+            if (parseXMLInput(read, &builder, options.newxta) != 0)
+                throw std::runtime_error{"Failed to create the XML reader"};
+        }
+        if (!document->hasErrors()) {
+            reporter.report(parse_progress_t::TYPE_CHECKING);
+            auto checker = TypeChecker{*document};
+            document->accept(checker);
+            if (!document->hasErrors())
+                evaluateBounds(*document);
+        }
+        reporter.report(parse_progress_t::DONE);
+        return document;
+    }
+
+    std::future<std::unique_ptr<Document>> launch(std::function<std::unique_ptr<Document>()> job,
+                                                  const parse_options_t& options)
+    {
+        if (!options.executor)
+            return std::async(std::launch::async, std::move(job));
+        auto task = std::make_shared<std::packaged_task<std::unique_ptr<Document>()>>(std::move(job));
+        auto result = task->get_future();
+        options.executor([task] { (*task)(); });
+        return result;
+    }
+}  // namespace
+
+std::future<std::unique_ptr<Document>> UTAP::parseXMLFileAsync(std::filesystem::path file, parse_options_t options)
+{
+    return launch(
+        [file = std::move(file), options]() {
+            auto is = std::ifstream{file, std::ios::binary};
+            if (!is)
+                throw std::runtime_error{"Cannot open " + file.string()};
+            auto error = std::error_code{};
+            const auto total = std::filesystem::file_size(file, error);
+            auto read = [&is](char* buffer, int len) -> int {
+                is.read(buffer, len);
+                if (is.bad())
+                    return -1;
+                return static_cast<int>(is.gcount());
+            };
+            return parse(read, error ? 0 : total, options);
+        },
+        options);
+}
+
+std::future<std::unique_ptr<Document>> UTAP::parseXMLBufferAsync(std::string buffer, parse_options_t options)
+{
+    return launch(
+        [buffer = std::move(buffer), options]() {
+            auto offset = size_t{0};
+            auto read = [&](char* data, int len) {
+                const auto count = std::min(buffer.size() - offset, static_cast<size_t>(len));
+                std::memcpy(data, buffer.data() + offset, count);
+                offset += count;
+                return static_cast<int>(count);
+            };
+            return parse(read, buffer.size(), options);
+        },
+        options);
+}
+
+ParseSession::ParseSession(parse_options_t options, size_t capacity): capacity{capacity}
+{
+    result = launch(
+        [this, options]() {
+            struct stop_t
+            {
+                ParseSession& session;
+                ~stop_t()
+                {
+                    auto lock = std::lock_guard{session.mutex};
+                    session.stopped = true;
+                    session.chunks.clear();
+                    session.offset = 0;
+                    session.buffered = 0;
+                    session.changed.notify_all();
+                }
+            };
+            auto stop = stop_t{*this};
+            return parse([this](char* buffer, int len) { return read(buffer, len); }, 0, options);
+        },
+        options);
+}
+
+ParseSession::~ParseSession()
+{
+    if (result.valid()) {
+        close();
+        try {
+            result.get();
+        } catch (...) {
+        }
+    }
+}
+
+void ParseSession::feed(std::string_view chunk)
+{
+    if (chunk.empty())
+        return;
+    auto lock = std::unique_lock{mutex};
+    changed.wait(lock, [&] { return stopped || buffered == 0 || buffered + chunk.size() <= capacity; });
+    if (stopped)
+        return;
+    chunks.emplace_back(chunk);
+    buffered += chunk.size();
+    changed.notify_all();
+}
+
+void ParseSession::close()
+{
+    auto lock = std::lock_guard{mutex};
+    closed = true;
+    changed.notify_all();
+}
+
+std::unique_ptr<Document> ParseSession::finish()
+{
+    close();
+    return result.get();
+}
+
+int ParseSession::read(char* buffer, int len)
+{
+    auto lock = std::unique_lock{mutex};
+    changed.wait(lock, [this] { return !chunks.empty() || closed; });
+    if (chunks.empty())
+        return 0;
+    const auto& chunk = chunks.front();
+    const auto count = std::min(chunk.size() - offset, static_cast<size_t>(len));
+    std::memcpy(buffer, chunk.data() + offset, count);
+    offset += count;
+    buffered -= count;
+    if (offset == chunk.size()) {
+        chunks.pop_front();
+        offset = 0;
+    }
+    changed.notify_all();
+    return static_cast<int>(count);
+}
@@ -0,0 +1,337 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/callgraph.h"
+
+#include "utap/statement.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::vector;
+
+namespace
+{
+    using bits_t = vector<uint64_t>;
+
+    void unite(bits_t& bits, const bits_t& other)
+    {
+        if (bits.size() < other.size())
+            bits.resize(other.size());
+        for (size_t i = 0; i < other.size(); ++i)
+            bits[i] |= other[i];
+    }
+
+    bool intersects(const bits_t& a, const bits_t& b)
+    {
+        for (size_t i = 0; i < std::min(a.size(), b.size()); ++i)
+            if (a[i] & b[i])
+                return true;
+        return false;
+    }
+
+    bool isFunction(const symbol_t& symbol)
+    {
+        const auto& type = symbol.getType();
+        return type.isFunction() || type.isExternalFunction();
+    }
+
+    /** Dense numbering of the variables accessed by functions. */
+    class Variables
+    {
+        std::map<symbol_t, size_t> numbers;
+        vector<symbol_t> symbols;
+
+    public:
+        void insert(bits_t& bits, const symbol_t& symbol)
+        {
+            const auto [it, added] = numbers.emplace(symbol, symbols.size());
+            if (added)
+                symbols.push_back(symbol);
+            const auto number = it->second;
+            if (bits.size() <= number / 64)
+                bits.resize(number / 64 + 1);
+            bits[number / 64] |= uint64_t{1} << (number % 64);
+        }
+
+        std::set<symbol_t> decode(const bits_t& bits) const
+        {
+            auto result = std::set<symbol_t>{};
+            for (size_t i = 0; i < bits.size(); ++i)
+                for (size_t j = 0; j < 64; ++j)
+                    if (bits[i] & (uint64_t{1} << j))
+                        result.insert(symbols[i * 64 + j]);
+            return result;
+        }
+    };
+
+    /** The direct effects of a function, i.e. not counting the functions it calls. */
+    struct effects_t
+    {
+        std::set<symbol_t> reads;
+        std::set<symbol_t> writes;
+        std::set<symbol_t> calls;
+        bool random{false};
+    };
+
+    class Collector : public ExpressionVisitor
+    {
+        effects_t& effects;
+
+        /** Reads the indices of an assignment target, but not the target itself. */
+        void target(const expression_t& expr)
+        {
+            switch (expr.getKind()) {
+            case IDENTIFIER: return;
+            case ARRAY:
+                target(expr[0]);
+                walk(expr[1]);
+                return;
+            case DOT: target(expr[0]); return;
+            default: walk(expr);
+            }
+        }
+
+        void walk(const expression_t& expr)
+        {
+            if (expr.empty())
+                return;
+            switch (expr.getKind()) {
+            case IDENTIFIER:
+                if (!isFunction(expr.getSymbol()))
+                    effects.reads.insert(expr.getSymbol());
+                return;
+            case ASSIGN:
+                expr[0].getSymbols(effects.writes);
+                target(expr[0]);
+                walk(expr[1]);
+                return;
+            case ASSPLUS:
+            case ASSMINUS:
+            case ASSDIV:
+            case ASSMOD:
+            case ASSMULT:
+            case ASSAND:
+            case ASSOR:
+            case ASSXOR:
+            case ASSLSHIFT:
+            case ASSRSHIFT:
+            case POSTINCREMENT:
+            case POSTDECREMENT:
+            case PREINCREMENT:
+            case PREDECREMENT: expr[0].getSymbols(effects.writes); break;
+            case FUNCALL:
+            case EFUNCALL:
+                if (expr[0].getKind() == IDENTIFIER) {
+                    const auto callee = expr[0].getSymbol();
+                    effects.calls.insert(callee);
+                    // the callee may read and write the arguments of non-constant reference parameters
+                    const auto& type = callee.getType();
+                    for (uint32_t i = 1; i < expr.getSize(); ++i) {
+                        if (i < type.size() && type[i].is(REF) && !type[i].isConstant())
+                            expr[i].getSymbols(effects.writes);
+                        walk(expr[i]);
+                    }
+                    return;
+                }
+                break;
+            case RANDOM_F:
+            case RANDOM_ARCSINE_F:
+            case RANDOM_BETA_F:
+            case RANDOM_GAMMA_F:
+            case RANDOM_NORMAL_F:
+            case RANDOM_POISSON_F:
+            case RANDOM_TRI_F:
+            case RANDOM_WEIBULL_F: effects.random = true; break;
+            default: break;
+            }
+            for (uint32_t i = 0; i < expr.getSize(); ++i)
+                walk(expr[i]);
+        }
+
+    protected:
+        void visitExpression(expression_t expr) override { walk(expr); }
+
+    public:
+        explicit Collector(effects_t& effects): effects{effects} {}
+    };
+}  // namespace
+
+bool CallGraph::node_t::isExternal() const { return symbol.getType().isExternalFunction(); }
+
+CallGraph::CallGraph(Document& document)
+{
+    // the frames of the variables visible to the functions of each node
+    auto scopes = vector<std::pair<frame_t, frame_t>>{};
+    const auto add = [&](const declarations_t& declarations, const frame_t& global) {
+        for (const auto& fun : declarations.functions) {
+            indices.emplace(fun.uid, nodes.size());
+            nodes.push_back({fun.uid, &fun, {}, 0});
+            scopes.emplace_back(global, declarations.frame);
+        }
+    };
+    auto& globals = document.getGlobals();
+    add(globals, globals.frame);
+    for (const auto& templ : document.getTemplates())
+        add(templ, globals.frame);
+    for (const auto* templ : document.getDynamicTemplates())
+        add(*templ, globals.frame);
+
+    auto variables = Variables{};
+    auto reads = vector<bits_t>(nodes.size());
+    auto writes = vector<bits_t>(nodes.size());
+    auto random = vector<bool>(nodes.size(), false);
+    auto parameters = vector<std::pair<std::set<symbol_t>, std::set<symbol_t>>>(nodes.size());  // read, written
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        auto& node = nodes[n];
+        if (node.isExternal() || !node.function->body)
+            continue;
+        auto effects = effects_t{};
+        auto collector = Collector{effects};
+        node.function->body->accept(&collector);
+        random[n] = effects.random;
+        for (const auto& callee : effects.calls)
+            if (const auto it = indices.find(callee); it != indices.end())
+                node.callees.push_back(it->second);
+
+        const auto& [global, local] = scopes[n];
+        const auto& frame = node.function->body->getFrame();
+        const auto count = node.symbol.getType().size() - 1;
+        const auto visible = [&](const symbol_t& symbol) {
+            return global.getIndexOf(symbol) != -1 || (local != global && local.getIndexOf(symbol) != -1);
+        };
+        const auto isParameter = [&](const symbol_t& symbol) {
+            const auto index = frame.getIndexOf(symbol);
+            return index != -1 && static_cast<size_t>(index) < count;
+        };
+        for (const auto& symbol : effects.reads) {
+            if (visible(symbol)) {
+                variables.insert(reads[n], symbol);
+            } else if (isParameter(symbol)) {
+                parameters[n].first.insert(symbol);
+            }
+        }
+        for (const auto& symbol : effects.writes) {
+            if (visible(symbol)) {
+                variables.insert(writes[n], symbol);
+            } else if (isParameter(symbol)) {
+                parameters[n].second.insert(symbol);
+            }
+        }
+    }
+
+    // Tarjan's algorithm, which finds the components of the callees first
+    auto index = vector<int32_t>(nodes.size(), -1);
+    auto lowlink = vector<int32_t>(nodes.size(), 0);
+    auto onStack = vector<bool>(nodes.size(), false);
+    auto stack = vector<size_t>{};
+    auto counter = 0;
+    std::function<void(size_t)> connect = [&](size_t n) {
+        index[n] = lowlink[n] = counter++;
+        stack.push_back(n);
+        onStack[n] = true;
+        for (const auto callee : nodes[n].callees) {
+            if (index[callee] == -1) {
+                connect(callee);
+                lowlink[n] = std::min(lowlink[n], lowlink[callee]);
+            } else if (onStack[callee]) {
+                lowlink[n] = std::min(lowlink[n], index[callee]);
+            }
+        }
+        if (lowlink[n] == index[n]) {
+            auto& component = components.emplace_back();
+            auto member = size_t{};
+            do {
+                member = stack.back();
+                stack.pop_back();
+                onStack[member] = false;
+                nodes[member].component = components.size() - 1;
+                component.push_back(member);
+            } while (member != n);
+            std::sort(component.begin(), component.end());
+        }
+    };
+    for (size_t n = 0; n < nodes.size(); ++n)
+        if (index[n] == -1)
+            connect(n);
+
+    // summaries, bottom up
+    summaries.resize(nodes.size());
+    auto componentReads = vector<bits_t>(components.size());
+    auto componentWrites = vector<bits_t>(components.size());
+    for (size_t c = 0; c < components.size(); ++c) {
+        const auto& component = components[c];
+        auto& r = componentReads[c];
+        auto& w = componentWrites[c];
+        auto external = false;
+        auto randomised = false;
+        auto recursive = component.size() > 1;
+        for (const auto n : component) {
+            unite(r, reads[n]);
+            unite(w, writes[n]);
+            external = external || nodes[n].isExternal();
+            randomised = randomised || random[n];
+            for (const auto callee : nodes[n].callees) {
+                const auto other = nodes[callee].component;
+                if (other == c) {
+                    recursive = true;
+                    continue;
+                }
+                unite(r, componentReads[other]);
+                unite(w, componentWrites[other]);
+                external = external || summaries[callee].external;
+                randomised = randomised || summaries[callee].random;
+            }
+        }
+        const auto readSet = variables.decode(r);
+        const auto writeSet = variables.decode(w);
+        const auto deterministic = !external && !randomised;
+        for (const auto n : component) {
+            const auto& [parameterReads, parameterWrites] = parameters[n];
+            auto& summary = summaries[n];
+            summary.reads = readSet;
+            summary.writes = writeSet;
+            summary.external = external;
+            summary.random = randomised;
+            summary.recursive = recursive;
+            summary.pure = deterministic && writeSet.empty() && parameterWrites.empty();
+            summary.idempotent =
+                deterministic && !intersects(r, w) &&
+                std::none_of(parameterWrites.begin(), parameterWrites.end(),
+                             [&](const symbol_t& symbol) { return parameterReads.count(symbol) > 0; });
+        }
+    }
+}
+
+int32_t CallGraph::find(const symbol_t& function) const
+{
+    const auto it = indices.find(function);
+    return it == indices.end() ? -1 : static_cast<int32_t>(it->second);
+}
+
+const CallGraph::summary_t& CallGraph::getSummary(const symbol_t& function) const
+{
+    return summaries[indices.at(function)];
+}
@@ -0,0 +1,303 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/clockbounds.h"
+
+#include "analysis.h"
+#include "utap/dbm.h"
+#include "utap/evaluator.h"
+#include "utap/systemview.h"
+
+#include <algorithm>
+#include <set>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    using location_bounds_t = ClockBounds::location_bounds_t;
+
+    /** A clock or clock array of SystemView, numbered like the clocks of a DBM. */
+    struct clock_slot_t
+    {
+        uint32_t index; /**< The index of the clock, or of the first element */
+        int32_t first;  /**< The index of the first element of an array */
+        uint32_t size;  /**< The number of elements, 1 for a clock */
+        bool array;
+    };
+
+    /** The edges of a process, with the clocks they reset to a constant. */
+    struct edge_info_t
+    {
+        uint32_t source;
+        uint32_t destination;
+        std::set<uint32_t> resets;
+    };
+
+    bool raise(std::map<uint32_t, int32_t>& bounds, uint32_t clock, int32_t value)
+    {
+        const auto [it, inserted] = bounds.emplace(clock, value);
+        if (inserted || it->second >= value)
+            return inserted;
+        it->second = value;
+        return true;
+    }
+
+    bool raise(location_bounds_t& bounds, const location_bounds_t& other, const std::set<uint32_t>& except = {})
+    {
+        auto changed = false;
+        for (const auto& [clock, value] : other.lower)
+            if (!except.count(clock))
+                changed |= raise(bounds.lower, clock, value);
+        for (const auto& [clock, value] : other.upper)
+            if (!except.count(clock))
+                changed |= raise(bounds.upper, clock, value);
+        return changed;
+    }
+
+    kind_t mirror(kind_t kind)
+    {
+        switch (kind) {
+        case LT: return GT;
+        case LE: return GE;
+        case GT: return LT;
+        case GE: return LE;
+        default: return kind;
+        }
+    }
+
+    class Extraction
+    {
+        const SystemView view;
+        ConstantEvaluator evaluator;
+        std::map<int32_t, clock_slot_t> slots;
+
+    public:
+        vector<string> clocks{"t(0)"};
+        bool diagonals{false};
+        vector<vector<location_bounds_t>> locations;
+
+    private:
+        int32_t constant(const expression_t& expr)
+        {
+            const auto value = evaluator.evaluate(expr);
+            return value ? std::clamp(*value, ClockBounds::none, DBM::maxValue) : DBM::maxValue;
+        }
+
+        /**
+         * The clocks \a expr, bound to process \a p, refers to: all the
+         * elements of an array if the index has no value.
+         */
+        vector<uint32_t> references(int32_t p, const expression_t& expr)
+        {
+            auto result = vector<uint32_t>{};
+            const auto& base = expr.getKind() == ARRAY ? expr[0] : expr;
+            if (base.getKind() != IDENTIFIER)
+                return result;
+            const auto it = slots.find(view.getSlot(p, base.getSymbol()));
+            if (it == slots.end())
+                return result;
+            const auto& slot = it->second;
+            if (expr.getKind() == ARRAY && slot.array) {
+                const auto i = evaluator.evaluate(expr[1]);
+                if (i && *i >= slot.first && uint32_t(*i - slot.first) < slot.size) {
+                    result.push_back(slot.index + (*i - slot.first));
+                    return result;
+                }
+            }
+            for (uint32_t i = 0; i < slot.size; ++i)
+                result.push_back(slot.index + i);
+            return result;
+        }
+
+        /** Gives the clocks read by \a expr the maximal bounds. */
+        void addReads(int32_t p, const expression_t& expr, location_bounds_t& bounds)
+        {
+            auto reads = std::set<symbol_t>{};
+            expr.collectPossibleReads(reads);
+            for (const auto& symbol : reads) {
+                const auto it = slots.find(view.getSlot(p, symbol));
+                if (it == slots.end())
+                    continue;
+                for (uint32_t i = 0; i < it->second.size; ++i) {
+                    raise(bounds.lower, it->second.index + i, DBM::maxValue);
+                    raise(bounds.upper, it->second.index + i, DBM::maxValue);
+                }
+            }
+        }
+
+        /** Adds the bounds of a guard or invariant, bound to process \a p. */
+        void addConstraints(int32_t p, const expression_t& expr, location_bounds_t& bounds)
+        {
+            if (expr.empty())
+                return;
+            switch (const auto kind = expr.getKind()) {
+            case LT:
+            case LE:
+            case GT:
+            case GE:
+            case EQ:
+            case NEQ: {
+                const auto timed = [](const expression_t& side) {
+                    return side.getType().isClock() || side.getType().isDiff();
+                };
+                if (!timed(expr[0]) && !timed(expr[1]))
+                    break;
+                const auto left = references(p, expr[0]);
+                const auto right = references(p, expr[1]);
+                if (left.empty() == right.empty() || timed(expr[left.empty() ? 0 : 1])) {
+                    // a difference of clocks, or a clock in an arithmetic expression
+                    diagonals |= expr[0].getType().isDiff() || expr[1].getType().isDiff() || !left.empty();
+                    addReads(p, expr, bounds);
+                    return;
+                }
+                const auto& clocks = left.empty() ? right : left;
+                const auto relation = left.empty() ? mirror(kind) : kind;
+                const auto value = constant(expr[left.empty() ? 0 : 1]);
+                for (const auto clock : clocks) {
+                    if (relation != LT && relation != LE)
+                        raise(bounds.lower, clock, value);
+                    if (relation != GT && relation != GE)
+                        raise(bounds.upper, clock, value);
+                }
+                return;
+            }
+            case FUNCALL: addReads(p, expr, bounds); return;
+            default: break;
+            }
+            for (uint32_t i = 0; i < expr.getSize(); ++i)
+                addConstraints(p, expr[i], bounds);
+        }
+
+        /** Returns the clocks reset to a constant by an update, and gives the clocks read otherwise maximal bounds. */
+        std::set<uint32_t> addUpdate(int32_t p, const expression_t& update, location_bounds_t& bounds)
+        {
+            auto resets = std::set<uint32_t>{};
+            auto items = vector<expression_t>{};
+            splitUpdate(update, items);
+            for (const auto& item : items) {
+                if (item.getKind() == ASSIGN) {
+                    const auto clocks = references(p, item[0]);
+                    if (clocks.size() == 1 && evaluator.evaluate(item[1])) {
+                        resets.insert(clocks.front());
+                        continue;
+                    }
+                }
+                addReads(p, item, bounds);
+            }
+            return resets;
+        }
+
+        void addProcess(int32_t p)
+        {
+            const auto& process = view.getProcesses()[p];
+            auto& bounds = locations.emplace_back(process.templ->states.size());
+            for (const auto& state : process.templ->states)
+                addConstraints(p, SystemView::bind(process, state.invariant), bounds[state.locNr]);
+
+            auto edges = vector<edge_info_t>{};
+            auto branchpoints = false;
+            for (const auto& edge : process.templ->edges) {
+                branchpoints |= edge.src == nullptr || edge.dst == nullptr;
+                // the guards of edges from branchpoints are attributed to location 0 and spread below
+                auto& source = bounds[edge.src ? edge.src->locNr : 0];
+                addConstraints(p, SystemView::bind(process, edge.guard), source);
+                const auto resets = addUpdate(p, SystemView::bind(process, edge.assign), source);
+                if (edge.src && edge.dst)
+                    edges.push_back({uint32_t(edge.src->locNr), uint32_t(edge.dst->locNr), resets});
+            }
+
+            if (branchpoints) {
+                // every location gets the bounds of the whole template
+                auto all = location_bounds_t{};
+                for (const auto& location : bounds)
+                    raise(all, location);
+                std::fill(bounds.begin(), bounds.end(), all);
+                return;
+            }
+            for (auto changed = true; changed;) {
+                changed = false;
+                for (const auto& edge : edges)
+                    changed |= raise(bounds[edge.source], bounds[edge.destination], edge.resets);
+            }
+        }
+
+    public:
+        explicit Extraction(Document& document): view{document}
+        {
+            const auto& all = view.getSlots();
+            for (size_t slot = 0; slot < all.size(); ++slot) {
+                const auto& [symbol, process] = all[slot];
+                const auto type = symbol.getType();
+                auto info = clock_slot_t{uint32_t(clocks.size()), 0, 1, false};
+                if (type.isArray() && type.getSub().isClock()) {
+                    const auto range = type.getArraySize().getBounds();
+                    if (!range || range->last() < range->first())
+                        continue;
+                    info = {info.index, range->first(), uint32_t(range->last() - range->first() + 1), true};
+                } else if (!type.isClock()) {
+                    continue;
+                }
+                auto name = symbol.getName();
+                if (process != SystemView::none)
+                    name = view.getProcesses()[process].name + "." + name;
+                for (uint32_t i = 0; i < info.size; ++i)
+                    clocks.push_back(info.array ? name + "[" + std::to_string(info.first + int32_t(i)) + "]" : name);
+                slots.emplace(slot, info);
+            }
+            for (size_t p = 0; p < view.getProcesses().size(); ++p)
+                addProcess(p);
+        }
+    };
+}  // namespace
+
+ClockBounds::ClockBounds(Document& document)
+{
+    auto extraction = Extraction{document};
+    clocks = std::move(extraction.clocks);
+    diagonals = extraction.diagonals;
+    locations = std::move(extraction.locations);
+}
+
+int32_t ClockBounds::find(const string& name) const
+{
+    const auto it = std::find(clocks.begin(), clocks.end(), name);
+    return it == clocks.end() ? -1 : it - clocks.begin();
+}
+
+const ClockBounds::location_bounds_t& ClockBounds::getBounds(uint32_t process, uint32_t location) const
+{
+    return locations.at(process).at(location);
+}
+
+void ClockBounds::addBounds(uint32_t process, uint32_t location, vector<int32_t>& lower, vector<int32_t>& upper) const
+{
+    const auto& bounds = getBounds(process, location);
+    for (const auto& [clock, value] : bounds.lower)
+        lower[clock] = std::max(lower[clock], value);
+    for (const auto& [clock, value] : bounds.upper)
+        upper[clock] = std::max(upper[clock], value);
+}
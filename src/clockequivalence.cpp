@@ -0,0 +1,384 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/clockequivalence.h"
+
+#include "analysis.h"
+#include "utap/evaluator.h"
+#include "utap/systemview.h"
+
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <set>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    constexpr auto none = SystemView::none;
+
+    struct edge_info_t
+    {
+        int32_t process;
+        std::map<int32_t, int32_t> resets;  // clock slot to value
+        expression_t channel;               // bound to the process, if the edge synchronises
+        synchronisation_t direction;
+        bool broadcast;
+    };
+
+    /** Adds the symbols of the clocks with a rate in \a expr. */
+    void collectRates(const expression_t& expr, std::set<symbol_t>& symbols)
+    {
+        if (expr.empty())
+            return;
+        if (expr.getKind() == RATE && expr[0].getKind() == IDENTIFIER)
+            symbols.insert(expr[0].getSymbol());
+        for (uint32_t i = 0; i < expr.getSize(); ++i)
+            collectRates(expr[i], symbols);
+    }
+
+    class Analysis
+    {
+        const SystemView view;
+        ConstantEvaluator evaluator;
+        std::set<int32_t> clocks;  // the slots of the scalar clocks
+        std::set<int32_t> unsupported;
+        vector<edge_info_t> edges;
+        std::map<int32_t, vector<size_t>> resetting;  // the edges resetting each clock
+
+        /** Returns false if the channels are known to differ. */
+        bool mayMatch(const expression_t& a, const expression_t& b)
+        {
+            if (a.getKind() != b.getKind())
+                return true;
+            if (a.getKind() == IDENTIFIER)
+                return a.getSymbol() == b.getSymbol();
+            if (a.getKind() == ARRAY) {
+                const auto i = evaluator.evaluate(a[1]);
+                const auto j = evaluator.evaluate(b[1]);
+                return (!i || !j || *i == *j) && mayMatch(a[0], b[0]);
+            }
+            return true;
+        }
+
+        /** Returns true if \a slot is reset to \a value whenever edge \a e fires. */
+        bool covered(int32_t slot, size_t e, int32_t value)
+        {
+            const auto& edge = edges[e];
+            if (const auto it = edge.resets.find(slot); it != edge.resets.end())
+                return it->second == value;
+            if (edge.channel.empty() || edge.direction == SYNC_CSP || (edge.broadcast && edge.direction == SYNC_BANG))
+                return false;
+            const auto wanted = edge.direction == SYNC_BANG ? SYNC_QUE : SYNC_BANG;
+            for (const auto& partner : edges) {
+                if (partner.process == edge.process || partner.channel.empty() || partner.direction != wanted ||
+                    !mayMatch(edge.channel, partner.channel))
+                    continue;
+                const auto it = partner.resets.find(slot);
+                if (it == partner.resets.end() || it->second != value)
+                    return false;
+            }
+            return true;
+        }
+
+        bool implies(int32_t a, int32_t b)
+        {
+            for (const auto e : resetting[a])
+                if (!covered(b, e, edges[e].resets.at(a)))
+                    return false;
+            return true;
+        }
+
+        void addUpdate(int32_t process, const expression_t& update, edge_info_t* edge)
+        {
+            auto items = vector<expression_t>{};
+            splitUpdate(update, items);
+            for (const auto& item : items) {
+                auto writes = std::set<symbol_t>{};
+                item.collectPossibleWrites(writes);
+                for (const auto& symbol : writes) {
+                    const auto slot = view.getSlot(process, symbol);
+                    if (!clocks.count(slot))
+                        continue;
+                    auto value = std::optional<int32_t>{};
+                    if (edge && item.getKind() == ASSIGN && item[0].getKind() == IDENTIFIER &&
+                        item[0].getSymbol() == symbol)
+                        value = evaluator.evaluate(process == none ? item[1]
+                                                                   : SystemView::bind(view.getProcesses()[process],
+                                                                                      item[1]));
+                    if (value) {
+                        edge->resets[slot] = *value;
+                    } else {
+                        unsupported.insert(slot);
+                    }
+                }
+            }
+        }
+
+    public:
+        explicit Analysis(Document& document): view{document}
+        {
+            const auto& slots = view.getSlots();
+            for (size_t slot = 0; slot < slots.size(); ++slot) {
+                const auto& type = slots[slot].symbol.getType();
+                if (type.isClock() && !type.isArray())
+                    clocks.insert(slot);
+            }
+
+            const auto& processes = view.getProcesses();
+            for (size_t p = 0; p < processes.size(); ++p) {
+                const auto& process = processes[p];
+                auto rates = std::set<symbol_t>{};
+                for (const auto& state : process.templ->states)
+                    collectRates(state.invariant, rates);
+                for (const auto& symbol : rates)
+                    unsupported.insert(view.getSlot(p, symbol));
+                for (const auto& edge : process.templ->edges) {
+                    auto& info = edges.emplace_back();
+                    info.process = p;
+                    if (!edge.sync.empty() && edge.sync.getKind() == SYNC) {
+                        info.channel = SystemView::bind(process, edge.sync[0]);
+                        info.direction = edge.sync.getSync();
+                        info.broadcast = edge.sync[0].getType().is(BROADCAST);
+                    }
+                    addUpdate(p, edge.assign, &info);
+                }
+            }
+            // clocks written outside of the processes
+            for (const auto* templ : document.getDynamicTemplates())
+                for (const auto& edge : templ->edges)
+                    addUpdate(none, edge.assign, nullptr);
+            addUpdate(none, document.getBeforeUpdate(), nullptr);
+            addUpdate(none, document.getAfterUpdate(), nullptr);
+
+            for (size_t e = 0; e < edges.size(); ++e)
+                for (const auto& [slot, value] : edges[e].resets)
+                    resetting[slot].push_back(e);
+        }
+
+        clock_equivalence_t classify()
+        {
+            auto classes = vector<vector<int32_t>>{};
+            for (const auto slot : clocks) {
+                if (unsupported.count(slot))
+                    continue;
+                const auto it = std::find_if(classes.begin(), classes.end(), [&](const vector<int32_t>& members) {
+                    return std::all_of(members.begin(), members.end(), [&](int32_t member) {
+                        return implies(slot, member) && implies(member, slot);
+                    });
+                });
+                if (it == classes.end()) {
+                    classes.push_back({slot});
+                } else {
+                    it->push_back(slot);
+                }
+            }
+
+            auto equivalence = clock_equivalence_t{};
+            for (const auto& members : classes) {
+                if (members.size() < 2)
+                    continue;
+                auto& result = equivalence.classes.emplace_back();
+                for (const auto slot : members) {
+                    const auto& [symbol, process] = view.getSlots()[slot];
+                    auto name = symbol.getName();
+                    if (process != none)
+                        name = view.getProcesses()[process].name + "." + name;
+                    result.push_back({std::move(name), symbol, process});
+                }
+            }
+            return equivalence;
+        }
+    };
+
+    /** Replaces \a from with \a to in an update, and removes the assignments to \a from. */
+    expression_t replaceUpdate(const expression_t& update, const symbol_t& from, const expression_t& to)
+    {
+        auto items = vector<expression_t>{};
+        splitUpdate(update, items);
+        auto result = expression_t{};
+        for (const auto& item : items) {
+            if (item.getKind() == ASSIGN && item[0].getKind() == IDENTIFIER && item[0].getSymbol() == from)
+                continue;
+            const auto expr = item.subst(from, to);
+            result = result.empty() ? expr
+                                    : expression_t::createBinary(COMMA, result, expr, expr.getPosition(),
+                                                                 expr.getType());
+        }
+        return result.empty() ? expression_t::createConstant(1, update.getPosition()) : result;
+    }
+
+    void replace(template_t& templ, const symbol_t& from, const expression_t& to)
+    {
+        for (auto& state : templ.states) {
+            state.invariant = state.invariant.subst(from, to);
+            state.exponentialRate = state.exponentialRate.subst(from, to);
+            state.costRate = state.costRate.subst(from, to);
+        }
+        for (auto& edge : templ.edges) {
+            edge.guard = edge.guard.subst(from, to);
+            edge.sync = edge.sync.subst(from, to);
+            edge.prob = edge.prob.subst(from, to);
+            edge.assign = replaceUpdate(edge.assign, from, to);
+        }
+    }
+
+    bool usedByFunctions(const declarations_t& declarations, const symbol_t& symbol)
+    {
+        return std::any_of(declarations.functions.begin(), declarations.functions.end(), [&](const function_t& fun) {
+            return fun.depends.count(symbol) > 0 || fun.changes.count(symbol) > 0;
+        });
+    }
+
+    /** Returns true if \a symbol is used by the arguments of a process or a partial instance. */
+    bool usedByInstances(Document& document, const symbol_t& symbol)
+    {
+        const auto symbols = std::set<symbol_t>{symbol};
+        const auto uses = [&](const instance_t& instance) {
+            return std::any_of(instance.mapping.begin(), instance.mapping.end(),
+                               [&](const auto& argument) { return argument.second.dependsOn(symbols); });
+        };
+        return std::any_of(document.getProcesses().begin(), document.getProcesses().end(), uses) ||
+               std::any_of(document.getInstances().begin(), document.getInstances().end(), uses);
+    }
+}  // namespace
+
+size_t clock_equivalence_t::redundant() const
+{
+    auto count = size_t{0};
+    for (const auto& members : classes)
+        count += members.size() - 1;
+    return count;
+}
+
+clock_equivalence_t UTAP::findEquivalentClocks(Document& document) { return Analysis{document}.classify(); }
+
+vector<string> UTAP::mergeEquivalentClocks(Document& document, const clock_equivalence_t& equivalence,
+                                           const vector<string>& queries)
+{
+    using clock_key_t = std::pair<symbol_t, int32_t>;
+    auto classOf = std::map<clock_key_t, size_t>{};
+    for (size_t c = 0; c < equivalence.classes.size(); ++c)
+        for (const auto& clock : equivalence.classes[c])
+            classOf.emplace(clock_key_t{clock.symbol, clock.process}, c);
+    const auto sameClass = [&](const clock_key_t& a, const clock_key_t& b) {
+        const auto i = classOf.find(a);
+        const auto j = classOf.find(b);
+        return i != classOf.end() && j != classOf.end() && i->second == j->second;
+    };
+    // queries name the clocks of processes, not templates, so identifiers are matched
+    const auto names = queriedIdentifiers(document, queries);
+    const auto queried = [&](const symbol_t& symbol) { return names.count(symbol.getName()) > 0; };
+
+    const auto view = SystemView{document};
+    auto processesOf = std::map<const template_t*, vector<int32_t>>{};
+    for (size_t p = 0; p < view.getProcesses().size(); ++p)
+        processesOf[view.getProcesses()[p].templ].push_back(p);
+
+    auto& globals = document.getGlobals();
+    auto removed = vector<string>{};
+    const auto clocksOf = [](const declarations_t& declarations) {
+        auto symbols = vector<symbol_t>{};
+        for (const auto& variable : declarations.variables)
+            if (variable.uid.getType().isClock() && !variable.uid.getType().isArray())
+                symbols.push_back(variable.uid);
+        return symbols;
+    };
+    const auto remove = [&](declarations_t& declarations, const symbol_t& symbol, string name) {
+        declarations.frame.remove(symbol);
+        declarations.variables.remove_if([&](const variable_t& variable) { return variable.uid == symbol; });
+        removed.push_back(std::move(name));
+    };
+
+    // global clocks are replaced by equivalent global clocks declared before them
+    auto kept = vector<symbol_t>{};
+    for (const auto& symbol : clocksOf(globals)) {
+        const auto it = std::find_if(kept.begin(), kept.end(), [&](const symbol_t& other) {
+            return sameClass({symbol, none}, {other, none});
+        });
+        const auto& name = symbol.getName();
+        if (it == kept.end() || usedByFunctions(globals, symbol) || queried(symbol) ||
+            usedByInstances(document, symbol) ||
+            std::any_of(document.getTemplates().begin(), document.getTemplates().end(),
+                        [&](const template_t& templ) { return usedByFunctions(templ, symbol); })) {
+            kept.push_back(symbol);
+            continue;
+        }
+        const auto to = expression_t::createIdentifier(*it);
+        for (auto& templ : document.getTemplates())
+            replace(templ, symbol, to);
+        remove(globals, symbol, name);
+    }
+
+    // local clocks are replaced by equivalent global clocks, or local clocks declared before them
+    for (auto& templ : document.getTemplates()) {
+        const auto found = processesOf.find(&templ);
+        if (found == processesOf.end())
+            continue;
+        const auto& processes = found->second;
+        auto local = vector<symbol_t>{};
+        for (const auto& symbol : clocksOf(templ)) {
+            const auto equivalent = [&](const symbol_t& other, bool global) {
+                return std::all_of(processes.begin(), processes.end(), [&](int32_t p) {
+                    return sameClass({symbol, p}, {other, global ? none : p});
+                });
+            };
+            auto to = expression_t{};
+            if (const auto it = std::find_if(kept.begin(), kept.end(),
+                                             [&](const symbol_t& other) { return equivalent(other, true); });
+                it != kept.end()) {
+                to = expression_t::createIdentifier(*it);
+            } else if (const auto it = std::find_if(local.begin(), local.end(),
+                                                    [&](const symbol_t& other) { return equivalent(other, false); });
+                       it != local.end()) {
+                to = expression_t::createIdentifier(*it);
+            }
+            const auto name = templ.uid.getName() + "." + symbol.getName();
+            if (to.empty() || usedByFunctions(templ, symbol) || queried(symbol)) {
+                local.push_back(symbol);
+                continue;
+            }
+            replace(templ, symbol, to);
+            remove(templ, symbol, name);
+        }
+    }
+
+    if (!removed.empty())
+        updateProcessTypes(document);
+    return removed;
+}
+
+std::ostream& UTAP::operator<<(std::ostream& os, const clock_equivalence_t& equivalence)
+{
+    for (const auto& members : equivalence.classes) {
+        for (size_t i = 0; i < members.size(); ++i)
+            os << (i == 0 ? "" : " == ") << members[i].name;
+        os << '\n';
+    }
+    return os << "redundant clocks: " << equivalence.redundant() << '\n';
+}
@@ -0,0 +1,358 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/costmodel.h"
+
+#include "utap/statement.h"
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::vector;
+
+namespace
+{
+    /** Sums the cost of the expressions of a function body, scaling loop bodies. */
+    class BodyCost : public ExpressionVisitor
+    {
+        CostModel& model;
+        double scale{1};
+
+        template <typename Statement, typename Visit>
+        int32_t loop(Statement* stat, Visit visit)
+        {
+            const auto outer = scale;
+            scale *= model.getWeights().loop;
+            const auto result = visit(stat);
+            scale = outer;
+            return result;
+        }
+
+    protected:
+        void visitExpression(expression_t expr) override
+        {
+            if (!expr.empty())
+                total += scale * model.cost(expr);
+        }
+
+    public:
+        double total{0};
+
+        explicit BodyCost(CostModel& model): model{model} {}
+
+        int32_t visitForStatement(ForStatement* stat) override
+        {
+            return loop(stat, [this](auto* s) { return ExpressionVisitor::visitForStatement(s); });
+        }
+        int32_t visitIterationStatement(IterationStatement* stat) override
+        {
+            return loop(stat, [this](auto* s) { return ExpressionVisitor::visitIterationStatement(s); });
+        }
+        int32_t visitWhileStatement(WhileStatement* stat) override
+        {
+            return loop(stat, [this](auto* s) { return ExpressionVisitor::visitWhileStatement(s); });
+        }
+        int32_t visitDoWhileStatement(DoWhileStatement* stat) override
+        {
+            return loop(stat, [this](auto* s) { return ExpressionVisitor::visitDoWhileStatement(s); });
+        }
+    };
+
+    bool isRelational(kind_t kind) { return kind >= LT && kind <= GT; }
+
+    bool isClockValued(const expression_t& expr) { return expr.getType().isClock() || expr.getType().isDiff(); }
+
+    bool isTrue(const expression_t& expr)
+    {
+        return expr.getKind() == CONSTANT && expr.getType().isIntegral() && expr.getValue() != 0;
+    }
+
+    void flatten(const expression_t& expr, vector<expression_t>& conjuncts)
+    {
+        if (expr.getKind() == AND) {
+            flatten(expr[0], conjuncts);
+            flatten(expr[1], conjuncts);
+        } else {
+            conjuncts.push_back(expr);
+        }
+    }
+
+    /** The type the type checker gives to the conjunction of \a conjuncts. */
+    type_t conjunctionType(const vector<expression_t>& conjuncts, size_t count, const type_t& fallback)
+    {
+        const auto all = [&](auto predicate) {
+            return std::all_of(conjuncts.begin(), conjuncts.begin() + count,
+                               [&](const expression_t& e) { return predicate(e.getType()); });
+        };
+        if (all([](const type_t& t) { return t.isIntegral(); }))
+            return type_t::createPrimitive(Constants::BOOL);
+        if (all([](const type_t& t) { return t.isInvariant(); }))
+            return type_t::createPrimitive(INVARIANT);
+        if (all([](const type_t& t) { return t.isInvariant() || t.is(INVARIANT_WR); }))
+            return type_t::createPrimitive(INVARIANT_WR);
+        if (all([](const type_t& t) { return t.isGuard(); }))
+            return type_t::createPrimitive(GUARD);
+        if (all([](const type_t& t) { return t.isConstraint(); }))
+            return type_t::createPrimitive(CONSTRAINT);
+        return fallback;
+    }
+
+    /** Orders the side effect free conjuncts \a indices in place by rank,
+        such that no conjunct which may fail moves before a conjunct
+        preceding it. */
+    void order(vector<size_t>& indices, const vector<double>& rank, const vector<bool>& failing)
+    {
+        auto ordered = vector<size_t>{};
+        ordered.reserve(indices.size());
+        auto placed = vector<bool>(indices.size(), false);
+        while (ordered.size() < indices.size()) {
+            auto best = indices.size();
+            auto prefix = true;  // whether all conjuncts before k are placed
+            for (size_t k = 0; k < indices.size(); ++k) {
+                if (!placed[k] && (prefix || !failing[indices[k]]) &&
+                    (best == indices.size() || rank[indices[k]] < rank[indices[best]]))
+                    best = k;
+                prefix = prefix && placed[k];
+            }
+            placed[best] = true;
+            ordered.push_back(indices[best]);
+        }
+        indices = std::move(ordered);
+    }
+
+    vector<expression_t> reorder(const vector<expression_t>& conjuncts, CostModel& model)
+    {
+        const auto n = conjuncts.size();
+        auto rank = vector<double>(n);
+        auto failing = vector<bool>(n);
+        for (size_t i = 0; i < n; ++i) {
+            const auto p = model.selectivity(conjuncts[i]);
+            rank[i] = p < 1 ? model.cost(conjuncts[i]) / (1 - p) : std::numeric_limits<double>::infinity();
+            failing[i] = mayFail(conjuncts[i]);
+        }
+
+        // conjuncts with side effects split the conjunction into segments ordered independently
+        auto result = vector<expression_t>{};
+        result.reserve(n);
+        auto segment = vector<size_t>{};
+        const auto flush = [&] {
+            order(segment, rank, failing);
+            for (auto i : segment)
+                result.push_back(conjuncts[i]);
+            segment.clear();
+        };
+        for (size_t i = 0; i < n; ++i) {
+            if (isTrue(conjuncts[i])) {
+                continue;  // e.g. the "1 &&" the type checker prefixes invariants with
+            } else if (conjuncts[i].changesAnyVariable()) {
+                flush();
+                result.push_back(conjuncts[i]);
+            } else {
+                segment.push_back(i);
+            }
+        }
+        flush();
+        if (result.empty())
+            result.push_back(conjuncts.front());
+        return result;
+    }
+
+    bool sameOrder(const vector<expression_t>& a, const vector<expression_t>& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                          [](const expression_t& x, const expression_t& y) { return x.equal(y); });
+    }
+
+    expression_t conjunction(const vector<expression_t>& conjuncts, const expression_t& original)
+    {
+        auto expr = conjuncts.front();
+        for (size_t i = 1; i < conjuncts.size(); ++i) {
+            const auto type = conjunctionType(conjuncts, i + 1, original.getType());
+            expr = expression_t::createBinary(AND, expr, conjuncts[i], original.getPosition(), type);
+        }
+        return expr;
+    }
+
+    void reorder(expression_t& expr, CostModel& model, conjunct_savings_t& savings)
+    {
+        if (expr.empty())
+            return;
+        auto conjuncts = vector<expression_t>{};
+        flatten(expr, conjuncts);
+        if (conjuncts.size() < 2)
+            return;
+        const auto reordered = reorder(conjuncts, model);
+        const auto before = model.expectedCost(conjuncts);
+        ++savings.expressions;
+        savings.before += before;
+        if (sameOrder(conjuncts, reordered)) {
+            savings.after += before;
+        } else {
+            ++savings.reordered;
+            savings.after += model.expectedCost(reordered);
+            expr = conjunction(reordered, expr);
+        }
+    }
+}  // namespace
+
+bool UTAP::mayFail(const expression_t& expr)
+{
+    if (expr.empty())
+        return false;
+    switch (expr.getKind()) {
+    case ARRAY:
+        if (expr[1].getKind() != CONSTANT)
+            return true;
+        break;
+    case DIV:
+    case MOD:
+        if (expr[1].getKind() != CONSTANT || (expr[1].getType().isIntegral() && expr[1].getValue() == 0))
+            return true;
+        break;
+    case FUNCALL:
+    case EFUNCALL: return true;
+    default: break;
+    }
+    for (uint32_t i = 0; i < expr.getSize(); ++i)
+        if (mayFail(expr[i]))
+            return true;
+    return false;
+}
+
+double CostModel::cost(const expression_t& expr)
+{
+    if (expr.empty())
+        return 0;
+    auto total = 0.0;
+    auto first = 0u;  // the first subexpression to add
+    switch (expr.getKind()) {
+    case CONSTANT: return 0;
+    case IDENTIFIER: return expr.getType().isConstant() ? 0 : weights.variable;
+    case ARRAY: total = weights.arrayIndex; break;
+    case DOT: break;
+    case DIV:
+    case MOD: total = weights.division; break;
+    case FUNCALL:
+    case EFUNCALL: {
+        first = 1;
+        const auto symbol = expr[0].getSymbol();
+        if (symbol.getType().isFunction() && symbol.getData()) {
+            total = cost(*static_cast<const function_t*>(symbol.getData()));
+        } else {
+            total = weights.call;
+        }
+        break;
+    }
+    case FORALL:
+    case EXISTS:
+    case SUM: return weights.operation + weights.loop * cost(expr[1]);
+    default:
+        if (isRelational(expr.getKind()) && (isClockValued(expr[0]) || isClockValued(expr[1]))) {
+            total = weights.clockConstraint;
+        } else if (expr.getType().isDouble() || (expr.getKind() >= ABS_F && expr.getKind() <= RANDOM_WEIBULL_F)) {
+            total = weights.floatingPoint;
+        } else {
+            total = weights.operation;
+        }
+    }
+    for (auto i = first; i < expr.getSize(); ++i)
+        total += cost(expr[i]);
+    return total;
+}
+
+double CostModel::cost(const function_t& fun)
+{
+    if (auto it = functions.find(&fun); it != functions.end())
+        return it->second;
+    functions.emplace(&fun, weights.call);  // stands in for recursive calls
+    auto body = BodyCost{*this};
+    if (fun.body)
+        fun.body->accept(&body);
+    return functions[&fun] = weights.call + body.total;
+}
+
+double CostModel::selectivity(const expression_t& expr) const
+{
+    switch (expr.getKind()) {
+    case CONSTANT: return expr.getType().isIntegral() ? (expr.getValue() != 0 ? 1 : 0) : weights.unknown;
+    case EQ: return weights.equality;
+    case NEQ: return 1 - weights.equality;
+    case LT:
+    case LE:
+    case GE:
+    case GT: return weights.ordering;
+    case NOT: return 1 - selectivity(expr[0]);
+    case AND: return selectivity(expr[0]) * selectivity(expr[1]);
+    case OR: {
+        const auto a = selectivity(expr[0]);
+        const auto b = selectivity(expr[1]);
+        return a + b - a * b;
+    }
+    default: return weights.unknown;
+    }
+}
+
+double CostModel::expectedCost(const vector<expression_t>& conjuncts)
+{
+    auto total = 0.0;
+    auto reached = 1.0;  // the probability of evaluating the next conjunct
+    for (const auto& conjunct : conjuncts) {
+        total += reached * cost(conjunct);
+        reached *= selectivity(conjunct);
+    }
+    return total;
+}
+
+expression_t UTAP::reorderConjuncts(const expression_t& expr, CostModel& model)
+{
+    auto result = expr;
+    auto savings = conjunct_savings_t{};
+    reorder(result, model, savings);
+    return result;
+}
+
+vector<conjunct_savings_t> UTAP::reorderConjuncts(Document& document, CostModel& model)
+{
+    auto result = vector<conjunct_savings_t>{};
+    for (auto& templ : document.getTemplates()) {
+        auto& savings = result.emplace_back();
+        savings.templ = templ.uid.getName();
+        for (auto& state : templ.states)
+            reorder(state.invariant, model, savings);
+        for (auto& edge : templ.edges)
+            reorder(edge.guard, model, savings);
+    }
+    return result;
+}
+
+std::ostream& UTAP::operator<<(std::ostream& os, const conjunct_savings_t& savings)
+{
+    os << savings.templ << ": " << savings.reordered << " of " << savings.expressions << " reordered, expected cost "
+       << savings.before << " -> " << savings.after;
+    if (savings.before > 0)
+        os << " (" << 100 * (savings.before - savings.after) / savings.before << "% saved)";
+    return os;
+}
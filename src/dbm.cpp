@@ -0,0 +1,355 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/dbm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <ostream>
+#include <cassert>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define UTAP_DBM_AVX2 1
+#include <immintrin.h>
+#endif
+
+using namespace UTAP;
+
+using raw_t = DBM::raw_t;
+
+namespace {
+/** The vectorisable loops of the DBM operations, over whole padded rows. */
+struct kernels_t
+{
+    /** row[j] = min(row[j], bound + pivot[j]) */
+    void (*relax)(raw_t* row, const raw_t* pivot, raw_t bound, uint32_t size);
+    /** a[j] <= b[j] for all j */
+    bool (*lessEqual)(const raw_t* a, const raw_t* b, std::size_t size);
+    /** a[j] = min(a[j], b[j]) */
+    void (*minimum)(raw_t* a, const raw_t* b, std::size_t size);
+};
+
+void relax_scalar(raw_t* row, const raw_t* pivot, raw_t bound, uint32_t size)
+{
+    for (uint32_t j = 0; j < size; ++j) {
+        const auto sum = DBM::add(bound, pivot[j]);
+        if (sum < row[j])
+            row[j] = sum;
+    }
+}
+
+bool less_equal_scalar(const raw_t* a, const raw_t* b, std::size_t size)
+{
+    for (std::size_t j = 0; j < size; ++j)
+        if (a[j] > b[j])
+            return false;
+    return true;
+}
+
+void minimum_scalar(raw_t* a, const raw_t* b, std::size_t size)
+{
+    for (std::size_t j = 0; j < size; ++j)
+        a[j] = std::min(a[j], b[j]);
+}
+
+constexpr kernels_t scalar_kernels{relax_scalar, less_equal_scalar, minimum_scalar};
+
+#ifdef UTAP_DBM_AVX2
+// The rows are cache line aligned and padded to whole cache lines, so
+// sizes are multiples of 16 and all loads and stores are aligned.
+
+__attribute__((target("avx2"))) void relax_avx2(raw_t* row, const raw_t* pivot, raw_t bound, uint32_t size)
+{
+    const auto infinity = _mm256_set1_epi32(DBM::unbounded);
+    const auto one = _mm256_set1_epi32(1);
+    const auto b = _mm256_set1_epi32(bound);
+    for (uint32_t j = 0; j < size; j += 8) {
+        const auto p = _mm256_load_si256(reinterpret_cast<const __m256i*>(pivot + j));
+        const auto r = _mm256_load_si256(reinterpret_cast<const __m256i*>(row + j));
+        auto sum = _mm256_sub_epi32(_mm256_add_epi32(b, p), _mm256_and_si256(_mm256_or_si256(b, p), one));
+        sum = _mm256_blendv_epi8(sum, infinity, _mm256_cmpeq_epi32(p, infinity));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(row + j), _mm256_min_epi32(r, sum));
+    }
+}
+
+__attribute__((target("avx2"))) bool less_equal_avx2(const raw_t* a, const raw_t* b, std::size_t size)
+{
+    for (std::size_t j = 0; j < size; j += 8) {
+        const auto x = _mm256_load_si256(reinterpret_cast<const __m256i*>(a + j));
+        const auto y = _mm256_load_si256(reinterpret_cast<const __m256i*>(b + j));
+        if (!_mm256_testz_si256(_mm256_cmpgt_epi32(x, y), _mm256_cmpgt_epi32(x, y)))
+            return false;
+    }
+    return true;
+}
+
+__attribute__((target("avx2"))) void minimum_avx2(raw_t* a, const raw_t* b, std::size_t size)
+{
+    for (std::size_t j = 0; j < size; j += 8) {
+        const auto x = _mm256_load_si256(reinterpret_cast<const __m256i*>(a + j));
+        const auto y = _mm256_load_si256(reinterpret_cast<const __m256i*>(b + j));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(a + j), _mm256_min_epi32(x, y));
+    }
+}
+
+constexpr kernels_t avx2_kernels{relax_avx2, less_equal_avx2, minimum_avx2};
+#endif
+
+const kernels_t* detect()
+{
+#ifdef UTAP_DBM_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        return &avx2_kernels;
+#endif
+    return &scalar_kernels;
+}
+
+std::atomic<const kernels_t*>& active()
+{
+    static auto kernels = std::atomic<const kernels_t*>{detect()};
+    return kernels;
+}
+
+const kernels_t& kernels() { return *active().load(std::memory_order_relaxed); }
+}  // namespace
+
+bool DBM::isSupported(kernel_t kernel)
+{
+    switch (kernel) {
+    case SCALAR: return true;
+    case AVX2:
+#ifdef UTAP_DBM_AVX2
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+DBM::kernel_t DBM::getKernel() { return &kernels() == &scalar_kernels ? SCALAR : AVX2; }
+
+bool DBM::setKernel(kernel_t kernel)
+{
+    if (!isSupported(kernel))
+        return false;
+#ifdef UTAP_DBM_AVX2
+    active().store(kernel == AVX2 ? &avx2_kernels : &scalar_kernels);
+#else
+    active().store(&scalar_kernels);
+#endif
+    return true;
+}
+
+DBM::DBM(uint32_t dimension):
+    dimension{dimension}, stride{(dimension + 15) & ~15u}, bounds(std::size_t{dimension} * stride, unbounded)
+{
+    assert(dimension > 0);
+}
+
+DBM DBM::createZero(uint32_t dimension)
+{
+    auto dbm = DBM{dimension};
+    for (uint32_t i = 0; i < dimension; ++i)
+        std::fill_n(dbm.row(i), dimension, zero);
+    return dbm;
+}
+
+DBM DBM::createUnbounded(uint32_t dimension)
+{
+    auto dbm = DBM{dimension};
+    std::fill_n(dbm.row(0), dimension, zero);
+    for (uint32_t i = 1; i < dimension; ++i)
+        dbm.row(i)[i] = zero;
+    return dbm;
+}
+
+bool DBM::close()
+{
+    if (isEmpty())
+        return false;
+    const auto& k = kernels();
+    for (uint32_t p = 0; p < dimension; ++p) {
+        const auto* pivot = row(p);
+        for (uint32_t i = 0; i < dimension; ++i) {
+            auto* r = row(i);
+            if (i == p || r[p] == unbounded)
+                continue;
+            k.relax(r, pivot, r[p], stride);
+            if (r[i] < zero) {
+                markEmpty();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool DBM::constrain(uint32_t i, uint32_t j, raw_t bound, bool close)
+{
+    assert(i < dimension && j < dimension && i != j);
+    if (isEmpty())
+        return false;
+    if (bound >= (*this)(i, j))
+        return true;
+    if (add(bound, (*this)(j, i)) < zero) {
+        markEmpty();
+        return false;
+    }
+    row(i)[j] = bound;
+    if (close) {
+        // The matrix was closed, so only the paths through the new edge
+        // i->j can be shorter. Row j and column i are not changed since
+        // the cycle through the edge is not negative.
+        const auto& k = kernels();
+        const auto* pivot = row(j);
+        for (uint32_t r = 0; r < dimension; ++r) {
+            const auto toI = (*this)(r, i);
+            if (toI != unbounded)
+                k.relax(row(r), pivot, add(toI, bound), stride);
+        }
+    }
+    return true;
+}
+
+void DBM::up()
+{
+    if (isEmpty())
+        return;
+    for (uint32_t i = 1; i < dimension; ++i)
+        row(i)[0] = unbounded;
+}
+
+void DBM::down()
+{
+    if (isEmpty())
+        return;
+    for (uint32_t j = 1; j < dimension; ++j) {
+        auto lower = zero;
+        for (uint32_t i = 1; i < dimension; ++i)
+            lower = std::min(lower, (*this)(i, j));
+        row(0)[j] = lower;
+    }
+}
+
+void DBM::reset(uint32_t clock, int32_t value)
+{
+    assert(clock > 0 && clock < dimension && value >= 0 && value <= maxValue);
+    if (isEmpty())
+        return;
+    const auto upper = bound(value, false);
+    const auto lower = bound(-value, false);
+    auto* r = row(clock);
+    for (uint32_t i = 0; i < dimension; ++i) {
+        r[i] = add(upper, (*this)(0, i));
+        row(i)[clock] = add((*this)(i, 0), lower);
+    }
+    r[clock] = zero;
+}
+
+bool DBM::isSubsetOf(const DBM& other) const
+{
+    assert(dimension == other.dimension);
+    if (isEmpty())
+        return true;
+    if (other.isEmpty())
+        return false;
+    return kernels().lessEqual(bounds.data(), other.bounds.data(), bounds.size());
+}
+
+bool DBM::intersects(const DBM& other) const
+{
+    assert(dimension == other.dimension);
+    if (isEmpty() || other.isEmpty())
+        return false;
+    // Both are closed, so the intersection is empty iff it has a negative
+    // cycle of two edges
+    for (uint32_t i = 0; i < dimension; ++i)
+        for (uint32_t j = 0; j < dimension; ++j)
+            if (add((*this)(i, j), other(j, i)) < zero)
+                return false;
+    return true;
+}
+
+bool DBM::intersect(const DBM& other)
+{
+    assert(dimension == other.dimension);
+    if (other.isEmpty())
+        markEmpty();
+    if (isEmpty())
+        return false;
+    kernels().minimum(bounds.data(), other.bounds.data(), bounds.size());
+    return close();
+}
+
+void DBM::extrapolateLU(const std::vector<int32_t>& lower, const std::vector<int32_t>& upper)
+{
+    assert(lower.size() >= dimension && upper.size() >= dimension);
+    if (isEmpty())
+        return;
+    const auto first = std::vector<raw_t>(row(0), row(0) + dimension);
+    for (uint32_t i = 0; i < dimension; ++i) {
+        auto* r = row(i);
+        // The lower bound of x_i is above any constant it is compared to
+        const bool above = i > 0 && first[i] < bound(-lower[i], true);
+        for (uint32_t j = 0; j < dimension; ++j) {
+            if (i == j || r[j] == unbounded)
+                continue;
+            if (i > 0 && (above || r[j] > bound(lower[i], false))) {
+                r[j] = unbounded;
+            } else if (j > 0 && first[j] < bound(-upper[j], true)) {
+                if (i > 0)
+                    r[j] = unbounded;
+                else
+                    r[j] = upper[j] < 0 ? zero : bound(-upper[j], true);
+            }
+        }
+    }
+    close();
+}
+
+bool DBM::operator==(const DBM& other) const
+{
+    if (dimension != other.dimension)
+        return false;
+    if (isEmpty() || other.isEmpty())
+        return isEmpty() && other.isEmpty();
+    return bounds == other.bounds;
+}
+
+std::ostream& UTAP::operator<<(std::ostream& os, const DBM& dbm)
+{
+    if (dbm.isEmpty())
+        return os << "empty";
+    os << '[';
+    for (uint32_t i = 0; i < dbm.getDimension(); ++i) {
+        for (uint32_t j = 0; j < dbm.getDimension(); ++j) {
+            os << (j == 0 ? (i == 0 ? "" : "; ") : " ");
+            const auto raw = dbm(i, j);
+            if (raw == DBM::unbounded)
+                os << "inf";
+            else
+                os << (DBM::isStrict(raw) ? "<" : "<=") << DBM::valueOf(raw);
+        }
+    }
+    return os << ']';
+}
@@ -0,0 +1,425 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/deadcode.h"
+
+#include "analysis.h"
+#include "utap/statement.h"
+#include "utap/systemview.h"
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <set>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    using symbols_t = std::set<symbol_t>;
+
+    /** Adds the symbols of the identifiers of \a expr, including the functions it calls. */
+    void collectIdentifiers(const expression_t& expr, symbols_t& symbols)
+    {
+        if (expr.empty())
+            return;
+        if (expr.getKind() == IDENTIFIER)
+            symbols.insert(expr.getSymbol());
+        for (uint32_t i = 0; i < expr.getSize(); ++i)
+            collectIdentifiers(expr[i], symbols);
+    }
+
+    class BodyIdentifiers : public ExpressionVisitor
+    {
+        symbols_t& symbols;
+
+    protected:
+        void visitExpression(expression_t expr) override { collectIdentifiers(expr, symbols); }
+
+    public:
+        explicit BodyIdentifiers(symbols_t& symbols): symbols{symbols} {}
+    };
+
+    /** The bits needed to store a value of \a type, where integers are stored in the width of their range. */
+    uint32_t bits(const type_t& type)
+    {
+        if (type.isArray()) {
+            auto size = uint64_t{1};
+            if (const auto bounds = type.getArraySize().getBounds(); bounds && bounds->last() >= bounds->first())
+                size = int64_t{bounds->last()} - bounds->first() + 1;
+            return static_cast<uint32_t>(size * bits(type.getSub()));
+        }
+        if (type.isRecord()) {
+            auto total = uint32_t{0};
+            for (size_t i = 0; i < type.getRecordSize(); ++i)
+                total += bits(type.getSub(i));
+            return total;
+        }
+        if (type.isClock() || type.isChannel())
+            return 0;
+        if (type.isDouble())
+            return 64;
+        if (type.isBoolean())
+            return 1;
+        if (type.is(RANGE)) {
+            if (const auto bounds = type.getBounds(); bounds && bounds->last() >= bounds->first()) {
+                auto values = uint64_t(int64_t{bounds->last()} - bounds->first()) + 1;
+                auto width = uint32_t{0};
+                while ((uint64_t{1} << width) < values)
+                    ++width;
+                return width;
+            }
+        }
+        return 32;
+    }
+
+    struct scope_t
+    {
+        declarations_t* declarations;
+        template_t* templ;  // or nullptr for the globals
+        string prefix;
+    };
+
+    enum hook_t { EDGE, BEFORE_UPDATE, AFTER_UPDATE };
+
+    struct item_t
+    {
+        edge_t* edge;  // or nullptr for the items of the before and after updates
+        hook_t hook;
+        expression_t expr;
+        symbols_t reads;
+        symbols_t writes;
+    };
+
+    class Analysis
+    {
+        Document& document;
+        vector<scope_t> scopes;            // the globals and the live templates
+        vector<template_t*> deadTemplates;
+        vector<expression_t> roots;        // expressions whose reads are always live
+        vector<item_t> items;              // the updates of the live templates, split at commas
+        std::map<symbol_t, const variable_t*> variables;  // non-constant variables of the scopes
+        std::map<symbol_t, const function_t*> functions;
+        symbols_t queried;
+        symbols_t removed;
+        symbols_t liveFunctions;
+
+        bool kept(const item_t& item) const
+        {
+            return item.writes.empty() ||
+                   !std::includes(removed.begin(), removed.end(), item.writes.begin(), item.writes.end());
+        }
+
+        void findLive()
+        {
+            auto live = queried;
+            for (const auto& root : roots)
+                root.collectPossibleReads(live);
+            auto effects = vector<std::pair<symbols_t, symbols_t>>{};  // writes and reads
+            for (const auto& item : items)
+                effects.emplace_back(item.writes, item.reads);
+            for (const auto& [symbol, variable] : variables) {
+                auto& [writes, reads] = effects.emplace_back();
+                writes.insert(symbol);
+                variable->expr.collectPossibleReads(reads);
+            }
+            auto applied = vector<bool>(effects.size(), false);
+            for (auto changed = true; changed;) {
+                changed = false;
+                for (size_t i = 0; i < effects.size(); ++i) {
+                    const auto& [writes, reads] = effects[i];
+                    if (!applied[i] && std::any_of(writes.begin(), writes.end(),
+                                                   [&](const symbol_t& s) { return live.count(s) > 0; })) {
+                        applied[i] = changed = true;
+                        live.insert(reads.begin(), reads.end());
+                    }
+                }
+            }
+            for (const auto& [symbol, variable] : variables)
+                if (!live.count(symbol))
+                    removed.insert(symbol);
+        }
+
+        /** Keeps the variables referenced by the remaining code, until nothing changes. */
+        void keepReferenced()
+        {
+            while (true) {
+                auto referenced = queried;
+                for (const auto& root : roots)
+                    collectIdentifiers(root, referenced);
+                for (const auto& item : items)
+                    if (kept(item))
+                        collectIdentifiers(item.expr, referenced);
+                for (const auto& [symbol, variable] : variables)
+                    if (!removed.count(symbol))
+                        collectIdentifiers(variable->expr, referenced);
+
+                liveFunctions.clear();
+                auto worklist = vector<symbol_t>{};
+                for (const auto& symbol : referenced)
+                    if (functions.count(symbol))
+                        worklist.push_back(symbol);
+                while (!worklist.empty()) {
+                    const auto symbol = worklist.back();
+                    worklist.pop_back();
+                    if (!liveFunctions.insert(symbol).second)
+                        continue;
+                    auto body = symbols_t{};
+                    auto visitor = BodyIdentifiers{body};
+                    if (const auto* fun = functions.at(symbol); fun->body)
+                        fun->body->accept(&visitor);
+                    for (const auto& s : body) {
+                        referenced.insert(s);
+                        if (functions.count(s) && !liveFunctions.count(s))
+                            worklist.push_back(s);
+                    }
+                }
+
+                const auto size = removed.size();
+                for (auto it = removed.begin(); it != removed.end();)
+                    it = referenced.count(*it) ? removed.erase(it) : std::next(it);
+                if (removed.size() == size)
+                    break;
+            }
+        }
+
+        void addItems(const expression_t& update, edge_t* edge, hook_t hook)
+        {
+            auto exprs = vector<expression_t>{};
+            splitUpdate(update, exprs);
+            for (auto& expr : exprs) {
+                auto& item = items.emplace_back();
+                item.edge = edge;
+                item.hook = hook;
+                item.expr = std::move(expr);
+                item.expr.collectPossibleReads(item.reads);
+                item.expr.collectPossibleWrites(item.writes);
+            }
+        }
+
+    public:
+        Analysis(Document& document, const vector<string>& extraQueries): document{document}
+        {
+            auto instantiated = std::set<const template_t*>{};
+            for (const auto& process : document.getProcesses())
+                instantiated.insert(process.templ);
+            const auto& dynamic = document.getDynamicTemplates();
+            scopes.reserve(document.getTemplates().size() + 1);
+            scopes.push_back({&document.getGlobals(), nullptr, ""});
+            for (auto& templ : document.getTemplates()) {
+                if (instantiated.count(&templ) || !templ.isTA ||
+                    std::find(dynamic.begin(), dynamic.end(), &templ) != dynamic.end()) {
+                    scopes.push_back({&templ, &templ, templ.uid.getName() + "."});
+                } else {
+                    deadTemplates.push_back(&templ);
+                }
+            }
+
+            const auto names = queriedIdentifiers(document, extraQueries);
+
+            for (auto& scope : scopes) {
+                for (const auto& variable : scope.declarations->variables) {
+                    if (!variable.uid.getType().isConstant())
+                        variables.emplace(variable.uid, &variable);
+                    if (names.count(variable.uid.getName()))
+                        queried.insert(variable.uid);
+                }
+                for (const auto& fun : scope.declarations->functions) {
+                    functions.emplace(fun.uid, &fun);
+                    if (names.count(fun.uid.getName()))
+                        queried.insert(fun.uid);
+                }
+                for (const auto& progress : scope.declarations->progress) {
+                    roots.push_back(progress.guard);
+                    roots.push_back(progress.measure);
+                }
+                if (auto* templ = scope.templ; templ) {
+                    for (const auto& state : templ->states) {
+                        roots.push_back(state.invariant);
+                        roots.push_back(state.exponentialRate);
+                        roots.push_back(state.costRate);
+                    }
+                    for (auto& edge : templ->edges) {
+                        roots.push_back(edge.guard);
+                        roots.push_back(edge.sync);
+                        roots.push_back(edge.prob);
+                        addItems(edge.assign, &edge, EDGE);
+                    }
+                }
+            }
+            for (auto* list : {&document.getProcesses(), &document.getInstances()})
+                for (const auto& instance : *list)
+                    for (const auto& [parameter, argument] : instance.mapping)
+                        roots.push_back(argument);
+            for (const auto& priority : document.getChanPriorities()) {
+                roots.push_back(priority.head);
+                for (const auto& [separator, channel] : priority.tail)
+                    roots.push_back(channel);
+            }
+            addItems(document.getBeforeUpdate(), nullptr, BEFORE_UPDATE);
+            addItems(document.getAfterUpdate(), nullptr, AFTER_UPDATE);
+
+            findLive();
+            keepReferenced();
+        }
+
+        dead_code_t report() const
+        {
+            auto instances = std::map<const template_t*, uint32_t>{};
+            for (const auto& process : SystemView{document}.getProcesses())
+                ++instances[process.templ];
+
+            auto dead = dead_code_t{};
+            for (const auto* templ : deadTemplates)
+                dead.entries.push_back({dead_code_t::TEMPLATE, templ->uid.getName(), 0, 0});
+            for (const auto& scope : scopes) {
+                const auto count = scope.templ ? instances[scope.templ] : 1;
+                for (const auto& variable : scope.declarations->variables) {
+                    if (!removed.count(variable.uid))
+                        continue;
+                    const auto& type = variable.uid.getType();
+                    dead.entries.push_back({type.isClock() ? dead_code_t::CLOCK : dead_code_t::VARIABLE,
+                                            scope.prefix + variable.uid.getName(), bits(type), count});
+                }
+                for (const auto& fun : scope.declarations->functions)
+                    if (!liveFunctions.count(fun.uid))
+                        dead.entries.push_back({dead_code_t::FUNCTION, scope.prefix + fun.uid.getName(), 0, count});
+            }
+            return dead;
+        }
+
+        void eliminate()
+        {
+            // updates
+            for (auto it = items.begin(); it != items.end();) {
+                auto* edge = it->edge;
+                const auto hook = it->hook;
+                auto end = std::find_if(it, items.end(),
+                                        [&](const item_t& item) { return item.edge != edge || item.hook != hook; });
+                if (!std::all_of(it, end, [&](const item_t& item) { return kept(item); })) {
+                    auto update = expression_t{};
+                    for (; it != end; ++it) {
+                        const auto& expr = it->expr;
+                        if (!kept(*it))
+                            continue;
+                        if (update.empty()) {
+                            update = expr;
+                        } else {
+                            update = expression_t::createBinary(COMMA, update, expr, expr.getPosition(),
+                                                                expr.getType());
+                        }
+                    }
+                    switch (hook) {
+                    case EDGE:
+                        if (update.empty())
+                            update = expression_t::createConstant(1, edge->assign.getPosition());
+                        edge->assign = update;
+                        break;
+                    case BEFORE_UPDATE: document.setBeforeUpdate(update); break;
+                    case AFTER_UPDATE: document.setAfterUpdate(update); break;
+                    }
+                }
+                it = end;
+            }
+
+            // declarations
+            for (auto& scope : scopes) {
+                auto& declarations = *scope.declarations;
+                declarations.variables.remove_if([&](const variable_t& variable) {
+                    const auto dead = removed.count(variable.uid) > 0;
+                    if (dead)
+                        declarations.frame.remove(variable.uid);
+                    return dead;
+                });
+                declarations.functions.remove_if([&](const function_t& fun) {
+                    const auto dead = !liveFunctions.count(fun.uid);
+                    if (dead)
+                        declarations.frame.remove(fun.uid);
+                    return dead;
+                });
+            }
+
+            // templates and their partial instances
+            auto& globals = document.getGlobals().frame;
+            const auto isDead = [&](const template_t* templ) {
+                return std::find(deadTemplates.begin(), deadTemplates.end(), templ) != deadTemplates.end();
+            };
+            document.getInstances().remove_if([&](const instance_t& instance) {
+                const auto dead = isDead(instance.templ);
+                if (dead)
+                    globals.remove(instance.uid);
+                return dead;
+            });
+            for (auto* templ : deadTemplates)
+                globals.remove(templ->uid);
+            document.getTemplates().remove_if([&](const template_t& templ) { return isDead(&templ); });
+
+            updateProcessTypes(document);
+        }
+    };
+}  // namespace
+
+uint64_t dead_code_t::stateBits() const
+{
+    auto total = uint64_t{0};
+    for (const auto& entry : entries)
+        total += uint64_t{entry.bits} * entry.instances;
+    return total;
+}
+
+uint32_t dead_code_t::clocks() const
+{
+    auto total = uint32_t{0};
+    for (const auto& entry : entries)
+        if (entry.entity == CLOCK)
+            total += entry.instances;
+    return total;
+}
+
+dead_code_t UTAP::findDeadCode(Document& document, const vector<string>& queries)
+{
+    return Analysis{document, queries}.report();
+}
+
+dead_code_t UTAP::eliminateDeadCode(Document& document, const vector<string>& queries)
+{
+    auto analysis = Analysis{document, queries};
+    auto dead = analysis.report();
+    analysis.eliminate();
+    return dead;
+}
+
+std::ostream& UTAP::operator<<(std::ostream& os, const dead_code_t& dead)
+{
+    static const char* entities[] = {"variable", "clock", "function", "template"};
+    for (const auto& entry : dead.entries) {
+        os << entities[entry.entity] << ' ' << entry.name;
+        if (entry.bits > 0)
+            os << " (" << entry.bits << " bits x " << entry.instances << ')';
+        os << '\n';
+    }
+    return os << "state bits saved: " << dead.stateBits() << ", clocks saved: " << dead.clocks() << '\n';
+}
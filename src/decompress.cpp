@@ -0,0 +1,225 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "decompress.h"
+
+#ifdef UTAP_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef UTAP_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <cstring>
+
+using namespace UTAP;
+
+namespace
+{
+    constexpr size_t chunk_size = 64 * 1024;
+
+    /** Reads the compressed input in chunks and keeps the unconsumed part. */
+    class Source
+    {
+        read_function_t read;
+        std::vector<char> buffer;
+        bool eof{false};
+
+    public:
+        size_t begin{0}, end{0};
+
+        Source(read_function_t read, std::vector<char> prefix): read{std::move(read)}, buffer{std::move(prefix)}
+        {
+            end = buffer.size();
+            buffer.resize(std::max(chunk_size, end));
+        }
+
+        const char* data() const { return buffer.data() + begin; }
+        size_t available() const { return end - begin; }
+        bool atEnd() const { return eof && available() == 0; }
+
+        /** Reads more input when all has been consumed; returns false on errors. */
+        bool fill()
+        {
+            if (available() > 0 || eof)
+                return true;
+            const auto count = read(buffer.data(), static_cast<int>(buffer.size()));
+            if (count < 0)
+                return false;
+            begin = 0;
+            end = count;
+            eof = (count == 0);
+            return true;
+        }
+    };
+
+    /** Delivers the bytes read ahead to detect the format, then the rest of the input. */
+    class Plain
+    {
+        read_function_t read;
+        std::vector<char> prefix;
+        size_t offset{0};
+
+    public:
+        Plain(read_function_t read, std::vector<char> prefix): read{std::move(read)}, prefix{std::move(prefix)} {}
+
+        int operator()(char* buffer, int len)
+        {
+            if (offset < prefix.size()) {
+                const auto count = std::min(prefix.size() - offset, static_cast<size_t>(len));
+                std::memcpy(buffer, prefix.data() + offset, count);
+                offset += count;
+                return static_cast<int>(count);
+            }
+            return read(buffer, len);
+        }
+    };
+
+#ifdef UTAP_WITH_ZLIB
+    class Gzip
+    {
+        Source source;
+        z_stream stream{};
+        bool failed{false};
+        bool inside{false};  // within a gzip member
+
+    public:
+        Gzip(read_function_t read, std::vector<char> prefix): source{std::move(read), std::move(prefix)}
+        {
+            failed = (inflateInit2(&stream, 15 + 16) != Z_OK);  // gzip header only
+        }
+        Gzip(const Gzip&) = delete;
+        Gzip& operator=(const Gzip&) = delete;
+        ~Gzip() { inflateEnd(&stream); }
+
+        int operator()(char* buffer, int len)
+        {
+            if (failed)
+                return -1;
+            stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            stream.avail_out = len;
+            for (;;) {
+                stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(source.data()));
+                stream.avail_in = source.available();
+                const auto res = inflate(&stream, Z_NO_FLUSH);
+                source.begin = source.end - stream.avail_in;
+                if (res == Z_STREAM_END) {
+                    inflateReset(&stream);  // a gzip file may consist of several members
+                    inside = false;
+                } else if (res == Z_OK) {
+                    inside = true;
+                } else if (res != Z_BUF_ERROR) {
+                    failed = true;
+                    return -1;
+                }
+                if (stream.avail_out < static_cast<uInt>(len))
+                    return len - stream.avail_out;
+                if (source.available() == 0) {
+                    if (!source.fill())
+                        return -1;
+                    if (source.atEnd())
+                        return inside ? -1 : 0;  // truncated input
+                }
+            }
+        }
+    };
+#endif /* UTAP_WITH_ZLIB */
+
+#ifdef UTAP_WITH_ZSTD
+    class Zstd
+    {
+        Source source;
+        std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> context{ZSTD_createDCtx(), ZSTD_freeDCtx};
+        bool failed{false};
+        bool inside{false};  // within a zstd frame
+
+    public:
+        Zstd(read_function_t read, std::vector<char> prefix): source{std::move(read), std::move(prefix)} {}
+
+        int operator()(char* buffer, int len)
+        {
+            if (failed || !context)
+                return -1;
+            auto output = ZSTD_outBuffer{buffer, static_cast<size_t>(len), 0};
+            for (;;) {
+                auto input = ZSTD_inBuffer{source.data(), source.available(), 0};
+                const auto res = ZSTD_decompressStream(context.get(), &output, &input);
+                source.begin += input.pos;
+                if (ZSTD_isError(res)) {
+                    failed = true;
+                    return -1;
+                }
+                if (input.pos > 0 || output.pos > 0)
+                    inside = (res != 0);
+                if (output.pos > 0)
+                    return static_cast<int>(output.pos);
+                if (source.available() == 0) {
+                    if (!source.fill())
+                        return -1;
+                    if (source.atEnd())
+                        return inside ? -1 : 0;  // truncated input
+                }
+            }
+        }
+    };
+#endif /* UTAP_WITH_ZSTD */
+}  // namespace
+
+read_function_t UTAP::decompressInput(read_function_t read)
+{
+    // Read ahead the magic bytes
+    auto prefix = std::vector<char>(4);
+    auto size = size_t{0};
+    while (size < prefix.size()) {
+        const auto count = read(prefix.data() + size, static_cast<int>(prefix.size() - size));
+        if (count < 0)
+            return [](char*, int) { return -1; };
+        if (count == 0)
+            break;
+        size += count;
+    }
+    prefix.resize(size);
+    const auto starts_with = [&prefix](std::initializer_list<unsigned char> magic) {
+        return prefix.size() >= magic.size() &&
+               std::equal(magic.begin(), magic.end(), prefix.begin(),
+                          [](unsigned char m, char c) { return m == static_cast<unsigned char>(c); });
+    };
+#ifdef UTAP_WITH_ZLIB
+    if (starts_with({0x1f, 0x8b}))
+        return [decoder = std::make_shared<Gzip>(std::move(read), std::move(prefix))](char* buffer, int len) {
+            return (*decoder)(buffer, len);
+        };
+#endif
+#ifdef UTAP_WITH_ZSTD
+    if (starts_with({0x28, 0xb5, 0x2f, 0xfd}))
+        return [decoder = std::make_shared<Zstd>(std::move(read), std::move(prefix))](char* buffer, int len) {
+            return (*decoder)(buffer, len);
+        };
+#endif
+    (void)starts_with;
+    return [plain = std::make_shared<Plain>(std::move(read), std::move(prefix))](char* buffer, int len) {
+        return (*plain)(buffer, len);
+    };
+}
@@ -0,0 +1,42 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#ifndef UTAP_DECOMPRESS_H
+#define UTAP_DECOMPRESS_H
+
+#include <functional>
+
+namespace UTAP
+{
+    /** Reads up to the given number of bytes into the buffer; returns the count, 0 at the end or -1 on errors. */
+    using read_function_t = std::function<int(char*, int)>;
+
+    /**
+     * Returns a read function delivering the decompressed input of \a read.
+     * Compressed input is recognised by its magic bytes: gzip (when built
+     * with zlib) and zstd (when built with libzstd). Other input is passed
+     * through unchanged. The input is decoded in chunks as it is read.
+     */
+    read_function_t decompressInput(read_function_t read);
+}  // namespace UTAP
+
+#endif /* UTAP_DECOMPRESS_H */
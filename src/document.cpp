@@ -72,6 +72,8 @@ string edge_t::toString() const
     return str;
 }
 
+function_t::function_t(const allocator_type& alloc): variables{alloc} {}
+
 string function_t::toString() const
 {
     string str = "";
@@ -120,6 +122,10 @@ string variable_t::toString() const
     return str;
 }
 
+declarations_t::declarations_t(const allocator_type& alloc):
+    variables{alloc}, functions{alloc}, progress{alloc}, iodecl{alloc}, ganttChart{alloc}
+{}
+
 bool declarations_t::addFunction(type_t type, string name, position_t pos, function_t*& fun)
 {
     bool duplicate = frame.getIndexOf(name) != -1;
@@ -179,7 +185,7 @@ string declarations_t::getTypeDefinitions() const
 
 string declarations_t::getVariables(bool global) const
 {
-    list<variable_t>::const_iterator v_itr = variables.begin();
+    std::pmr::list<variable_t>::const_iterator v_itr = variables.begin();
     string str = "";
     int i = 0;
     // variables
@@ -201,7 +207,7 @@ string declarations_t::getVariables(bool global) const
 
 string declarations_t::getFunctions() const
 {
-    list<function_t>::const_iterator f_itr;
+    std::pmr::list<function_t>::const_iterator f_itr;
     string str = "";
     // functions
     if (!functions.empty()) {
@@ -214,10 +220,15 @@ string declarations_t::getFunctions() const
     return str;
 }
 
+instance_t::instance_t(const instance_t& other, const allocator_type& alloc):
+    uid{other.uid}, parameters{other.parameters}, mapping{other.mapping, alloc}, arguments{other.arguments},
+    unbound{other.unbound}, templ{other.templ}, restricted{other.restricted}
+{}
+
 std::string instance_t::writeMapping() const
 {
     std::string str = "";
-    std::map<symbol_t, expression_t>::const_iterator itr;
+    std::pmr::map<symbol_t, expression_t>::const_iterator itr;
     for (itr = mapping.begin(); itr != mapping.end(); ++itr) {
         str += itr->first.getName() + " = " + itr->second.toString() + "\n";
     }
@@ -253,6 +264,10 @@ std::string instance_t::writeArguments() const
     return str;
 }
 
+template_t::template_t(const allocator_type& alloc):
+    instance_t{alloc}, declarations_t{alloc}, states{alloc}, branchpoints{alloc}, edges{alloc}
+{}
+
 state_t& template_t::addLocation(const string& name, expression_t inv, expression_t er, position_t pos)
 {
     bool duplicate = frame.getIndexOf(name) != -1;
@@ -766,7 +781,11 @@ string chan_priority_t::toString() const
     return stream.str();
 }
 
-Document::Document(): syncUsed(0)
+Document::Document(): Document{std::pmr::get_default_resource()} {}
+
+Document::Document(std::pmr::memory_resource* resource):
+    resource{resource}, procPriority{resource}, syncUsed(0), templates{resource}, dynamicTemplates{resource},
+    instances{resource}, lscInstances{resource}, processes{resource}, global{resource}
 {
     global.frame = frame_t::createFrame();
 #ifdef ENABLE_CORA
@@ -805,9 +824,11 @@ Document::~Document() noexcept
     }
 }
 
-list<template_t>& Document::getTemplates() { return templates; }
+std::pmr::list<template_t>& Document::getTemplates() { return templates; }
+
+std::pmr::list<instance_t>& Document::getProcesses() { return processes; }
 
-list<instance_t>& Document::getProcesses() { return processes; }
+std::pmr::list<instance_t>& Document::getInstances() { return instances; }
 
 declarations_t& Document::getGlobals() { return global; }
 
@@ -980,7 +1001,7 @@ variable_t* Document::addVariableToFunction(function_t* function, frame_t frame,
 }
 
 // Add a regular variable
-variable_t* Document::addVariable(list<variable_t>& variables, frame_t frame, type_t type, const string& name,
+variable_t* Document::addVariable(std::pmr::list<variable_t>& variables, frame_t frame, type_t type, const string& name,
                                   position_t pos)
 {
     bool duplicate = frame.getIndexOf(name) != -1;
@@ -1151,25 +1172,82 @@ void Document::recordStrictLowerBoundOnControllableEdges() { hasStrictLowControl
 
 void Document::addPosition(uint32_t position, uint32_t offset, uint32_t line, const std::string& path)
 {
-    positions.add(position, offset, line, path);
+    // The first line of an element is needed for its path
+    if (lineTracking || line == 1)
+        positions.add(position, offset, line, path);
+}
+
+void Document::addText(uint32_t position, std::string_view text)
+{
+    if (!lineTracking)
+        positions.addText(position, std::string{text});
 }
 
 const Positions::line_t& Document::findPosition(uint32_t position) const { return positions.find(position); }
 
 void Document::addError(position_t position, std::string msg, std::string context)
 {
-    errors.emplace_back(positions.find(position.start), positions.find(position.end), position, std::move(msg),
-                        std::move(context));
+    errorRecords.push_back({position, "%s", {std::move(msg)}, std::move(context)});
 }
 
 void Document::addWarning(position_t position, const std::string& msg, const std::string& context)
 {
-    warnings.emplace_back(positions.find(position.start), positions.find(position.end), position, msg, context);
+    warningRecords.push_back({position, "%s", {msg}, context});
+}
+
+void Document::addError(position_t position, const char* id, std::vector<std::string> args, std::string context)
+{
+    errorRecords.push_back({position, id, std::move(args), std::move(context)});
+}
+
+void Document::addWarning(position_t position, const char* id, std::vector<std::string> args, std::string context)
+{
+    warningRecords.push_back({position, id, std::move(args), std::move(context)});
+}
+
+/** Replaces each "%s" in \a id by the next of \a args. */
+static std::string format(const char* id, const std::vector<std::string>& args)
+{
+    if (args.empty())
+        return id;
+    auto message = std::string{};
+    auto rest = std::string_view{id};
+    for (const auto& arg : args) {
+        const auto hole = rest.find("%s");
+        if (hole == std::string_view::npos)
+            break;
+        message.append(rest.substr(0, hole)).append(arg);
+        rest.remove_prefix(hole + 2);
+    }
+    return message.append(rest);
+}
+
+const std::vector<UTAP::error_t>& Document::render(const std::vector<diagnostic_t>& records,
+                                                   std::vector<UTAP::error_t>& rendered) const
+{
+    auto lock = std::lock_guard{renderMutex};
+    rendered.reserve(records.size());
+    for (auto i = rendered.size(); i < records.size(); ++i) {
+        const auto& record = records[i];
+        rendered.emplace_back(positions.locate(record.position.start), positions.locate(record.position.end),
+                              record.position, format(record.id, record.args), record.context);
+    }
+    return rendered;
 }
 
-void Document::clearErrors() const { errors.clear(); }
+void Document::clearErrors() const
+{
+    auto lock = std::lock_guard{renderMutex};
+    errorRecords.clear();
+    errors.clear();
+}
 
-void Document::clearWarnings() const { warnings.clear(); }
+void Document::clearWarnings() const
+{
+    auto lock = std::lock_guard{renderMutex};
+    warningRecords.clear();
+    warnings.clear();
+}
 
 bool Document::isModified() const { return modified; }
 
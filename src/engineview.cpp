@@ -0,0 +1,133 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/engineview.h"
+
+#include <cassert>
+
+using namespace UTAP;
+using namespace Constants;
+
+EngineView::EngineView(Document& document)
+{
+    auto& templs = document.getTemplates();
+    templates.reserve(templs.size());
+    for (const auto& templ : templs)
+        addTemplate(templ);
+    expressionIds.clear();
+    channelIds.clear();
+}
+
+int32_t EngineView::addExpression(const expression_t& expr)
+{
+    if (expr.empty())
+        return none;
+    auto [it, inserted] = expressionIds.emplace(expr, expressions.size());
+    if (inserted)
+        expressions.push_back(expr);
+    return it->second;
+}
+
+int32_t EngineView::addChannel(const expression_t& expr)
+{
+    const auto channel = expr.getSymbol();
+    if (channel == symbol_t{})
+        return none;
+    auto [it, inserted] = channelIds.emplace(channel, channels.size());
+    if (inserted)
+        channels.push_back(channel);
+    return it->second;
+}
+
+void EngineView::addTemplate(const template_t& templ)
+{
+    auto& view = templates.emplace_back();
+    view.templ = &templ;
+
+    auto& locs = view.locations;
+    const auto nlocs = templ.states.size();
+    locs.invariant.resize(nlocs, none);
+    locs.exponentialRate.resize(nlocs, none);
+    locs.costRate.resize(nlocs, none);
+    locs.flags.resize(nlocs, 0);
+    for (const auto& state : templ.states) {
+        const auto i = state.locNr;
+        locs.invariant[i] = addExpression(state.invariant);
+        locs.exponentialRate[i] = addExpression(state.exponentialRate);
+        locs.costRate[i] = addExpression(state.costRate);
+        const auto& type = state.uid.getType();
+        auto flags = uint8_t{0};
+        if (type.is(URGENT))
+            flags |= URGENT_LOCATION;
+        if (type.is(COMMITTED))
+            flags |= COMMITTED_LOCATION;
+        if (state.uid == templ.init)
+            flags |= INITIAL_LOCATION;
+        locs.flags[i] = flags;
+    }
+
+    // counting sort of the edges by source
+    auto& edges = view.edges;
+    const auto nsources = nlocs + templ.branchpoints.size();
+    const auto source = [&](const edge_t& edge) {
+        return edge.src ? edge.src->locNr : view.branchpoint(edge.srcb->bpNr);
+    };
+    edges.first.assign(nsources + 1, 0);
+    for (const auto& edge : templ.edges)
+        ++edges.first[source(edge) + 1];
+    for (size_t s = 0; s < nsources; ++s)
+        edges.first[s + 1] += edges.first[s];
+    auto order = std::vector<const edge_t*>(templ.edges.size());
+    auto next = std::vector<uint32_t>(edges.first.begin(), edges.first.end() - 1);
+    for (const auto& edge : templ.edges)
+        order[next[source(edge)]++] = &edge;
+
+    const auto nedges = order.size();
+    edges.src.reserve(nedges);
+    edges.dst.reserve(nedges);
+    edges.guard.reserve(nedges);
+    edges.update.reserve(nedges);
+    edges.channel.reserve(nedges);
+    edges.channelExpr.reserve(nedges);
+    edges.prob.reserve(nedges);
+    edges.controllable.reserve(nedges);
+    edges.syncKind.reserve(nedges);
+    edges.edge.reserve(nedges);
+    for (const auto* edge : order) {
+        edges.src.push_back(source(*edge));
+        edges.dst.push_back(edge->dst ? edge->dst->locNr : view.branchpoint(edge->dstb->bpNr));
+        edges.guard.push_back(addExpression(edge->guard));
+        edges.update.push_back(addExpression(edge->assign));
+        if (edge->sync.empty()) {
+            edges.channel.push_back(none);
+            edges.channelExpr.push_back(none);
+            edges.syncKind.push_back(SYNC_CSP);
+        } else {
+            assert(edge->sync.getKind() == SYNC);
+            edges.channel.push_back(addChannel(edge->sync.get(0)));
+            edges.channelExpr.push_back(addExpression(edge->sync.get(0)));
+            edges.syncKind.push_back(edge->sync.getSync());
+        }
+        edges.prob.push_back(addExpression(edge->prob));
+        edges.controllable.push_back(edge->control ? 1 : 0);
+        edges.edge.push_back(edge);
+    }
+}
@@ -0,0 +1,230 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/evaluator.h"
+
+#include <limits>
+#include <cassert>
+
+using namespace UTAP;
+using namespace Constants;
+
+static std::optional<int32_t> narrow(int64_t value)
+{
+    if (value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max())
+        return std::nullopt;
+    return static_cast<int32_t>(value);
+}
+
+std::optional<int32_t> ConstantEvaluator::evaluate(const expression_t& expr)
+{
+    if (expr.empty())
+        return std::nullopt;
+    switch (expr.getKind()) {
+    case CONSTANT:
+        if (!expr.getType().isIntegral())
+            return std::nullopt;
+        return expr.getValue();
+    case IDENTIFIER: return evaluateConstant(expr.getSymbol());
+    case ARRAY: {
+        const auto element = getInitialiser(expr);
+        return element.empty() ? std::nullopt : evaluate(element);
+    }
+    case UNARY_MINUS: {
+        const auto value = evaluate(expr[0]);
+        return value ? narrow(-int64_t{*value}) : std::nullopt;
+    }
+    case NOT: {
+        const auto value = evaluate(expr[0]);
+        return value ? std::optional<int32_t>{*value == 0} : std::nullopt;
+    }
+    case INLINEIF: {
+        const auto cond = evaluate(expr[0]);
+        return cond ? evaluate(expr[*cond ? 1 : 2]) : std::nullopt;
+    }
+    case AND:
+    case OR: {
+        const auto left = evaluate(expr[0]);
+        if (!left)
+            return std::nullopt;
+        if ((*left != 0) == (expr.getKind() == OR))
+            return *left != 0;
+        const auto right = evaluate(expr[1]);
+        return right ? std::optional<int32_t>{*right != 0} : std::nullopt;
+    }
+    case PLUS:
+    case MINUS:
+    case MULT:
+    case DIV:
+    case MOD:
+    case MIN:
+    case MAX:
+    case BIT_AND:
+    case BIT_OR:
+    case BIT_XOR:
+    case BIT_LSHIFT:
+    case BIT_RSHIFT:
+    case LT:
+    case LE:
+    case EQ:
+    case NEQ:
+    case GE:
+    case GT: break;
+    default: return std::nullopt;
+    }
+
+    const auto left = evaluate(expr[0]);
+    const auto right = left ? evaluate(expr[1]) : std::nullopt;
+    if (!right)
+        return std::nullopt;
+    const auto a = int64_t{*left};
+    const auto b = int64_t{*right};
+    switch (expr.getKind()) {
+    case PLUS: return narrow(a + b);
+    case MINUS: return narrow(a - b);
+    case MULT: return narrow(a * b);
+    case DIV: return b == 0 ? std::nullopt : narrow(a / b);
+    case MOD: return b == 0 ? std::nullopt : narrow(a % b);
+    case MIN: return std::min(*left, *right);
+    case MAX: return std::max(*left, *right);
+    case BIT_AND: return *left & *right;
+    case BIT_OR: return *left | *right;
+    case BIT_XOR: return *left ^ *right;
+    case BIT_LSHIFT: return b < 0 || b > 31 ? std::nullopt : narrow(a << b);
+    case BIT_RSHIFT: return b < 0 || b > 31 ? std::nullopt : narrow(a >> b);
+    case LT: return a < b;
+    case LE: return a <= b;
+    case EQ: return a == b;
+    case NEQ: return a != b;
+    case GE: return a >= b;
+    case GT: return a > b;
+    default: return std::nullopt;
+    }
+}
+
+std::optional<int32_t> ConstantEvaluator::evaluateConstant(const symbol_t& symbol)
+{
+    if (auto it = constants.find(symbol); it != constants.end())
+        return it->second;
+    const auto type = symbol.getType();
+    // Only variables have a variable_t as user data; parameters have none
+    if (type.unknown() || !type.isConstant() || !type.isIntegral() || type.is(REF) || symbol.getData() == nullptr)
+        return std::nullopt;
+    if (!pending.insert(symbol).second)
+        return std::nullopt;
+    const auto value = evaluate(static_cast<const variable_t*>(symbol.getData())->expr);
+    pending.erase(symbol);
+    constants.emplace(symbol, value);
+    return value;
+}
+
+/**
+ * Returns the initialiser of the constant array element denoted by \a
+ * expr, or an empty expression if it is not known.
+ */
+expression_t ConstantEvaluator::getInitialiser(const expression_t& expr)
+{
+    if (expr.getKind() == IDENTIFIER) {
+        const auto symbol = expr.getSymbol();
+        const auto type = symbol.getType();
+        if (type.unknown() || !type.isConstant() || !type.isArray() || type.is(REF) || symbol.getData() == nullptr)
+            return {};
+        return static_cast<const variable_t*>(symbol.getData())->expr;
+    }
+    if (expr.getKind() != ARRAY)
+        return {};
+    const auto list = getInitialiser(expr[0]);
+    const auto index = list.empty() ? std::nullopt : evaluate(expr[1]);
+    if (!index || list.getKind() != LIST || *index < 0 || static_cast<size_t>(*index) >= list.getSize())
+        return {};
+    return list[*index];
+}
+
+std::optional<range_t<int32_t>> ConstantEvaluator::evaluateBounds(type_t type)
+{
+    assert(type.is(RANGE));
+    if (auto bounds = type.getBounds())
+        return bounds;
+    while (type.getKind() != RANGE)
+        type = type[0];
+    const auto [lower, upper] = type.getRange();
+    const auto first = evaluate(lower);
+    const auto last = first ? evaluate(upper) : std::nullopt;
+    if (!last)
+        return std::nullopt;
+    type.setBounds({*first, *last});
+    return range_t<int32_t>{*first, *last};
+}
+
+namespace
+{
+    /** Visits every type reachable from the declarations once. */
+    class BoundsWalker
+    {
+        ConstantEvaluator evaluator;
+        std::set<type_t> visited;
+
+    public:
+        void visitType(const type_t& type)
+        {
+            if (type.unknown() || !visited.insert(type).second)
+                return;
+            if (type.getKind() == RANGE)
+                evaluator.evaluateBounds(type);
+            for (size_t i = 0; i < type.size(); ++i)
+                visitType(type[i]);
+        }
+
+        void visitFrame(const frame_t& frame)
+        {
+            for (uint32_t i = 0; i < frame.getSize(); ++i)
+                visitType(frame[i].getType());
+        }
+
+        void visitDeclarations(const declarations_t& declarations)
+        {
+            visitFrame(declarations.frame);
+            for (const auto& function : declarations.functions) {
+                for (const auto& variable : function.variables)
+                    visitType(variable.uid.getType());
+            }
+        }
+
+        void visitTemplate(const template_t& templ)
+        {
+            visitFrame(templ.parameters);
+            visitDeclarations(templ);
+            for (const auto& edge : templ.edges)
+                visitFrame(edge.select);
+        }
+    };
+}  // namespace
+
+void UTAP::evaluateBounds(Document& document)
+{
+    auto walker = BoundsWalker{};
+    walker.visitDeclarations(document.getGlobals());
+    for (const auto& templ : document.getTemplates())
+        walker.visitTemplate(templ);
+    for (const auto* templ : document.getDynamicTemplates())
+        walker.visitTemplate(*templ);
+}
@@ -24,6 +24,8 @@
 #include "utap/document.h"
 
 #include <algorithm>
+#include <functional>  // hash
+#include <new>  // placement new
 #include <stdexcept>
 #include <cassert>
 #include <cstring>
@@ -40,10 +42,21 @@ using std::pair;
 using std::set;
 using std::vector;
 
-struct expression_t::expression_data : public std::enable_shared_from_this<expression_t::expression_data>
+/**
+ * The node behind an expression_t handle. The layout is kept compact
+ * (72 bytes on 64-bit platforms) since expression trees make up most
+ * of a document: the kind and the number of subexpressions share one
+ * word and up to three subexpressions are stored inline, thus unary,
+ * binary and ternary nodes need no separate allocation.
+ */
+struct expression_t::expression_data : public counted_t
 {
+    static constexpr uint32_t inline_size = 3;
+    static constexpr uint32_t max_size = (1u << 20) - 1;
+
     position_t position; /**< The position of the expression */
-    kind_t kind;         /**< The kind of the node */
+    kind_t kind : 12;    /**< The kind of the node */
+    uint32_t size : 20;  /**< The number of subexpressions */
     union
     {
         int32_t value; /**< The value of the node */
@@ -51,16 +64,62 @@ struct expression_t::expression_data : public std::enable_shared_from_this<expre
         synchronisation_t sync; /**< The sync value of the node  */
         double doubleValue;
     };
-    symbol_t symbol;                 /**< The symbol of the node */
-    type_t type;                     /**< The type of the expression */
-    std::vector<expression_t> sub{}; /**< Subexpressions */
-    expression_data(const position_t& p, kind_t kind, int32_t value): position{p}, kind{kind}, value{value} {}
-    ~expression_data() noexcept = default;
+    symbol_t symbol; /**< The symbol of the node */
+    type_t type;     /**< The type of the expression */
+    union
+    {
+        expression_t small[inline_size]; /**< Subexpressions when size <= inline_size */
+        vector<expression_t> large;      /**< Subexpressions when size > inline_size */
+    };
+
+    expression_data(const position_t& p, kind_t kind, int32_t value): position{p}, kind{kind}, size{0}, value{value}
+    {
+        for (auto& e : small)
+            new (&e) expression_t{};
+    }
+    ~expression_data() noexcept
+    {
+        if (size > inline_size) {
+            large.~vector();
+        } else {
+            for (auto& e : small)
+                e.~expression_t();
+        }
+    }
+
+    /** Sets the number of subexpressions of a newly created node. */
+    void resize(size_t n)
+    {
+        assert(size == 0 && n <= max_size);
+        if (n > inline_size) {
+            for (auto& e : small)
+                e.~expression_t();
+            new (&large) vector<expression_t>(n);
+        }
+        size = n;
+    }
+    /** Sets the subexpressions of a newly created node. */
+    void assign(vector<expression_t>&& subs)
+    {
+        assert(size == 0 && subs.size() <= max_size);
+        size = subs.size();
+        if (size > inline_size) {
+            for (auto& e : small)
+                e.~expression_t();
+            new (&large) vector<expression_t>(std::move(subs));
+        } else {
+            std::move(subs.begin(), subs.end(), small);
+        }
+    }
+    expression_t* sub() { return size > inline_size ? large.data() : small; }
+    const expression_t* sub() const { return size > inline_size ? large.data() : small; }
 };
 
+static_assert(DOUBLEINVGUARD < (1 << 12), "expression_data::kind is too narrow");
+
 expression_t::expression_t(kind_t kind, const position_t& pos)
 {
-    data = std::make_shared<expression_data>(pos, kind, 0);
+    data = make_counted<expression_data>(pos, kind, 0);
 }
 
 expression_t expression_t::clone() const
@@ -69,8 +128,8 @@ expression_t expression_t::clone() const
     expr.data->value = data->value;
     expr.data->type = data->type;
     expr.data->symbol = data->symbol;
-    expr.data->sub.reserve(data->sub.size());
-    expr.data->sub.assign(data->sub.begin(), data->sub.end());
+    expr.data->resize(data->size);
+    std::copy(data->sub(), data->sub() + data->size, expr.data->sub());
     return expr;
 }
 
@@ -80,11 +139,9 @@ expression_t expression_t::deeperClone() const
     expr.data->value = data->value;
     expr.data->type = data->type;
     expr.data->symbol = data->symbol;
-    if (!data->sub.empty()) {
-        expr.data->sub.reserve(data->sub.size());
-        for (const auto& s : data->sub)
-            expr.data->sub.push_back(s.deeperClone());
-    }
+    expr.data->resize(data->size);
+    for (uint32_t i = 0; i < data->size; ++i)
+        expr.data->sub()[i] = data->sub()[i].deeperClone();
     return expr;
 }
 
@@ -95,11 +152,9 @@ expression_t expression_t::deeperClone(symbol_t from, symbol_t to) const
     expr.data->type = data->type;
     expr.data->symbol = (data->symbol == from) ? to : data->symbol;
 
-    if (!data->sub.empty()) {
-        expr.data->sub.reserve(data->sub.size());
-        for (const auto& s : data->sub)
-            expr.data->sub.push_back(s.deeperClone(from, to));
-    }
+    expr.data->resize(data->size);
+    for (uint32_t i = 0; i < data->size; ++i)
+        expr.data->sub()[i] = data->sub()[i].deeperClone(from, to);
     return expr;
 }
 
@@ -120,11 +175,9 @@ expression_t expression_t::deeperClone(frame_t frame, frame_t select) const
         expr.data->symbol = data->symbol;
     }
 
-    if (!data->sub.empty()) {
-        expr.data->sub.reserve(data->sub.size());
-        for (const auto& s : data->sub)
-            expr.data->sub.push_back(s.deeperClone(frame, select));
-    }
+    expr.data->resize(data->size);
+    for (uint32_t i = 0; i < data->size; ++i)
+        expr.data->sub()[i] = data->sub()[i].deeperClone(frame, select);
     return expr;
 }
 
@@ -372,7 +425,7 @@ size_t expression_t::getSize() const
     case RANDOM_BETA_F:
     case RANDOM_GAMMA_F:
     case RANDOM_NORMAL_F:
-    case RANDOM_WEIBULL_F: assert(data->sub.size() == 2); return 2;
+    case RANDOM_WEIBULL_F: assert(data->size == 2); return 2;
 
     case UNARY_MINUS:
     case NOT:
@@ -426,16 +479,16 @@ size_t expression_t::getSize() const
     case SIGNBIT_F:
     case ISUNORDERED_F:
     case RANDOM_F:
-    case RANDOM_POISSON_F: assert(data->sub.size() == 1); return 1;
+    case RANDOM_POISSON_F: assert(data->size == 1); return 1;
 
     case IDENTIFIER:
     case CONSTANT:
-    case DEADLOCK: assert(data->sub.size() == 0); return 0;
+    case DEADLOCK: assert(data->size == 0); return 0;
 
     case LOAD_STRAT:
     case INLINEIF:
     case FMA_F:
-    case RANDOM_TRI_F: assert(data->sub.size() == 3); return 3;
+    case RANDOM_TRI_F: assert(data->size == 3); return 3;
 
     case FUNCALL:
     case EFUNCALL:
@@ -453,7 +506,7 @@ size_t expression_t::getSize() const
     case CONTROL_TOPT_DEF2:
     case PMAX:
     case SCENARIO:
-    case SAVE_STRAT: assert(data->sub.size() == 1); return 1;
+    case SAVE_STRAT: assert(data->size == 1); return 1;
 
     case LEADSTO:
     case SCENARIO2:
@@ -461,51 +514,51 @@ size_t expression_t::getSize() const
     case A_WEAKUNTIL:
     case A_BUCHI:
     case PO_CONTROL:
-    case CONTROL_TOPT_DEF1: assert(data->sub.size() == 2); return 2;
+    case CONTROL_TOPT_DEF1: assert(data->size == 2); return 2;
 
     case CONTROL_TOPT:
-    case SMC_CONTROL: assert(data->sub.size() == 3); return 3;
+    case SMC_CONTROL: assert(data->size == 3); return 3;
     case PROBABOX:
     case PROBADIAMOND:
     case PROBAMINBOX:
-    case PROBAMINDIAMOND: assert(data->sub.size() == 5); return 5;
+    case PROBAMINDIAMOND: assert(data->size == 5); return 5;
 
     case MIN_EXP:
     case MAX_EXP: return 7;
 
-    case PROBAEXP: assert(data->sub.size() == 5); return 5;
+    case PROBAEXP: assert(data->size == 5); return 5;
 
-    case PROBACMP: assert(data->sub.size() == 8); return 8;
+    case PROBACMP: assert(data->size == 8); return 8;
     case MITLFORMULA:
     case MITLATOM:
-    case MITLNEXT: assert(data->sub.size() == 1); return 1;
+    case MITLNEXT: assert(data->size == 1); return 1;
     case MITLDISJ:
-    case MITLCONJ: assert(data->sub.size() == 2); return 2;
+    case MITLCONJ: assert(data->size == 2); return 2;
     case MITLUNTIL:
-    case MITLRELEASE: assert(data->sub.size() == 4); return 4;
-    case EXIT: assert(data->sub.size() == 0); return 0;
-    case NUMOF: assert(data->sub.size() == 1); return 1;
+    case MITLRELEASE: assert(data->size == 4); return 4;
+    case EXIT: assert(data->size == 0); return 0;
+    case NUMOF: assert(data->size == 1); return 1;
     case EXISTSDYNAMIC:
     case FORALLDYNAMIC:
     case SUMDYNAMIC:
     case MITLEXISTS:
     case MITLFORALL:
-    case FOREACHDYNAMIC: assert(data->sub.size() == 3); return 3;
-    case DYNAMICEVAL: assert(data->sub.size() == 2); return 2;
+    case FOREACHDYNAMIC: assert(data->size == 3); return 3;
+    case DYNAMICEVAL: assert(data->size == 2); return 2;
     default: assert(0); return 0;
     }
 }
 
-type_t expression_t::getType() const
+const type_t& expression_t::getType() const
 {
     assert(data);
     return data->type;
 }
 
-void expression_t::setType(type_t type)
+void expression_t::setType(type_t type) const
 {
     assert(data);
-    data->type = type;
+    data->type = std::move(type);
 }
 
 int32_t expression_t::getValue() const
@@ -546,25 +599,25 @@ synchronisation_t expression_t::getSync() const
 expression_t& expression_t::operator[](uint32_t i)
 {
     assert(i < getSize());
-    return data->sub[i];
+    return data->sub()[i];
 }
 
-const expression_t expression_t::operator[](uint32_t i) const
+const expression_t& expression_t::operator[](uint32_t i) const
 {
     assert(i < getSize());
-    return data->sub[i];
+    return data->sub()[i];
 }
 
 expression_t& expression_t::get(uint32_t i)
 {
     assert(i < getSize());
-    return data->sub[i];
+    return data->sub()[i];
 }
 
 const expression_t& expression_t::get(uint32_t i) const
 {
     assert(i < getSize());
-    return data->sub[i];
+    return data->sub()[i];
 }
 
 bool expression_t::empty() const { return data == nullptr; }
@@ -589,7 +642,7 @@ bool expression_t::equal(const expression_t& e) const
     }
 
     for (uint32_t i = 0; i < getSize(); i++) {
-        if (!data->sub[i].equal(e[i])) {
+        if (!data->sub()[i].equal(e[i])) {
             return false;
         }
     }
@@ -597,6 +650,58 @@ bool expression_t::equal(const expression_t& e) const
     return true;
 }
 
+bool expression_t::equalStructure(const expression_t& e) const
+{
+    if (data == e.data) {
+        return true;
+    }
+    if (data == nullptr || e.data == nullptr || data->kind != e.data->kind || data->size != e.data->size) {
+        return false;
+    }
+    if (data->kind == CONSTANT) {
+        if (data->type.getKind() != e.data->type.getKind()) {
+            return false;
+        }
+        if (data->type.is(Constants::DOUBLE) ? data->doubleValue != e.data->doubleValue
+                                              : data->value != e.data->value) {
+            return false;
+        }
+    } else if (data->value != e.data->value) {
+        return false;
+    }
+    if ((data->symbol == symbol_t{}) != (e.data->symbol == symbol_t{}) ||
+        (data->symbol != symbol_t{} && data->symbol.getName() != e.data->symbol.getName())) {
+        return false;
+    }
+    for (uint32_t i = 0; i < data->size; i++) {
+        if (!data->sub()[i].equalStructure(e.data->sub()[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t expression_t::hashStructure() const
+{
+    if (data == nullptr) {
+        return 0;
+    }
+    auto combine = [](size_t seed, size_t value) { return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2)); };
+    auto hash = combine(data->kind, data->size);
+    if (data->kind == CONSTANT && data->type.is(Constants::DOUBLE)) {
+        hash = combine(hash, std::hash<double>{}(data->doubleValue));
+    } else {
+        hash = combine(hash, std::hash<int32_t>{}(data->value));
+    }
+    if (data->symbol != symbol_t{}) {
+        hash = combine(hash, std::hash<std::string>{}(data->symbol.getName()));
+    }
+    for (uint32_t i = 0; i < data->size; i++) {
+        hash = combine(hash, data->sub()[i].hashStructure());
+    }
+    return hash;
+}
+
 /**
    Returns the symbol of a variable reference. The expression must be
    a left-hand side value. The symbol returned is the symbol of the
@@ -704,8 +809,8 @@ bool expression_t::contains_deadlock() const
     if (getKind() == UTAP::Constants::DEADLOCK)
         return true;
     if (data)
-        for (auto& subexp : data->sub)
-            if (subexp.contains_deadlock())
+        for (uint32_t i = 0; i < data->size; ++i)
+            if (data->sub()[i].contains_deadlock())
                 return true;
     return false;
 }
@@ -1700,12 +1805,16 @@ void expression_t::toString(bool old, char*& str, char*& end, int& size) const
     }
 }
 
-bool expression_t::operator<(const expression_t e) const
+bool expression_t::operator<(const expression_t& e) const
 {
     return data != nullptr && e.data != nullptr && data < e.data;
 }
 
-bool expression_t::operator==(const expression_t e) const { return data == e.data; }
+bool expression_t::operator==(const expression_t& e) const { return data == e.data; }
+
+const void* expression_t::getIdentity() const { return data.get(); }
+
+bool expression_t::isShared() const { return data && !data.unique(); }
 
 /** Returns a string representation of the expression. The string
     returned must be deallocated with delete[]. Returns NULL is the
@@ -1864,7 +1973,7 @@ expression_t expression_t::createDouble(double value, position_t pos)
     return expr;
 }
 
-expression_t expression_t::createIdentifier(symbol_t symbol, position_t pos)
+expression_t expression_t::createIdentifier(const symbol_t& symbol, const position_t& pos)
 {
     expression_t expr(IDENTIFIER, pos);
     expr.data->symbol = symbol;
@@ -1880,55 +1989,59 @@ expression_t expression_t::createNary(kind_t kind, vector<expression_t> sub, pos
 {
     expression_t expr(kind, pos);
     expr.data->value = sub.size();
-    expr.data->sub = std::move(sub);
+    expr.data->assign(std::move(sub));
     expr.data->type = type;
     return expr;
 }
 
-expression_t expression_t::createUnary(kind_t kind, expression_t sub, position_t pos, type_t type)
+expression_t expression_t::createUnary(kind_t kind, const expression_t& sub, const position_t& pos, const type_t& type)
 {
     expression_t expr(kind, pos);
-    expr.data->sub.push_back(sub);
+    expr.data->resize(1);
+    expr.data->sub()[0] = sub;
     expr.data->type = type;
     return expr;
 }
 
-expression_t expression_t::createBinary(kind_t kind, expression_t left, expression_t right, position_t pos, type_t type)
+expression_t expression_t::createBinary(kind_t kind, const expression_t& left, const expression_t& right,
+                                        const position_t& pos, const type_t& type)
 {
     expression_t expr(kind, pos);
-    expr.data->sub.reserve(2);
-    expr.data->sub.push_back(left);
-    expr.data->sub.push_back(right);
+    expr.data->resize(2);
+    expr.data->sub()[0] = left;
+    expr.data->sub()[1] = right;
     expr.data->type = type;
     return expr;
 }
 
-expression_t expression_t::createTernary(kind_t kind, expression_t e1, expression_t e2, expression_t e3, position_t pos,
-                                         type_t type)
+expression_t expression_t::createTernary(kind_t kind, const expression_t& e1, const expression_t& e2,
+                                         const expression_t& e3, const position_t& pos, const type_t& type)
 {
     expression_t expr(kind, pos);
-    expr.data->sub.reserve(3);
-    expr.data->sub.push_back(e1);
-    expr.data->sub.push_back(e2);
-    expr.data->sub.push_back(e3);
+    expr.data->resize(3);
+    expr.data->sub()[0] = e1;
+    expr.data->sub()[1] = e2;
+    expr.data->sub()[2] = e3;
     expr.data->type = type;
     return expr;
 }
 
-expression_t expression_t::createDot(expression_t e, int32_t idx, position_t pos, type_t type)
+expression_t expression_t::createDot(const expression_t& e, int32_t idx, const position_t& pos, const type_t& type)
 {
     expression_t expr(DOT, pos);
     expr.data->index = idx;
-    expr.data->sub.push_back(e);
+    expr.data->resize(1);
+    expr.data->sub()[0] = e;
     expr.data->type = type;
     return expr;
 }
 
-expression_t expression_t::createSync(expression_t e, synchronisation_t s, position_t pos)
+expression_t expression_t::createSync(const expression_t& e, synchronisation_t s, const position_t& pos)
 {
     expression_t expr(SYNC, pos);
     expr.data->sync = s;
-    expr.data->sub.push_back(std::move(e));
+    expr.data->resize(1);
+    expr.data->sub()[0] = e;
     return expr;
 }
 
@@ -25,6 +25,8 @@
 
 #include "utap/builder.h"
 
+#include <mutex>
+
 // The maximum length is 4000 (see error message) + 1 for the
 // terminating \0.
 constexpr auto MAXLEN = 4001u;
@@ -115,6 +117,16 @@ namespace UTAP
 
     extern PositionTracker tracker;
 
+    /**
+     * Guards the global state of the lexer, the parsers and the
+     * tracker: the XTA parse functions hold it for the whole parse,
+     * while the XML reader only holds it to locate and parse one
+     * element, thus XML parses interleave and never hold it while
+     * waiting for input. It is recursive since the builders may call
+     * the XTA parser.
+     */
+    std::recursive_mutex& parserMutex();
+
     /** Errors from underlying XML reading operations (most likely OS issues) */
     class XMLReaderError : public std::runtime_error
     {
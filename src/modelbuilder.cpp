@@ -0,0 +1,465 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/modelbuilder.h"
+
+#include "libparser.h"
+#include "utap/evaluator.h"
+#include "utap/typechecker.h"
+#include "utap/utap.h"
+
+#include <limits>
+
+using namespace UTAP;
+using namespace Constants;
+
+struct ModelBuilder::Expr::node_t
+{
+    enum op_t {
+        NAT,
+        DOUBLE,
+        BOOLEAN,
+        IDENTIFIER,
+        UNARY,
+        BINARY,
+        ASSIGNMENT,
+        INLINE_IF,
+        ARRAY,
+        DOT,
+        CALL,
+        POST_INC,
+        POST_DEC
+    };
+    op_t op;
+    kind_t kind{};
+    int32_t nat{0};
+    double real{0};
+    std::string name;
+    std::vector<Expr> operands;
+};
+
+ModelBuilder::Expr::Expr(std::shared_ptr<const node_t> node): node{std::move(node)} {}
+
+ModelBuilder::Expr::Expr(int32_t value)
+{
+    if (value < 0 && value != std::numeric_limits<int32_t>::min()) {
+        // Like "-n" in the text: a negated natural number
+        *this = unary(MINUS, Expr{-value});
+    } else {
+        node = std::make_shared<node_t>(node_t{node_t::NAT, {}, value, 0, {}, {}});
+    }
+}
+
+ModelBuilder::Expr::Expr(double value): node{std::make_shared<node_t>(node_t{node_t::DOUBLE, {}, 0, value, {}, {}})} {}
+
+ModelBuilder::Expr ModelBuilder::Expr::id(std::string name)
+{
+    return Expr{std::make_shared<node_t>(node_t{node_t::IDENTIFIER, {}, 0, 0, std::move(name), {}})};
+}
+
+ModelBuilder::Expr ModelBuilder::Expr::boolean(bool value)
+{
+    return Expr{std::make_shared<node_t>(node_t{node_t::BOOLEAN, {}, value, 0, {}, {}})};
+}
+
+ModelBuilder::Expr ModelBuilder::Expr::ifThenElse(Expr condition, Expr then, Expr otherwise)
+{
+    return Expr{std::make_shared<node_t>(
+        node_t{node_t::INLINE_IF, {}, 0, 0, {}, {std::move(condition), std::move(then), std::move(otherwise)}})};
+}
+
+ModelBuilder::Expr ModelBuilder::Expr::unary(kind_t kind, Expr operand)
+{
+    return Expr{std::make_shared<node_t>(node_t{node_t::UNARY, kind, 0, 0, {}, {std::move(operand)}})};
+}
+
+ModelBuilder::Expr ModelBuilder::Expr::binary(kind_t kind, Expr left, Expr right)
+{
+    return Expr{std::make_shared<node_t>(node_t{node_t::BINARY, kind, 0, 0, {}, {std::move(left), std::move(right)}})};
+}
+
+ModelBuilder::Expr ModelBuilder::Expr::assignment(kind_t kind, Expr left, Expr right)
+{
+    return Expr{
+        std::make_shared<node_t>(node_t{node_t::ASSIGNMENT, kind, 0, 0, {}, {std::move(left), std::move(right)}})};
+}
+
+ModelBuilder::Expr ModelBuilder::Expr::operator[](Expr index) const
+{
+    return Expr{std::make_shared<node_t>(node_t{node_t::ARRAY, {}, 0, 0, {}, {*this, std::move(index)}})};
+}
+
+ModelBuilder::Expr ModelBuilder::Expr::field(std::string name) const
+{
+    return Expr{std::make_shared<node_t>(node_t{node_t::DOT, {}, 0, 0, std::move(name), {*this}})};
+}
+
+ModelBuilder::Expr ModelBuilder::Expr::call(std::vector<Expr> arguments) const
+{
+    arguments.insert(arguments.begin(), *this);
+    return Expr{std::make_shared<node_t>(node_t{node_t::CALL, {}, 0, 0, {}, std::move(arguments)})};
+}
+
+ModelBuilder::Expr ModelBuilder::Expr::increment() const
+{
+    return Expr{std::make_shared<node_t>(node_t{node_t::POST_INC, {}, 0, 0, {}, {*this}})};
+}
+
+ModelBuilder::Expr ModelBuilder::Expr::decrement() const
+{
+    return Expr{std::make_shared<node_t>(node_t{node_t::POST_DEC, {}, 0, 0, {}, {*this}})};
+}
+
+ModelBuilder::Type ModelBuilder::Type::Int() { return Type{INT}; }
+
+ModelBuilder::Type ModelBuilder::Type::Int(Expr lower, Expr upper)
+{
+    auto type = Type{BOUNDED_INT};
+    type.bounds = {std::move(lower), std::move(upper)};
+    return type;
+}
+
+ModelBuilder::Type ModelBuilder::Type::Bool() { return Type{BOOL}; }
+ModelBuilder::Type ModelBuilder::Type::Double() { return Type{DOUBLE}; }
+ModelBuilder::Type ModelBuilder::Type::Clock() { return Type{CLOCK}; }
+ModelBuilder::Type ModelBuilder::Type::Chan() { return Type{CHAN}; }
+
+ModelBuilder::Type ModelBuilder::Type::Named(std::string name)
+{
+    auto type = Type{NAMED};
+    type.name = std::move(name);
+    return type;
+}
+
+ModelBuilder::Type ModelBuilder::Type::withPrefix(int flag) const
+{
+    auto type = *this;
+    type.prefix |= flag;
+    return type;
+}
+
+ModelBuilder::Type ModelBuilder::Type::array(Expr size) const
+{
+    auto type = *this;
+    type.sizes.push_back(std::move(size));
+    return type;
+}
+
+ModelBuilder::Edge& ModelBuilder::Edge::select(std::string name, Type type)
+{
+    selects.emplace_back(std::move(name), std::move(type));
+    return *this;
+}
+
+ModelBuilder::Edge& ModelBuilder::Edge::guard(Expr expr)
+{
+    guardExpr = std::move(expr);
+    return *this;
+}
+
+ModelBuilder::Edge& ModelBuilder::Edge::send(Expr channel)
+{
+    syncExpr = std::move(channel);
+    syncKind = SYNC_BANG;
+    return *this;
+}
+
+ModelBuilder::Edge& ModelBuilder::Edge::receive(Expr channel)
+{
+    syncExpr = std::move(channel);
+    syncKind = SYNC_QUE;
+    return *this;
+}
+
+ModelBuilder::Edge& ModelBuilder::Edge::update(Expr expr)
+{
+    updates.push_back(std::move(expr));
+    return *this;
+}
+
+ModelBuilder::Edge& ModelBuilder::Edge::uncontrollable()
+{
+    controllable = false;
+    return *this;
+}
+
+ModelBuilder::Template& ModelBuilder::Template::parameter(Type type, std::string name, bool reference)
+{
+    parameters.push_back({std::move(type), std::move(name), reference});
+    return *this;
+}
+
+ModelBuilder::Template& ModelBuilder::Template::declare(Type type, std::string name, std::optional<Expr> init)
+{
+    declarations.push_back({std::move(type), std::move(name), std::move(init), {}});
+    return *this;
+}
+
+ModelBuilder::Template& ModelBuilder::Template::location(std::string name, std::optional<Expr> invariant)
+{
+    locations.emplace_back(std::move(name), std::move(invariant));
+    return *this;
+}
+
+ModelBuilder::Template& ModelBuilder::Template::urgent(std::string location)
+{
+    urgentLocations.push_back(std::move(location));
+    return *this;
+}
+
+ModelBuilder::Template& ModelBuilder::Template::committed(std::string location)
+{
+    committedLocations.push_back(std::move(location));
+    return *this;
+}
+
+ModelBuilder::Template& ModelBuilder::Template::initial(std::string location)
+{
+    init = std::move(location);
+    return *this;
+}
+
+ModelBuilder::Template& ModelBuilder::Template::edge(Edge edge)
+{
+    edges.push_back(std::move(edge));
+    return *this;
+}
+
+ModelBuilder::ModelBuilder(Document& document, bool builtins): document{document}, builder{document}
+{
+    if (builtins)
+        declareBuiltins();
+}
+
+/** Reports errors thrown by the builder like the parser does. */
+template <typename F>
+void ModelBuilder::call(F&& f)
+{
+    try {
+        f();
+    } catch (TypeException& e) {
+        builder.handleError(e);
+    }
+}
+
+void ModelBuilder::at(const std::string& path)
+{
+    ++position;
+    builder.addPosition(position, 0, 1, path);
+    builder.setPosition(position, position + 1);
+}
+
+void ModelBuilder::emit(const Expr& expr)
+{
+    const auto& node = *expr.node;
+    for (size_t i = 0; i < node.operands.size(); ++i) {
+        emit(node.operands[i]);
+        if (i == 0 && node.op == Expr::node_t::CALL)
+            call([&] { builder.exprCallBegin(); });
+    }
+    call([&] {
+        switch (node.op) {
+        case Expr::node_t::NAT: builder.exprNat(node.nat); break;
+        case Expr::node_t::DOUBLE: builder.exprDouble(node.real); break;
+        case Expr::node_t::BOOLEAN: node.nat ? builder.exprTrue() : builder.exprFalse(); break;
+        case Expr::node_t::IDENTIFIER: builder.exprId(node.name.c_str()); break;
+        case Expr::node_t::UNARY: builder.exprUnary(node.kind); break;
+        case Expr::node_t::BINARY: builder.exprBinary(node.kind); break;
+        case Expr::node_t::ASSIGNMENT: builder.exprAssignment(node.kind); break;
+        case Expr::node_t::INLINE_IF: builder.exprInlineIf(); break;
+        case Expr::node_t::ARRAY: builder.exprArray(); break;
+        case Expr::node_t::DOT: builder.exprDot(node.name.c_str()); break;
+        case Expr::node_t::CALL: builder.exprCallEnd(node.operands.size() - 1); break;
+        case Expr::node_t::POST_INC: builder.exprPostIncrement(); break;
+        case Expr::node_t::POST_DEC: builder.exprPostDecrement(); break;
+        }
+    });
+}
+
+void ModelBuilder::emitBase(const Type& type)
+{
+    const auto prefix = static_cast<ParserBuilder::PREFIX>(type.prefix);
+    for (const auto& bound : type.bounds)
+        emit(bound);
+    call([&] {
+        switch (type.base) {
+        case Type::INT: builder.typeInt(prefix); break;
+        case Type::BOUNDED_INT: builder.typeBoundedInt(prefix); break;
+        case Type::BOOL: builder.typeBool(prefix); break;
+        case Type::DOUBLE: builder.typeDouble(prefix); break;
+        case Type::CLOCK: builder.typeClock(prefix); break;
+        case Type::CHAN: builder.typeChannel(prefix); break;
+        case Type::NAMED: builder.typeName(prefix, type.name.c_str()); break;
+        }
+    });
+}
+
+void ModelBuilder::emitSizes(const Type& type)
+{
+    // The sizes are pushed in order, and the array types are created
+    // from the innermost dimension outwards
+    for (const auto& size : type.sizes)
+        emit(size);
+    for (size_t i = 0; i < type.sizes.size(); ++i)
+        call([&] { builder.typeArrayOfSize(0); });
+}
+
+void ModelBuilder::emitDeclaration(const declaration_t& declaration)
+{
+    emitBase(declaration.type);
+    call([&] { builder.typeDuplicate(); });
+    emitSizes(declaration.type);
+    if (declaration.init) {
+        emit(*declaration.init);
+    } else {
+        for (const auto& init : declaration.initialisers) {
+            emit(init);
+            call([&] { builder.declFieldInit(""); });
+        }
+        if (!declaration.initialisers.empty())
+            call([&] { builder.declInitialiserList(declaration.initialisers.size()); });
+    }
+    const auto init = declaration.init || !declaration.initialisers.empty();
+    call([&] { builder.declVar(declaration.name.c_str(), init); });
+    call([&] { builder.typePop(); });
+}
+
+void ModelBuilder::emitParameter(const parameter_t& parameter)
+{
+    emitBase(parameter.type);
+    emitSizes(parameter.type);
+    call([&] { builder.declParameter(parameter.name.c_str(), parameter.reference); });
+}
+
+void ModelBuilder::declare(Type type, const std::string& name, std::optional<Expr> init)
+{
+    declare({std::move(type), name, std::move(init), {}});
+}
+
+void ModelBuilder::declare(const declaration_t& declaration)
+{
+    at("/declaration/" + declaration.name);
+    emitDeclaration(declaration);
+}
+
+void ModelBuilder::declareType(Type type, const std::string& name)
+{
+    at("/declaration/" + name);
+    emitBase(type);
+    call([&] { builder.typeDuplicate(); });
+    emitSizes(type);
+    call([&] { builder.declTypeDef(name.c_str()); });
+    call([&] { builder.typePop(); });
+}
+
+void ModelBuilder::add(const Template& templ)
+{
+    const auto path = "/template/" + templ.name;
+    at(path);
+    for (const auto& parameter : templ.parameters)
+        emitParameter(parameter);
+    call([&] { builder.procBegin(templ.name.c_str()); });
+    for (const auto& declaration : templ.declarations) {
+        at(path + "/declaration/" + declaration.name);
+        emitDeclaration(declaration);
+    }
+    for (const auto& [name, invariant] : templ.locations) {
+        at(path + "/location/" + name);
+        if (invariant)
+            emit(*invariant);
+        call([&] { builder.procState(name.c_str(), invariant.has_value(), false); });
+    }
+    at(path);
+    for (const auto& name : templ.committedLocations)
+        call([&] { builder.procStateCommit(name.c_str()); });
+    for (const auto& name : templ.urgentLocations)
+        call([&] { builder.procStateUrgent(name.c_str()); });
+    if (!templ.init.empty())
+        call([&] { builder.procStateInit(templ.init.c_str()); });
+    for (const auto& edge : templ.edges) {
+        at(path + "/edge/" + edge.source + "->" + edge.target);
+        call([&] { builder.procEdgeBegin(edge.source.c_str(), edge.target.c_str(), edge.controllable, ""); });
+        for (const auto& [name, type] : edge.selects) {
+            emitBase(type);
+            call([&] { builder.procSelect(name.c_str()); });
+        }
+        if (edge.guardExpr) {
+            emit(*edge.guardExpr);
+            call([&] { builder.procGuard(); });
+        }
+        if (edge.syncExpr) {
+            emit(*edge.syncExpr);
+            call([&] { builder.procSync(edge.syncKind); });
+        }
+        if (!edge.updates.empty()) {
+            emit(edge.updates.front());
+            for (size_t i = 1; i < edge.updates.size(); ++i) {
+                emit(edge.updates[i]);
+                call([&] { builder.exprComma(); });
+            }
+            call([&] { builder.procUpdate(); });
+        }
+        call([&] { builder.procEdgeEnd(edge.source.c_str(), edge.target.c_str()); });
+    }
+    call([&] { builder.procEnd(); });
+}
+
+void ModelBuilder::instantiate(const std::string& name, const std::string& templ, const std::vector<Expr>& arguments,
+                               const std::vector<parameter_t>& parameters)
+{
+    at("/system/" + name);
+    for (const auto& parameter : parameters)
+        emitParameter(parameter);
+    call([&] { builder.instantiationBegin(name.c_str(), parameters.size(), templ.c_str()); });
+    for (const auto& argument : arguments)
+        emit(argument);
+    call([&] { builder.instantiationEnd(name.c_str(), parameters.size(), templ.c_str(), arguments.size()); });
+}
+
+void ModelBuilder::system(const std::vector<std::string>& processes)
+{
+    at("/system");
+    for (const auto& process : processes)
+        call([&] { builder.process(process.c_str()); });
+    call([&] { builder.processListEnd(); });
+    call([&] { builder.done(); });
+}
+
+bool ModelBuilder::check()
+{
+    if (!document.hasErrors()) {
+        auto checker = TypeChecker{document};
+        document.accept(checker);
+        if (!document.hasErrors())
+            evaluateBounds(document);
+    }
+    return !document.hasErrors();
+}
+
+/** Declares the constants and types of utap_builtin_declarations() like the parsers do. */
+void ModelBuilder::declareBuiltins()
+{
+    auto lock = std::lock_guard{parserMutex()};
+    parseXTA(utap_builtin_declarations(), &builder, true, S_DECLARATION, "");
+    // Positions must keep increasing after those of the declarations
+    position = tracker.position;
+}
@@ -0,0 +1,401 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/modeldiff.h"
+
+#include "utap/statement.h"
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    template <typename T>
+    using named_t = vector<std::pair<string, const T*>>;
+
+    bool same(const expression_t& a, const expression_t& b)
+    {
+        return a.hashStructure() == b.hashStructure() && a.equalStructure(b);
+    }
+
+    bool same(const type_t& a, const type_t& b) { return a.toString() == b.toString(); }
+
+    bool same(const frame_t& a, const frame_t& b)
+    {
+        if (a.getSize() != b.getSize())
+            return false;
+        for (uint32_t i = 0; i < a.getSize(); ++i)
+            if (a[i].getName() != b[i].getName() || !same(a[i].getType(), b[i].getType()))
+                return false;
+        return true;
+    }
+
+    bool same(const variable_t& a, const variable_t& b)
+    {
+        return same(a.uid.getType(), b.uid.getType()) && same(a.expr, b.expr);
+    }
+
+    bool same(const function_t& a, const function_t& b)
+    {
+        return same(a.uid.getType(), b.uid.getType()) &&
+               (a.body ? a.body->toString("") : string{}) == (b.body ? b.body->toString("") : string{});
+    }
+
+    bool same(const state_t& a, const state_t& b)
+    {
+        return same(a.uid.getType(), b.uid.getType()) && same(a.invariant, b.invariant) &&
+               same(a.exponentialRate, b.exponentialRate) && same(a.costRate, b.costRate);
+    }
+
+    bool same(const edge_t& a, const edge_t& b)
+    {
+        return a.control == b.control && a.actname == b.actname && same(a.select, b.select) &&
+               same(a.guard, b.guard) && same(a.assign, b.assign) && same(a.sync, b.sync) && same(a.prob, b.prob);
+    }
+
+    /** The arguments of a process ordered by parameter name. */
+    vector<std::pair<string, expression_t>> arguments(const instance_t& process)
+    {
+        auto args = vector<std::pair<string, expression_t>>{};
+        for (const auto& [param, arg] : process.mapping)
+            args.emplace_back(param.getName(), arg);
+        std::sort(args.begin(), args.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        return args;
+    }
+
+    bool same(const instance_t& a, const instance_t& b)
+    {
+        if (a.templ->uid.getName() != b.templ->uid.getName())
+            return false;
+        const auto args_a = arguments(a);
+        const auto args_b = arguments(b);
+        return std::equal(args_a.begin(), args_a.end(), args_b.begin(), args_b.end(),
+                          [](const auto& x, const auto& y) { return x.first == y.first && same(x.second, y.second); });
+    }
+
+    string location_name(const edge_t& edge, bool source)
+    {
+        if (source)
+            return edge.src ? edge.src->uid.getName() : edge.srcb->uid.getName();
+        return edge.dst ? edge.dst->uid.getName() : edge.dstb->uid.getName();
+    }
+
+    template <typename Range>
+    auto by_name(const string& prefix, const Range& range)
+    {
+        auto named = named_t<typename Range::value_type>{};
+        named.reserve(range.size());
+        for (const auto& item : range)
+            named.emplace_back(prefix + item.uid.getName(), &item);
+        return named;
+    }
+
+    named_t<symbol_t> typedefs(const string& prefix, const frame_t& frame)
+    {
+        auto named = named_t<symbol_t>{};
+        for (uint32_t i = 0; i < frame.getSize(); ++i)
+            if (frame[i].getType().getKind() == TYPEDEF)
+                named.emplace_back(prefix + frame[i].getName(), &frame[i]);
+        return named;
+    }
+
+    /** Edges are named by their end points, numbered if there are several. */
+    named_t<edge_t> edges(const string& prefix, const template_t& templ)
+    {
+        auto named = named_t<edge_t>{};
+        auto count = std::unordered_map<string, int>{};
+        for (const auto& edge : templ.edges) {
+            auto name = prefix + location_name(edge, true) + "->" + location_name(edge, false);
+            if (auto k = count[name]++; k > 0)
+                name += "#" + std::to_string(k);
+            named.emplace_back(std::move(name), &edge);
+        }
+        return named;
+    }
+
+    class Differ
+    {
+        model_diff_t& diff;
+
+    public:
+        explicit Differ(model_diff_t& diff): diff{diff} {}
+
+        void report(model_diff_t::change_t change, model_diff_t::entity_t entity, const string& name)
+        {
+            diff.entries.push_back({change, entity, name});
+        }
+
+        /** Matches the entities by name, reports the differences and
+            returns true if any was found. */
+        template <typename T, typename Same>
+        bool compare(model_diff_t::entity_t entity, const named_t<T>& before, const named_t<T>& after, Same same)
+        {
+            const auto size = diff.entries.size();
+            auto index = std::unordered_map<string, const T*>{};
+            index.reserve(before.size());
+            for (const auto& [name, item] : before)
+                index.emplace(name, item);
+            for (const auto& [name, item] : after) {
+                if (auto it = index.find(name); it == index.end()) {
+                    report(model_diff_t::ADDED, entity, name);
+                } else {
+                    if (!same(*it->second, *item))
+                        report(model_diff_t::CHANGED, entity, name);
+                    index.erase(it);
+                }
+            }
+            for (const auto& [name, item] : before)
+                if (index.count(name))
+                    report(model_diff_t::REMOVED, entity, name);
+            return diff.entries.size() != size;
+        }
+
+        template <typename T>
+        bool compare(model_diff_t::entity_t entity, const named_t<T>& before, const named_t<T>& after)
+        {
+            return compare(entity, before, after, [](const T& a, const T& b) { return same(a, b); });
+        }
+
+        /** Compares the variables, functions and typedefs of two scopes. */
+        bool compare(const string& prefix, const declarations_t& before, const declarations_t& after)
+        {
+            auto changed = compare(model_diff_t::TYPEDEF, typedefs(prefix, before.frame), typedefs(prefix, after.frame),
+                                   [](const symbol_t& a, const symbol_t& b) { return same(a.getType(), b.getType()); });
+            changed |= compare(model_diff_t::VARIABLE, by_name(prefix, before.variables),
+                               by_name(prefix, after.variables));
+            changed |= compare(model_diff_t::FUNCTION, by_name(prefix, before.functions),
+                               by_name(prefix, after.functions));
+            return changed;
+        }
+
+        /** Returns true if the templates differ. */
+        bool compare(const template_t& before, const template_t& after)
+        {
+            const auto prefix = after.uid.getName() + ".";
+            auto changed = !same(before.parameters, after.parameters);
+            if (changed)
+                report(model_diff_t::CHANGED, model_diff_t::TEMPLATE, after.uid.getName());
+            changed |= compare(prefix, before, after);
+            changed |= compare(model_diff_t::LOCATION, by_name(prefix, before.states), by_name(prefix, after.states));
+            changed |= compare(model_diff_t::EDGE, edges(prefix, before), edges(prefix, after));
+            if (before.init.getName() != after.init.getName() && !changed) {
+                report(model_diff_t::CHANGED, model_diff_t::TEMPLATE, after.uid.getName());
+                changed = true;
+            }
+            return changed;
+        }
+    };
+
+    /** The variables a process may read and write, named as in model_diff_t. */
+    struct access_t
+    {
+        std::set<string> reads;
+        std::set<string> writes;
+    };
+
+    class AccessCollector
+    {
+        std::set<symbol_t> globals;
+        std::map<const template_t*, std::pair<std::set<symbol_t>, std::set<symbol_t>>> templates;
+
+        const std::pair<std::set<symbol_t>, std::set<symbol_t>>& accesses(const template_t& templ)
+        {
+            auto [it, inserted] = templates.try_emplace(&templ);
+            if (inserted) {
+                auto& [reads, writes] = it->second;
+                auto visit = [&](const expression_t& expr) {
+                    expr.collectPossibleReads(reads);
+                    expr.collectPossibleWrites(writes);
+                };
+                for (const auto& state : templ.states) {
+                    visit(state.invariant);
+                    visit(state.exponentialRate);
+                    visit(state.costRate);
+                }
+                for (const auto& edge : templ.edges) {
+                    visit(edge.guard);
+                    visit(edge.assign);
+                    visit(edge.sync);
+                    visit(edge.prob);
+                }
+            }
+            return it->second;
+        }
+
+        void name(const instance_t& process, const symbol_t& symbol, std::set<string>& names) const
+        {
+            if (globals.count(symbol)) {
+                names.insert(symbol.getName());
+            } else if (auto arg = process.mapping.find(symbol); arg != process.mapping.end()) {
+                auto symbols = std::set<symbol_t>{};
+                arg->second.getSymbols(symbols);
+                for (const auto& s : symbols)
+                    if (globals.count(s))
+                        names.insert(s.getName());
+            } else if (auto i = process.templ->frame.getIndexOf(symbol.getName());
+                       i != -1 && process.templ->frame[i] == symbol) {
+                names.insert(process.uid.getName() + "." + symbol.getName());
+            }
+        }
+
+    public:
+        explicit AccessCollector(Document& document)
+        {
+            const auto& frame = document.getGlobals().frame;
+            for (uint32_t i = 0; i < frame.getSize(); ++i)
+                globals.insert(frame[i]);
+        }
+
+        access_t collect(const instance_t& process)
+        {
+            auto access = access_t{};
+            const auto& [reads, writes] = accesses(*process.templ);
+            for (const auto& symbol : reads)
+                name(process, symbol, access.reads);
+            for (const auto& symbol : writes)
+                name(process, symbol, access.writes);
+            return access;
+        }
+    };
+}  // namespace
+
+model_diff_t UTAP::diffDocuments(Document& before, Document& after)
+{
+    auto diff = model_diff_t{};
+    auto differ = Differ{diff};
+
+    // declarations and templates
+    differ.compare("", before.getGlobals(), after.getGlobals());
+    const auto seeds = diff.entries.size();
+    auto changedTemplates = std::set<string>{};
+    {
+        auto index = std::unordered_map<string, const template_t*>{};
+        for (const auto& templ : before.getTemplates())
+            index.emplace(templ.uid.getName(), &templ);
+        for (const auto& templ : after.getTemplates()) {
+            const auto& name = templ.uid.getName();
+            if (auto it = index.find(name); it == index.end()) {
+                differ.report(model_diff_t::ADDED, model_diff_t::TEMPLATE, name);
+                changedTemplates.insert(name);
+            } else {
+                if (differ.compare(*it->second, templ))
+                    changedTemplates.insert(name);
+                index.erase(it);
+            }
+        }
+        for (const auto& templ : before.getTemplates())
+            if (index.count(templ.uid.getName()))
+                differ.report(model_diff_t::REMOVED, model_diff_t::TEMPLATE, templ.uid.getName());
+    }
+
+    // processes
+    const auto first_process = diff.entries.size();
+    differ.compare(model_diff_t::PROCESS, by_name("", before.getProcesses()), by_name("", after.getProcesses()));
+
+    // the changed global variables and functions seed the affected variables
+    auto& variables = diff.affectedVariables;
+    for (size_t i = 0; i < seeds; ++i)
+        if (diff.entries[i].entity != model_diff_t::TYPEDEF)
+            variables.insert(diff.entries[i].name);
+
+    auto collectBefore = AccessCollector{before};
+    auto written = std::unordered_map<string, std::set<string>>{};  // by processes of the old model
+    for (const auto& process : before.getProcesses())
+        written.emplace(process.uid.getName(), collectBefore.collect(process).writes);
+
+    // propagate along the read/write sets of the processes of the new model
+    auto collectAfter = AccessCollector{after};
+    auto processes = vector<std::pair<const instance_t*, access_t>>{};
+    auto readers = std::unordered_map<string, vector<size_t>>{};
+    auto index = std::unordered_map<string, size_t>{};
+    auto worklist = vector<size_t>{};
+    auto affected = vector<bool>{};
+    for (const auto& process : after.getProcesses()) {
+        const auto i = processes.size();
+        processes.emplace_back(&process, collectAfter.collect(process));
+        index.emplace(process.uid.getName(), i);
+        for (const auto& var : processes.back().second.reads)
+            readers[var].push_back(i);
+        affected.push_back(changedTemplates.count(process.templ->uid.getName()) > 0);
+    }
+    for (size_t i = first_process; i < diff.entries.size(); ++i) {
+        const auto& entry = diff.entries[i];
+        if (entry.change == model_diff_t::REMOVED) {
+            diff.affectedProcesses.insert(entry.name);
+            variables.insert(written[entry.name].begin(), written[entry.name].end());
+        } else {
+            affected[index.at(entry.name)] = true;
+        }
+    }
+    for (const auto& var : variables)
+        if (auto it = readers.find(var); it != readers.end())
+            for (auto p : it->second)
+                affected[p] = true;
+    for (size_t p = 0; p < processes.size(); ++p)
+        if (affected[p])
+            worklist.push_back(p);
+    while (!worklist.empty()) {
+        const auto p = worklist.back();
+        worklist.pop_back();
+        const auto& name = processes[p].first->uid.getName();
+        diff.affectedProcesses.insert(name);
+        auto writes = processes[p].second.writes;
+        if (auto it = written.find(name); it != written.end())
+            writes.insert(it->second.begin(), it->second.end());
+        for (const auto& var : writes) {
+            if (!variables.insert(var).second)
+                continue;
+            if (auto it = readers.find(var); it != readers.end()) {
+                for (auto q : it->second) {
+                    if (!affected[q]) {
+                        affected[q] = true;
+                        worklist.push_back(q);
+                    }
+                }
+            }
+        }
+    }
+    return diff;
+}
+
+std::ostream& UTAP::operator<<(std::ostream& os, const model_diff_t& diff)
+{
+    static const char* changes[] = {"added", "removed", "changed"};
+    static const char* entities[] = {"typedef", "variable", "function", "template", "location", "edge", "process"};
+    for (const auto& entry : diff.entries)
+        os << changes[entry.change] << ' ' << entities[entry.entity] << ' ' << entry.name << '\n';
+    os << "affected processes:";
+    for (const auto& name : diff.affectedProcesses)
+        os << ' ' << name;
+    os << "\naffected variables:";
+    for (const auto& name : diff.affectedVariables)
+        os << ' ' << name;
+    return os << '\n';
+}
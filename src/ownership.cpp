@@ -0,0 +1,356 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/ownership.h"
+
+#include "analysis.h"
+#include "utap/evaluator.h"
+#include "utap/statement.h"
+#include "utap/systemview.h"
+
+#include <algorithm>
+#include <optional>
+#include <ostream>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    /** The elements of a variable accessed by one process. */
+    struct access_t
+    {
+        bool whole{false};
+        std::set<int32_t> elements;
+    };
+
+    using accesses_t = std::map<symbol_t, access_t>;
+
+    class Analysis
+    {
+        ConstantEvaluator evaluator;
+        std::map<symbol_t, size_t> indices;  // of the global variables in the result
+        std::map<symbol_t, const function_t*> functions;
+        std::set<symbol_t> globalFunctions;
+        vector<std::pair<string, accesses_t>> processes;
+
+        // the process being analysed
+        const SystemView::process_t* process{nullptr};
+        accesses_t* accesses{nullptr};
+        std::set<symbol_t> called;
+        bool indirect{false};
+
+        class Body : public ExpressionVisitor
+        {
+            Analysis& analysis;
+
+        protected:
+            void visitExpression(expression_t expr) override { analysis.visit(analysis.bind(std::move(expr))); }
+
+        public:
+            explicit Body(Analysis& analysis): analysis{analysis} {}
+        };
+
+        expression_t bind(expression_t expr) const
+        {
+            return process ? SystemView::bind(*process, std::move(expr)) : expr;
+        }
+
+        void record(const symbol_t& symbol, std::optional<int32_t> element)
+        {
+            auto& access = (*accesses)[symbol];
+            if (element) {
+                access.elements.insert(*element);
+            } else {
+                access.whole = true;
+            }
+            if (indirect)
+                result.variables[indices.at(symbol)].direct = false;
+        }
+
+        void call(const symbol_t& symbol)
+        {
+            if (!called.insert(symbol).second)
+                return;
+            const auto* fun = functions.at(symbol);
+            const auto saved = indirect;
+            indirect = indirect || globalFunctions.count(symbol) > 0;
+            auto body = Body{*this};
+            if (fun->body)
+                fun->body->accept(&body);
+            indirect = saved;
+        }
+
+        void visit(const expression_t& expr)
+        {
+            if (expr.empty())
+                return;
+            switch (expr.getKind()) {
+            case IDENTIFIER:
+                if (const auto symbol = expr.getSymbol(); indices.count(symbol)) {
+                    record(symbol, std::nullopt);
+                } else if (functions.count(symbol)) {
+                    call(symbol);
+                }
+                return;
+            case ARRAY:
+                if (expr[0].getKind() == IDENTIFIER && indices.count(expr[0].getSymbol())) {
+                    record(expr[0].getSymbol(), evaluator.evaluate(expr[1]));
+                    visit(expr[1]);
+                    return;
+                }
+                break;
+            default: break;
+            }
+            for (uint32_t i = 0; i < expr.getSize(); ++i)
+                visit(expr[i]);
+        }
+
+        void visitTemplate(const template_t& templ)
+        {
+            for (const auto& state : templ.states)
+                for (const auto& expr : {state.invariant, state.exponentialRate, state.costRate})
+                    visit(bind(expr));
+            for (const auto& edge : templ.edges)
+                for (const auto& expr : {edge.guard, edge.assign, edge.sync, edge.prob})
+                    visit(bind(expr));
+            for (const auto& progress : templ.progress) {
+                visit(bind(progress.guard));
+                visit(bind(progress.measure));
+            }
+        }
+
+        void begin(const string& name, const SystemView::process_t* current)
+        {
+            accesses = &processes.emplace_back(name, accesses_t{}).second;
+            process = current;
+            called.clear();
+        }
+
+        void summarise()
+        {
+            for (auto& variable : result.variables) {
+                auto owners = std::map<int32_t, string>{};
+                auto partitioned = true;
+                for (const auto& [name, accesses] : processes) {
+                    const auto it = accesses.find(variable.symbol);
+                    if (it == accesses.end())
+                        continue;
+                    variable.users.insert(name);
+                    const auto& access = it->second;
+                    partitioned = partitioned && !access.whole;
+                    for (const auto element : access.elements)
+                        partitioned = partitioned && owners.emplace(element, name).second;
+                }
+                if (variable.users.size() > 1 && partitioned && variable.direct)
+                    variable.owners = std::move(owners);
+            }
+        }
+
+    public:
+        ownership_t result;
+
+        Analysis(Document& document, const vector<string>& queries)
+        {
+            auto& globals = document.getGlobals();
+            const auto queried = queriedIdentifiers(document, queries);
+            for (const auto& variable : globals.variables) {
+                const auto& type = variable.uid.getType();
+                if (type.isConstant() || type.isChannel())
+                    continue;
+                indices.emplace(variable.uid, result.variables.size());
+                auto& entry = result.variables.emplace_back();
+                entry.symbol = variable.uid;
+                entry.observed = queried.count(variable.uid.getName()) > 0;
+            }
+            for (const auto& fun : globals.functions) {
+                functions.emplace(fun.uid, &fun);
+                globalFunctions.insert(fun.uid);
+            }
+            for (const auto& templ : document.getTemplates())
+                for (const auto& fun : templ.functions)
+                    functions.emplace(fun.uid, &fun);
+
+            const auto view = SystemView{document};
+            for (const auto& current : view.getProcesses()) {
+                begin(current.name, &current);
+                visitTemplate(*current.templ);
+                indirect = true;
+                for (const auto& binding : current.parameters)
+                    if (binding.kind == SystemView::REFERENCE)
+                        visit(binding.argument);
+                indirect = false;
+            }
+
+            // code outside of the processes makes the variables it accesses shared
+            indirect = true;
+            for (const auto* templ : document.getDynamicTemplates()) {
+                begin(templ->uid.getName(), nullptr);
+                visitTemplate(*templ);
+            }
+            begin("", nullptr);
+            for (const auto& progress : globals.progress) {
+                visit(progress.guard);
+                visit(progress.measure);
+            }
+            visit(document.getBeforeUpdate());
+            visit(document.getAfterUpdate());
+            processes.pop_back();
+            indirect = false;
+
+            summarise();
+        }
+    };
+
+    /** Replaces the elements of \a array with \a replacement. */
+    expression_t replace(const expression_t& expr, const symbol_t& array, const expression_t& replacement)
+    {
+        if (expr.empty())
+            return expr;
+        if (expr.getKind() == ARRAY && expr[0].getKind() == IDENTIFIER && expr[0].getSymbol() == array)
+            return replacement;
+        auto result = expr;
+        for (uint32_t i = 0; i < expr.getSize(); ++i) {
+            auto sub = replace(expr[i], array, replacement);
+            if (!sub.equal(expr[i])) {
+                if (result.equal(expr))
+                    result = expr.clone();
+                result[i] = std::move(sub);
+            }
+        }
+        return result;
+    }
+
+    /** The initialiser of every element of an array, or nothing if the elements differ. */
+    std::optional<expression_t> uniformElement(const expression_t& init)
+    {
+        if (init.empty())
+            return init;
+        if (init.getKind() != LIST || init.getSize() == 0)
+            return std::nullopt;
+        for (uint32_t i = 1; i < init.getSize(); ++i)
+            if (!init[i].equalStructure(init[0]))
+                return std::nullopt;
+        return init[0];
+    }
+}  // namespace
+
+const ownership_t::variable_t* ownership_t::find(const string& name) const
+{
+    const auto it = std::find_if(variables.begin(), variables.end(),
+                                 [&](const variable_t& variable) { return variable.symbol.getName() == name; });
+    return it != variables.end() ? &*it : nullptr;
+}
+
+ownership_t UTAP::analyseOwnership(Document& document, const vector<string>& queries)
+{
+    return std::move(Analysis{document, queries}.result);
+}
+
+vector<string> UTAP::promoteOwnedVariables(Document& document, const ownership_t& ownership)
+{
+    const auto view = SystemView{document};
+    auto processes = std::map<string, template_t*>{};
+    auto instances = std::map<const template_t*, std::set<string>>{};
+    for (const auto& process : view.getProcesses()) {
+        auto& templates = document.getTemplates();
+        const auto it = std::find_if(templates.begin(), templates.end(),
+                                     [&](const template_t& templ) { return &templ == process.templ; });
+        processes.emplace(process.name, &*it);
+        instances[process.templ].insert(process.name);
+    }
+
+    auto& globals = document.getGlobals();
+    auto promoted = vector<string>{};
+    for (const auto& variable : ownership.variables) {
+        if (!variable.direct || variable.observed || !(variable.isLocal() || variable.isPartitioned()))
+            continue;
+        const auto symbol = variable.symbol;
+        const auto& name = symbol.getName();
+        const auto it = std::find_if(globals.variables.begin(), globals.variables.end(),
+                                     [&](const variable_t& global) { return global.uid == symbol; });
+        auto* templ = processes.at(*variable.users.begin());
+        if (it == globals.variables.end() || templ->frame.getIndexOf(name) != -1)
+            continue;
+
+        if (variable.isLocal()) {
+            if (instances[templ].size() != 1)
+                continue;
+            globals.frame.remove(symbol);
+            templ->frame.add(symbol);
+            templ->variables.splice(templ->variables.end(), globals.variables, it);
+        } else {
+            // every process of the template owns one element, and its functions do not access the array
+            if (variable.users != instances[templ] || variable.owners.size() != variable.users.size())
+                continue;
+            if (std::any_of(templ->functions.begin(), templ->functions.end(), [&](const function_t& fun) {
+                    return fun.depends.count(symbol) > 0 || fun.changes.count(symbol) > 0;
+                }))
+                continue;
+            const auto init = uniformElement(it->expr);
+            if (!init)
+                continue;
+            auto* local = document.addVariable(templ, symbol.getType().getSub(), name, *init, symbol.getPosition());
+            const auto element = expression_t::createIdentifier(local->uid, symbol.getPosition());
+            for (auto& state : templ->states)
+                for (auto* expr : {&state.invariant, &state.exponentialRate, &state.costRate})
+                    *expr = replace(*expr, symbol, element);
+            for (auto& edge : templ->edges)
+                for (auto* expr : {&edge.guard, &edge.assign, &edge.sync, &edge.prob})
+                    *expr = replace(*expr, symbol, element);
+            globals.frame.remove(symbol);
+            globals.variables.erase(it);
+        }
+        promoted.push_back(name);
+    }
+
+    if (!promoted.empty())
+        updateProcessTypes(document);
+    return promoted;
+}
+
+std::ostream& UTAP::operator<<(std::ostream& os, const ownership_t& ownership)
+{
+    for (const auto& variable : ownership.variables) {
+        os << variable.symbol.getName() << ": ";
+        if (variable.users.empty()) {
+            os << "unused";
+        } else if (variable.isLocal()) {
+            os << "local to " << *variable.users.begin();
+        } else if (variable.isPartitioned()) {
+            os << "partitioned";
+            for (const auto& [element, owner] : variable.owners)
+                os << ' ' << element << ':' << owner;
+        } else {
+            os << "shared by " << variable.users.size() << " processes";
+        }
+        if (!variable.direct)
+            os << " (indirect)";
+        if (variable.observed)
+            os << " (observed)";
+        os << '\n';
+    }
+    return os;
+}
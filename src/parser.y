@@ -45,6 +45,9 @@
 #include "utap/position.h"
 
 #include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_set>
 #include <cstring> // strlen
 
 using namespace UTAP;
@@ -87,7 +90,17 @@ static int utap_lex()
    return lexer_flex();
 }
 
-static char rootTransId[MAXLEN];
+static const char* rootTransId = nullptr;
+
+/* Identifiers and string literals are interned, thus the semantic
+   value holds a pointer rather than a copy of the text. The strings
+   are kept until the end of the current parse. */
+static std::unordered_set<std::string> strings;
+
+static const char* intern(std::string_view text)
+{
+    return strings.emplace(text).first->c_str();
+}
 
 /* Counter used during array parsing. */
 static int types = 0;
@@ -325,7 +338,7 @@ const char* utap_msg(const char *msg)
     int number;
     ParserBuilder::PREFIX prefix;
     kind_t kind;
-    char string[MAXLEN];
+    const char* string;
     double floating;
 }
 
@@ -742,21 +755,21 @@ Type:
         ;
 
 Id:
-        NonTypeId { strncpy($$, $1, MAXLEN); }
-        | T_TYPENAME { strncpy($$, $1, MAXLEN); }
+        NonTypeId { $$ = $1; }
+        | T_TYPENAME { $$ = $1; }
         ;
 
 NonTypeId:
-        T_ID  { strncpy($$, $1 , MAXLEN); }
-        | 'A' { strncpy($$, "A", MAXLEN); }
-        | 'U' { strncpy($$, "U", MAXLEN); }
-        | 'W' { strncpy($$, "W", MAXLEN); }
-        | 'R' { strncpy($$, "R", MAXLEN); }
-        | 'E' { strncpy($$, "E", MAXLEN); }
-        | 'M' { strncpy($$, "M", MAXLEN); }
-        | T_SUP { strncpy($$, "sup", MAXLEN); }
-        | T_INF { strncpy($$, "inf", MAXLEN); }
-        | T_SIMULATION { strncpy($$, "simulation", MAXLEN); }
+        T_ID  { $$ = $1; }
+        | 'A' { $$ = "A"; }
+        | 'U' { $$ = "U"; }
+        | 'W' { $$ = "W"; }
+        | 'R' { $$ = "R"; }
+        | 'E' { $$ = "E"; }
+        | 'M' { $$ = "M"; }
+        | T_SUP { $$ = "sup"; }
+        | T_INF { $$ = "inf"; }
+        | T_SIMULATION { $$ = "simulation"; }
         ;
 
 FieldDeclList:
@@ -881,13 +894,13 @@ Transition:
         NonTypeId T_ARROW NonTypeId '{' {
             CALL(@1, @3, procEdgeBegin($1, $3, true));
         } Select Guard Sync Assign Probability '}' {
-          strcpy(rootTransId, $1);
+          rootTransId = $1;
           CALL(@1, @9, procEdgeEnd($1, $3));
         }
         | NonTypeId T_UNCONTROL_ARROW NonTypeId '{' {
             CALL(@1, @3, procEdgeBegin($1, $3, false));
         } Select Guard Sync Assign Probability '}' {
-          strcpy(rootTransId, $1);
+          rootTransId = $1;
           CALL(@1, @9, procEdgeEnd($1, $3));
         }
         ;
@@ -1653,7 +1666,7 @@ OldTransition:
         NonTypeId T_ARROW NonTypeId '{' {
             CALL(@1, @3, procEdgeBegin($1, $3, true));
         } OldGuard Sync Assign '}' {
-            strcpy(rootTransId, $1);
+            rootTransId = $1;
             CALL(@1, @8, procEdgeEnd($1, $3));
         }
         ;
@@ -1984,7 +1997,7 @@ Property:
 static void utap_error(const char* msg)
 {
     ch->setPosition(yylloc.start, yylloc.end);
-    ch->handleError(TypeException{msg});
+    ch->handleError(msg);
 }
 
 static void setStartToken(xta_part_t part, bool newxta)
@@ -2058,8 +2071,14 @@ static void setStartToken(xta_part_t part, bool newxta)
     }
 }
 
+std::recursive_mutex& UTAP::parserMutex()
+{
+    static auto mutex = std::recursive_mutex{};
+    return mutex;
+}
+
 static int32_t parseXTA(ParserBuilder *aParserBuilder,
-        		bool newxta, xta_part_t part, std::string xpath)
+        		bool newxta, xta_part_t part, std::string xpath, const char* text = nullptr)
 {
     // Select syntax
     syntax = newxta ? syntax_t::NEW_GUIDING : syntax_t::OLD_GUIDING;
@@ -2070,6 +2089,8 @@ static int32_t parseXTA(ParserBuilder *aParserBuilder,
 
     // Reset position tracking
     tracker.setPath(ch, xpath);
+    if (text)
+        ch->addText(tracker.position, text);
 
     // Parse string
     int res = 0;
@@ -2079,11 +2100,12 @@ static int32_t parseXTA(ParserBuilder *aParserBuilder,
         res = -1;
     }
 
+    strings.clear();
     ch = NULL;
     return res;
 }
 
-static int32_t parseProperty(ParserBuilder *aParserBuilder, const std::string& xpath)
+static int32_t parseProperty(ParserBuilder *aParserBuilder, const std::string& xpath, const char* text = nullptr)
 {
     // Select syntax
     syntax = syntax_t::PROPERTY;
@@ -2094,15 +2116,20 @@ static int32_t parseProperty(ParserBuilder *aParserBuilder, const std::string& x
 
     // Reset position tracking
     tracker.setPath(ch, xpath);
+    if (text)
+        ch->addText(tracker.position, text);
 
-    return utap_parse() ? -1 : 0;
+    int32_t res = utap_parse() ? -1 : 0;
+    strings.clear();
+    return res;
 }
 
 int32_t parseXTA(const char *str, ParserBuilder *builder,
         	 bool newxta, xta_part_t part, std::string xpath)
 {
+    auto lock = std::lock_guard{UTAP::parserMutex()};
     utap__scan_string(str);
-    int32_t res = parseXTA(builder, newxta, part, xpath);
+    int32_t res = parseXTA(builder, newxta, part, xpath, str);
     utap__delete_buffer(YY_CURRENT_BUFFER);
     return res;
 }
@@ -2144,6 +2171,7 @@ return
 
 int32_t parseXTA(const char *str, ParserBuilder *builder, bool newxta)
 {
+    auto lock = std::lock_guard{UTAP::parserMutex()};
     if (newxta)
         parseXTA(utap_builtin_declarations(), builder, newxta, S_DECLARATION, "");
     return parseXTA(str, builder, newxta, S_XTA, "");
@@ -2151,6 +2179,7 @@ int32_t parseXTA(const char *str, ParserBuilder *builder, bool newxta)
 
 int32_t parseXTA(FILE *file, ParserBuilder *builder, bool newxta)
 {
+    auto lock = std::lock_guard{UTAP::parserMutex()};
     if (newxta)
         parseXTA(utap_builtin_declarations(), builder, newxta, S_DECLARATION, "");
     utap__switch_to_buffer(utap__create_buffer(file, YY_BUF_SIZE));
@@ -2161,14 +2190,16 @@ int32_t parseXTA(FILE *file, ParserBuilder *builder, bool newxta)
 
 int32_t parseProperty(const char *str, ParserBuilder *aParserBuilder, const std::string& xpath)
 {
+    auto lock = std::lock_guard{UTAP::parserMutex()};
     utap__scan_string(str);
-    int32_t res = parseProperty(aParserBuilder, xpath);
+    int32_t res = parseProperty(aParserBuilder, xpath, str);
     utap__delete_buffer(YY_CURRENT_BUFFER);
     return res;
 }
 
 int32_t parseProperty(FILE *file, ParserBuilder *aParserBuilder)
 {
+    auto lock = std::lock_guard{UTAP::parserMutex()};
     utap__switch_to_buffer(utap__create_buffer(file, YY_BUF_SIZE));
     int32_t res = parseProperty(aParserBuilder, "");
     utap__delete_buffer(YY_CURRENT_BUFFER);
@@ -22,6 +22,7 @@
 
 #include "utap/position.h"
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 
@@ -59,6 +60,35 @@ const Positions::line_t& Positions::find(uint32_t position) const
     return find(position, 0, elements.size());
 }
 
+void Positions::addText(uint32_t position, std::string text)
+{
+    if (!texts.empty() && position < texts.back().first) {
+        throw std::logic_error("Positions must be monotonically increasing");
+    }
+    texts.emplace_back(position, std::move(text));
+}
+
+Positions::line_t Positions::locate(uint32_t position) const
+{
+    const auto& first = find(position);
+    auto text = std::upper_bound(texts.begin(), texts.end(), position,
+                                 [](uint32_t p, const auto& t) { return p < t.first; });
+    if (text == texts.begin() || (--text)->first != first.position) {
+        return first;
+    }
+    auto line = first;
+    const auto& source = text->second;
+    const auto end = std::min<size_t>(position - first.position, source.size());
+    for (size_t i = 0; i < end; ++i) {
+        if (source[i] == '\n') {
+            ++line.line;
+            line.position = first.position + i + 1;
+            line.offset = first.offset + i + 1;
+        }
+    }
+    return line;
+}
+
 /** Dump table to stdout. */
 void Positions::dump()
 {
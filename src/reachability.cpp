@@ -0,0 +1,332 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/reachability.h"
+
+#include "utap/evaluator.h"
+#include "utap/systemview.h"
+
+#include <algorithm>
+#include <map>
+#include <optional>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::vector;
+
+namespace
+{
+    struct interval_t
+    {
+        int64_t lower;
+        int64_t upper;
+
+        bool operator==(const interval_t& other) const { return lower == other.lower && upper == other.upper; }
+    };
+
+    constexpr auto falsity = interval_t{0, 0};
+    constexpr auto truth = interval_t{1, 1};
+    constexpr auto boolean = interval_t{0, 1};
+
+    /** The truth value of an integer interval. */
+    interval_t truthOf(const std::optional<interval_t>& value)
+    {
+        if (!value)
+            return boolean;
+        if (*value == falsity)
+            return falsity;
+        if (value->lower > 0 || value->upper < 0)
+            return truth;
+        return boolean;
+    }
+
+    interval_t compare(kind_t kind, const interval_t& a, const interval_t& b)
+    {
+        switch (kind) {
+        case LT: return a.upper < b.lower ? truth : a.lower >= b.upper ? falsity : boolean;
+        case LE: return a.upper <= b.lower ? truth : a.lower > b.upper ? falsity : boolean;
+        case GT: return compare(LT, b, a);
+        case GE: return compare(LE, b, a);
+        case EQ:
+            if (a.lower == a.upper && a == b)
+                return truth;
+            return a.upper < b.lower || b.upper < a.lower ? falsity : boolean;
+        case NEQ: {
+            const auto eq = compare(EQ, a, b);
+            return eq == boolean ? boolean : eq == truth ? falsity : truth;
+        }
+        default: return boolean;
+        }
+    }
+
+    /** Evaluates expressions to intervals, using the declared ranges of the variables. */
+    class Folder
+    {
+        ConstantEvaluator evaluator;
+
+        std::optional<interval_t> bounds(const type_t& type)
+        {
+            if (type.unknown())
+                return std::nullopt;
+            if (type.isBoolean())
+                return boolean;
+            if (type.is(RANGE)) {
+                auto range = type.getBounds();
+                if (!range)
+                    range = evaluator.evaluateBounds(type);
+                if (range)
+                    return interval_t{range->first(), range->last()};
+            }
+            return std::nullopt;
+        }
+
+    public:
+        std::optional<interval_t> evaluate(const expression_t& expr)
+        {
+            if (expr.empty())
+                return truth;
+            if (const auto value = evaluator.evaluate(expr))
+                return interval_t{*value, *value};
+            const auto kind = expr.getKind();
+            switch (kind) {
+            case UNARY_MINUS:
+                if (const auto a = evaluate(expr[0]))
+                    return interval_t{-a->upper, -a->lower};
+                return std::nullopt;
+            case PLUS:
+            case MINUS:
+            case MULT: {
+                const auto a = evaluate(expr[0]);
+                const auto b = a ? evaluate(expr[1]) : std::nullopt;
+                if (!b)
+                    return std::nullopt;
+                if (kind == PLUS)
+                    return interval_t{a->lower + b->lower, a->upper + b->upper};
+                if (kind == MINUS)
+                    return interval_t{a->lower - b->upper, a->upper - b->lower};
+                const int64_t products[] = {a->lower * b->lower, a->lower * b->upper, a->upper * b->lower,
+                                            a->upper * b->upper};
+                return interval_t{*std::min_element(std::begin(products), std::end(products)),
+                                  *std::max_element(std::begin(products), std::end(products))};
+            }
+            case LT:
+            case LE:
+            case EQ:
+            case NEQ:
+            case GE:
+            case GT: {
+                const auto a = evaluate(expr[0]);
+                const auto b = a ? evaluate(expr[1]) : std::nullopt;
+                return b ? compare(kind, *a, *b) : boolean;
+            }
+            case NOT: {
+                const auto a = truthOf(evaluate(expr[0]));
+                return a == boolean ? boolean : a == truth ? falsity : truth;
+            }
+            case AND:
+            case OR: {
+                const auto a = truthOf(evaluate(expr[0]));
+                const auto b = truthOf(evaluate(expr[1]));
+                const auto dominant = kind == AND ? falsity : truth;
+                if (a == dominant || b == dominant)
+                    return dominant;
+                return a == b ? a : boolean;
+            }
+            case INLINEIF: {
+                const auto cond = truthOf(evaluate(expr[0]));
+                if (cond == truth)
+                    return evaluate(expr[1]);
+                if (cond == falsity)
+                    return evaluate(expr[2]);
+                const auto a = evaluate(expr[1]);
+                const auto b = a ? evaluate(expr[2]) : std::nullopt;
+                if (!b)
+                    return std::nullopt;
+                return interval_t{std::min(a->lower, b->lower), std::max(a->upper, b->upper)};
+            }
+            default: return bounds(expr.getType());
+            }
+        }
+
+        bool isFalse(const expression_t& expr) { return truthOf(evaluate(expr)) == falsity; }
+
+        std::optional<int32_t> value(const expression_t& expr) { return evaluator.evaluate(expr); }
+    };
+
+    /** A channel, possibly an element of an array, used for synchronisation. */
+    struct channel_t
+    {
+        symbol_t symbol;  // or none if it cannot be resolved, which matches any channel
+        vector<std::optional<int32_t>> indices;
+        synchronisation_t direction;
+        bool broadcast;
+
+        bool matches(const channel_t& other) const
+        {
+            if (symbol == symbol_t{} || other.symbol == symbol_t{})
+                return true;
+            if (symbol != other.symbol || indices.size() != other.indices.size())
+                return false;
+            for (size_t i = 0; i < indices.size(); ++i)
+                if (indices[i] && other.indices[i] && *indices[i] != *other.indices[i])
+                    return false;
+            return true;
+        }
+    };
+
+    struct edge_info_t
+    {
+        const edge_t* edge;
+        bool possible;  // neither the guard nor the invariant of the target is false
+        std::optional<channel_t> channel;
+    };
+
+    struct process_info_t
+    {
+        reachability_t::process_t result;
+        vector<edge_info_t> edges;
+    };
+
+    class Analysis
+    {
+        Folder folder;
+        vector<process_info_t> processes;
+
+        channel_t resolve(const expression_t& sync)
+        {
+            auto channel = channel_t{{}, {}, sync.getSync(), sync[0].getType().is(BROADCAST)};
+            auto expr = sync[0];
+            while (expr.getKind() == ARRAY) {
+                channel.indices.insert(channel.indices.begin(), folder.value(expr[1]));
+                expr = expr[0];
+            }
+            if (expr.getKind() == IDENTIFIER)
+                channel.symbol = expr.getSymbol();
+            return channel;
+        }
+
+        /** Returns true if a reachable edge of another process may synchronise with \a edge of \a p. */
+        bool hasPartner(size_t p, const edge_info_t& edge) const
+        {
+            const auto& channel = *edge.channel;
+            if (channel.direction == SYNC_CSP || (channel.broadcast && channel.direction == SYNC_BANG))
+                return true;
+            const auto wanted = channel.direction == SYNC_BANG ? SYNC_QUE : SYNC_BANG;
+            for (size_t q = 0; q < processes.size(); ++q) {
+                if (q == p)
+                    continue;
+                const auto& locations = processes[q].result.locations;
+                for (const auto& other : processes[q].edges)
+                    if (other.possible && other.channel && other.channel->direction == wanted &&
+                        locations.count(other.edge->src) && channel.matches(*other.channel))
+                        return true;
+            }
+            return false;
+        }
+
+    public:
+        explicit Analysis(Document& document)
+        {
+            const auto view = SystemView{document};
+            for (const auto& process : view.getProcesses()) {
+                auto& info = processes.emplace_back();
+                info.result.name = process.name;
+                info.result.templ = process.templ;
+                const auto& templ = *process.templ;
+                const auto branching = std::any_of(templ.edges.begin(), templ.edges.end(),
+                                                   [](const edge_t& e) { return !e.src || !e.dst; });
+                if (branching || !templ.isTA) {
+                    // keep everything of templates with branchpoints
+                    for (const auto& state : templ.states)
+                        info.result.locations.insert(&state);
+                    for (const auto& edge : templ.edges)
+                        info.result.edges.insert(&edge);
+                    continue;
+                }
+                if (const auto* init = static_cast<const state_t*>(templ.init.getData()))
+                    info.result.locations.insert(init);
+                for (const auto& edge : templ.edges) {
+                    auto& e = info.edges.emplace_back();
+                    e.edge = &edge;
+                    e.possible = !folder.isFalse(SystemView::bind(process, edge.guard)) &&
+                                 !folder.isFalse(SystemView::bind(process, edge.dst->invariant));
+                    if (!edge.sync.empty() && edge.sync.getKind() == SYNC)
+                        e.channel = resolve(SystemView::bind(process, edge.sync));
+                }
+            }
+
+            for (auto changed = true; changed;) {
+                changed = false;
+                for (size_t p = 0; p < processes.size(); ++p) {
+                    auto& result = processes[p].result;
+                    for (const auto& edge : processes[p].edges) {
+                        if (!edge.possible || result.edges.count(edge.edge) || !result.locations.count(edge.edge->src))
+                            continue;
+                        if (edge.channel && !hasPartner(p, edge))
+                            continue;
+                        result.edges.insert(edge.edge);
+                        result.locations.insert(edge.edge->dst);
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        reachability_t result() &&
+        {
+            auto reachability = reachability_t{};
+            for (auto& process : processes)
+                reachability.processes.push_back(std::move(process.result));
+            return reachability;
+        }
+    };
+}  // namespace
+
+reachability_t UTAP::analyseReachability(Document& document) { return Analysis{document}.result(); }
+
+pruning_t UTAP::pruneUnreachable(Document& document)
+{
+    const auto reachability = analyseReachability(document);
+    auto used = std::map<const template_t*, std::pair<std::set<const state_t*>, std::set<const edge_t*>>>{};
+    for (const auto& process : reachability.processes) {
+        auto& [locations, edges] = used[process.templ];
+        locations.insert(process.locations.begin(), process.locations.end());
+        edges.insert(process.edges.begin(), process.edges.end());
+    }
+
+    auto pruning = pruning_t{};
+    for (auto& templ : document.getTemplates()) {
+        const auto it = used.find(&templ);
+        if (it == used.end())
+            continue;  // not instantiated, thus not analysed
+        const auto& [locations, edges] = it->second;
+        for (const auto& state : templ.states)
+            if (!locations.count(&state))
+                ++pruning.locations;
+        const auto live = std::stable_partition(templ.edges.begin(), templ.edges.end(),
+                                                [&](const edge_t& edge) { return edges.count(&edge) > 0; });
+        pruning.edges += std::distance(live, templ.edges.end());
+        templ.edges.erase(live, templ.edges.end());
+    }
+    return pruning;
+}
@@ -0,0 +1,204 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/subexpressions.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+using namespace UTAP;
+using namespace Constants;
+
+using std::vector;
+
+namespace
+{
+    size_t nodes(const expression_t& expr)
+    {
+        auto count = size_t{1};
+        for (uint32_t i = 0; i < expr.getSize(); ++i)
+            count += nodes(expr[i]);
+        return count;
+    }
+
+    bool same(const expression_t& a, const expression_t& b)
+    {
+        return a.hashStructure() == b.hashStructure() && a.equalStructure(b);
+    }
+
+    uint32_t occurrences(const expression_t& expr, const expression_t& target)
+    {
+        if (expr.empty())
+            return 0;
+        if (same(expr, target))
+            return 1;
+        auto count = 0u;
+        for (uint32_t i = 0; i < expr.getSize(); ++i)
+            count += occurrences(expr[i], target);
+        return count;
+    }
+
+    /** Returns \a expr with the occurrences of \a target replaced, sharing the unchanged parts. */
+    expression_t replace(const expression_t& expr, const expression_t& target, const expression_t& replacement)
+    {
+        if (expr.empty())
+            return expr;
+        if (same(expr, target))
+            return replacement;
+        auto result = expr;
+        for (uint32_t i = 0; i < expr.getSize(); ++i) {
+            auto sub = replace(expr[i], target, replacement);
+            if (!sub.equal(expr[i])) {
+                if (result.equal(expr))
+                    result = expr.clone();
+                result[i] = std::move(sub);
+            }
+        }
+        return result;
+    }
+
+    /** Adds the variables bound by the quantifiers and sums in \a expr. */
+    void collectBound(const expression_t& expr, std::set<symbol_t>& symbols)
+    {
+        if (expr.empty())
+            return;
+        switch (expr.getKind()) {
+        case FORALL:
+        case EXISTS:
+        case SUM: symbols.insert(expr[0].getSymbol()); break;
+        default: break;
+        }
+        for (uint32_t i = 0; i < expr.getSize(); ++i)
+            collectBound(expr[i], symbols);
+    }
+
+    class Eliminator
+    {
+        CostModel& model;
+        double minimumCost;
+        std::set<symbol_t> bound;  // select and quantifier variables, which have no value at the location
+        vector<expression_t> candidates;
+        std::unordered_map<size_t, vector<size_t>> index;  // candidates by structural hash
+
+        bool eligible(const expression_t& expr)
+        {
+            const auto kind = expr.getKind();
+            const auto& type = expr.getType();
+            return kind != IDENTIFIER && kind != CONSTANT && kind != RATE && (type.isIntegral() || type.isDouble()) &&
+                   !type.isClock() && !expr.usesClock() && !expr.isDynamic() && !expr.hasDynamicSub() &&
+                   !expr.changesAnyVariable() && !expr.dependsOn(bound) && model.cost(expr) >= minimumCost;
+        }
+
+        void collect(const expression_t& expr)
+        {
+            if (expr.empty())
+                return;
+            for (uint32_t i = 0; i < expr.getSize(); ++i)
+                collect(expr[i]);
+            if (!eligible(expr))
+                return;
+            auto& bucket = index[expr.hashStructure()];
+            const auto known = std::any_of(bucket.begin(), bucket.end(),
+                                           [&](size_t c) { return candidates[c].equalStructure(expr); });
+            if (!known) {
+                bucket.push_back(candidates.size());
+                candidates.push_back(expr);
+            }
+        }
+
+    public:
+        Eliminator(CostModel& model, double minimumCost): model{model}, minimumCost{minimumCost} {}
+
+        void eliminate(const template_t& templ, const state_t& state, template_subexpressions_t& result)
+        {
+            auto edges = vector<const edge_t*>{};
+            bound.clear();
+            for (const auto& edge : templ.edges) {
+                if (edge.src == &state) {
+                    edges.push_back(&edge);
+                    for (uint32_t i = 0; i < edge.select.getSize(); ++i)
+                        bound.insert(edge.select[i]);
+                }
+            }
+            auto exprs = vector<expression_t>{state.invariant};
+            for (const auto* edge : edges)
+                exprs.push_back(edge->guard);
+            for (const auto& expr : exprs)
+                collectBound(expr, bound);
+
+            candidates.clear();
+            index.clear();
+            for (const auto& expr : exprs)
+                collect(expr);
+            // the longest first, such that their parts are only eliminated if shared elsewhere too
+            std::stable_sort(candidates.begin(), candidates.end(),
+                             [](const expression_t& a, const expression_t& b) { return nodes(a) > nodes(b); });
+
+            auto temporaries = vector<temporary_t>{};
+            for (const auto& candidate : candidates) {
+                auto uses = 0u;
+                for (const auto& expr : exprs)
+                    uses += occurrences(expr, candidate);
+                for (const auto& temporary : temporaries)
+                    uses += occurrences(temporary.value, candidate);
+                if (uses < 2)
+                    continue;
+                const auto name = "_t" + std::to_string(result.temporaries.getSize());
+                const auto symbol = result.temporaries.addSymbol(name, candidate.getType(), candidate.getPosition());
+                const auto id = expression_t::createIdentifier(symbol, candidate.getPosition());
+                for (auto& expr : exprs)
+                    expr = replace(expr, candidate, id);
+                for (auto& temporary : temporaries)
+                    temporary.value = replace(temporary.value, candidate, id);
+                temporaries.push_back({symbol, candidate, uses, mayFail(candidate)});
+            }
+            if (temporaries.empty())
+                return;
+
+            // the later temporaries are parts of the earlier ones
+            std::reverse(temporaries.begin(), temporaries.end());
+            auto& location = result.locations.emplace_back();
+            location.location = &state;
+            location.precompute = std::move(temporaries);
+            location.invariant = exprs[0];
+            for (size_t i = 0; i < edges.size(); ++i)
+                location.guards.emplace_back(edges[i], exprs[i + 1]);
+        }
+    };
+}  // namespace
+
+vector<template_subexpressions_t> UTAP::eliminateCommonSubexpressions(Document& document, CostModel& model,
+                                                                      double minimumCost)
+{
+    auto result = vector<template_subexpressions_t>{};
+    auto eliminator = Eliminator{model, minimumCost};
+    for (const auto& templ : document.getTemplates()) {
+        auto& subexpressions = result.emplace_back();
+        subexpressions.templ = &templ;
+        subexpressions.temporaries = frame_t::createFrame();
+        for (const auto& state : templ.states)
+            eliminator.eliminate(templ, state, subexpressions);
+    }
+    return result;
+}
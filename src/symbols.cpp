@@ -42,7 +42,7 @@ using namespace Constants;
 
 //////////////////////////////////////////////////////////////////////////
 
-struct symbol_t::symbol_data : public std::enable_shared_from_this<symbol_t::symbol_data>
+struct symbol_t::symbol_data : public counted_t
 {
     frame_t::frame_data* frame = nullptr;  // Uncounted pointer to containing frame // TODO: consider removing
     type_t type;                           // The type of the symbol
@@ -56,7 +56,7 @@ struct symbol_t::symbol_data : public std::enable_shared_from_this<symbol_t::sym
 
 symbol_t::symbol_t(frame_t* frame, type_t type, string name, position_t position, void* user)
 {
-    data = std::make_shared<symbol_data>(frame->data.get(), std::move(type), user, std::move(name), position);
+    data = make_counted<symbol_data>(frame->data.get(), std::move(type), user, std::move(name), position);
 }
 
 /* Destructor */
@@ -73,7 +73,7 @@ bool symbol_t::operator<(const symbol_t& symbol) const { return data < symbol.da
 frame_t symbol_t::getFrame() { return frame_t(data->frame); }
 
 /* Returns the type of this symbol. */
-type_t symbol_t::getType() const { return data->type; }
+const type_t& symbol_t::getType() const { return data->type; }
 
 void symbol_t::setType(type_t type) { data->type = type; }
 
@@ -94,7 +94,7 @@ std::ostream& operator<<(std::ostream& o, const UTAP::symbol_t& t) { return o <<
 
 //////////////////////////////////////////////////////////////////////////
 
-struct frame_t::frame_data : public std::enable_shared_from_this<frame_t::frame_data>
+struct frame_t::frame_data : public counted_t
 {
     // bool hasParent;                // True if there is a parent
     frame_data* parent;            // The parent frame data
@@ -104,7 +104,7 @@ struct frame_t::frame_data : public std::enable_shared_from_this<frame_t::frame_
     bool hasParent() const { return parent != nullptr; }
 };
 
-frame_t::frame_t(frame_data* frame) { data = frame->shared_from_this(); }
+frame_t::frame_t(frame_data* frame): data{frame} {}
 
 /* Destructor */
 frame_t::~frame_t() noexcept = default;
@@ -243,7 +243,7 @@ bool frame_t::hasParent() const { return data->hasParent(); }
 frame_t frame_t::createFrame()
 {
     frame_t f;
-    f.data = std::make_shared<frame_data>(nullptr);
+    f.data = make_counted<frame_data>(nullptr);
     return f;
 }
 
@@ -251,7 +251,7 @@ frame_t frame_t::createFrame()
 frame_t frame_t::createFrame(const frame_t& parent)
 {
     frame_t f;
-    f.data = std::make_shared<frame_data>(parent.data.get());
+    f.data = make_counted<frame_data>(parent.data.get());
     return f;
 }
 
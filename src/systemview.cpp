@@ -0,0 +1,204 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/systemview.h"
+
+#include "utap/evaluator.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace UTAP;
+using namespace Constants;
+
+SystemView::SystemView(Document& document)
+{
+    for (const auto& variable : document.getGlobals().variables) {
+        if (!variable.uid.getType().isConstant())
+            globalSlots.emplace(variable.uid, addSlot(variable.uid, none));
+    }
+
+    auto evaluator = ConstantEvaluator{};
+    for (const auto& instance : document.getProcesses()) {
+        // Enumerate the values of the unbound parameters in lexicographic order
+        auto bounds = std::vector<range_t<int32_t>>{};
+        for (size_t i = 0; i < instance.unbound; ++i) {
+            const auto type = instance.parameters[i].getType();
+            const auto range = type.is(RANGE) ? evaluator.evaluateBounds(type) : std::nullopt;
+            if (!range) {
+                bounds.clear();
+                break;
+            }
+            bounds.push_back(*range);
+        }
+        if (bounds.size() != instance.unbound) {
+            addProcess(instance, {}, evaluator);
+            continue;
+        }
+        if (std::any_of(bounds.begin(), bounds.end(), [](const auto& r) { return r.empty(); }))
+            continue;
+        auto values = std::vector<int32_t>{};
+        for (const auto& range : bounds)
+            values.push_back(range.first());
+        for (;;) {
+            addProcess(instance, values, evaluator);
+            auto i = values.size();
+            while (i > 0 && values[i - 1] == bounds[i - 1].last()) {
+                values[i - 1] = bounds[i - 1].first();
+                --i;
+            }
+            if (i == 0)
+                break;
+            ++values[i - 1];
+        }
+    }
+}
+
+int32_t SystemView::addSlot(const symbol_t& symbol, int32_t process)
+{
+    slots.push_back({symbol, process});
+    return static_cast<int32_t>(slots.size() - 1);
+}
+
+const std::map<symbol_t, int32_t>& SystemView::getIndices(const template_t& templ)
+{
+    auto [it, inserted] = indices.try_emplace(&templ);
+    if (inserted) {
+        auto& index = it->second;
+        for (uint32_t i = 0; i < templ.parameters.getSize(); ++i)
+            index.emplace(templ.parameters[i], index.size());
+        for (const auto& variable : templ.variables)
+            index.emplace(variable.uid, index.size());
+    }
+    return it->second;
+}
+
+int32_t SystemView::getIndex(const template_t& templ, const symbol_t& symbol) const
+{
+    const auto it = indices.find(&templ);
+    if (it == indices.end())
+        return none;
+    const auto index = it->second.find(symbol);
+    return index == it->second.end() ? none : index->second;
+}
+
+int32_t SystemView::getSlot(int32_t process, const symbol_t& symbol) const
+{
+    if (process != none) {
+        const auto& p = processes.at(process);
+        const auto index = getIndex(*p.templ, symbol);
+        if (index != none)
+            return p.slots[index];
+    }
+    const auto it = globalSlots.find(symbol);
+    return it == globalSlots.end() ? none : it->second;
+}
+
+expression_t SystemView::bind(const process_t& process, expression_t expr)
+{
+    if (expr.empty())
+        return expr;
+    const auto& parameters = process.templ->parameters;
+    for (uint32_t i = 0; i < parameters.getSize() && i < process.parameters.size(); ++i) {
+        const auto& binding = process.parameters[i];
+        if (binding.kind == VALUE) {
+            expr = expr.subst(parameters[i], expression_t::createConstant(binding.value));
+        } else if (!binding.argument.empty()) {
+            expr = expr.subst(parameters[i], binding.argument);
+        }
+    }
+    return expr;
+}
+
+/** Returns the argument of template parameter \a parameter in terms of
+    the unbound parameters of \a instance only. */
+static expression_t getArgument(const instance_t& instance, const symbol_t& parameter)
+{
+    const auto it = instance.mapping.find(parameter);
+    if (it == instance.mapping.end())
+        return expression_t::createIdentifier(parameter);  // unbound parameter of the template itself
+    auto argument = it->second;
+    // Parameters of partial instances between the unbound parameters and
+    // the template parameters, innermost instance last
+    const auto bound = instance.parameters.getSize() - instance.templ->parameters.getSize();
+    for (auto i = bound; i > instance.unbound; --i) {
+        const auto symbol = instance.parameters[i - 1];
+        const auto binding = instance.mapping.find(symbol);
+        if (binding != instance.mapping.end())
+            argument = argument.subst(symbol, binding->second);
+    }
+    return argument;
+}
+
+void SystemView::addProcess(const instance_t& instance, const std::vector<int32_t>& values,
+                            ConstantEvaluator& evaluator)
+{
+    assert(instance.templ != nullptr);
+    const auto& templ = *instance.templ;
+    const auto id = static_cast<int32_t>(processes.size());
+    auto& process = processes.emplace_back();
+    process.name = instance.uid.getName();
+    if (!values.empty()) {
+        auto separator = '(';
+        for (const auto value : values) {
+            process.name += separator;
+            process.name += std::to_string(value);
+            separator = ',';
+        }
+        process.name += ')';
+    }
+    process.instance = &instance;
+    process.templ = &templ;
+    process.values = values;
+
+    const auto& index = getIndices(templ);
+    process.slots.assign(index.size(), none);
+    for (uint32_t i = 0; i < templ.parameters.getSize(); ++i) {
+        const auto& parameter = templ.parameters[i];
+        auto& binding = process.parameters.emplace_back();
+        binding.argument = getArgument(instance, parameter);
+        for (size_t j = 0; j < values.size(); ++j)
+            binding.argument = binding.argument.subst(instance.parameters[j], expression_t::createConstant(values[j]));
+
+        const auto type = parameter.getType();
+        const auto value = evaluator.evaluate(binding.argument);
+        if (type.is(REF) && (!type.isConstant() || !value)) {
+            binding.kind = REFERENCE;
+            binding.slot = getSlot(none, binding.argument.getSymbol());
+            process.slots[index.at(parameter)] = binding.slot;
+            continue;
+        }
+        if (value) {
+            binding.kind = VALUE;
+            binding.value = *value;
+        }
+        if (!type.isConstant()) {
+            // Passed by value: the process has a variable of its own
+            binding.slot = addSlot(parameter, id);
+            process.slots[index.at(parameter)] = binding.slot;
+        }
+    }
+    for (const auto& variable : templ.variables) {
+        if (!variable.uid.getType().isConstant())
+            process.slots[index.at(variable.uid)] = addSlot(variable.uid, id);
+    }
+}
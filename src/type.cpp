@@ -37,18 +37,19 @@ struct type_t::child_t
     type_t child;
 };
 
-struct type_t::type_data
+struct type_t::type_data : public counted_t
 {
     kind_t kind;          // Kind of type object
     position_t position;  // Position in the input file
     expression_t expr;    //
     std::vector<child_t> children;
+    std::optional<range_t<int32_t>> bounds;  // Evaluated bounds of a RANGE
     type_data(kind_t kind, position_t position): kind{kind}, position{position} {}
 };
 
 type_t::type_t(kind_t kind, const position_t& pos, size_t size)
 {
-    data = std::make_shared<type_data>(kind, pos);
+    data = make_counted<type_data>(kind, pos);
     data->children.resize(size);
 }
 
@@ -64,13 +65,13 @@ size_t type_t::size() const
     return data->children.size();
 }
 
-const type_t type_t::operator[](uint32_t i) const
+const type_t& type_t::operator[](uint32_t i) const
 {
     assert(i < size());
     return data->children[i].child;
 }
 
-const type_t type_t::get(uint32_t i) const
+const type_t& type_t::get(uint32_t i) const
 {
     assert(i < size());
     return data->children[i].child;
@@ -225,6 +226,18 @@ std::pair<expression_t, expression_t> type_t::getRange() const
     }
 }
 
+std::optional<range_t<int32_t>> type_t::getBounds() const
+{
+    assert(is(RANGE));
+    return getKind() == RANGE ? data->bounds : get(0).getBounds();
+}
+
+void type_t::setBounds(const range_t<int32_t>& bounds)
+{
+    assert(getKind() == RANGE);
+    data->bounds = bounds;
+}
+
 expression_t type_t::getExpression() const
 {
     assert(data);
@@ -22,9 +22,11 @@
 #include "utap/typechecker.h"
 
 #include "utap/DocumentBuilder.hpp"
+#include "utap/evaluator.h"
 #include "utap/featurechecker.h"
 #include "utap/utap.h"
 
+#include <utility>  // exchange
 #include <cassert>
 
 using namespace UTAP;
@@ -33,14 +35,14 @@ using namespace Constants;
 /* The following are simple helper functions for testing the type of
  * expressions.
  */
-static bool isCost(expression_t expr) { return expr.getType().is(COST); }
+static bool isCost(const expression_t& expr) { return expr.getType().is(COST); }
 
-static bool isVoid(expression_t expr) { return expr.getType().isVoid(); }
+static bool isVoid(const expression_t& expr) { return expr.getType().isVoid(); }
 
-static bool isDouble(expression_t expr) { return expr.getType().isDouble(); }
+static bool isDouble(const expression_t& expr) { return expr.getType().isDouble(); }
 
 /*
-static bool isString(expression_t expr)
+static bool isString(const expression_t& expr)
 {
     return expr.getType().isString();
 }
@@ -50,35 +52,35 @@ static bool isString(expression_t expr)
 //     return expr.getType().isScalar();
 // }
 
-static bool isInteger(expression_t expr) { return expr.getType().isInteger(); }
+static bool isInteger(const expression_t& expr) { return expr.getType().isInteger(); }
 
-static bool isBound(expression_t expr) { return expr.getType().isInteger() || expr.getType().isDouble(); }
+static bool isBound(const expression_t& expr) { return expr.getType().isInteger() || expr.getType().isDouble(); }
 
-static bool isIntegral(expression_t expr) { return expr.getType().isIntegral(); }
+static bool isIntegral(const expression_t& expr) { return expr.getType().isIntegral(); }
 
-static bool isClock(expression_t expr) { return expr.getType().isClock(); }
+static bool isClock(const expression_t& expr) { return expr.getType().isClock(); }
 
-static bool isDiff(expression_t expr) { return expr.getType().isDiff(); }
+static bool isDiff(const expression_t& expr) { return expr.getType().isDiff(); }
 
-static bool isDoubleValue(expression_t expr) { return isDouble(expr) || isClock(expr) || isDiff(expr); }
+static bool isDoubleValue(const expression_t& expr) { return isDouble(expr) || isClock(expr) || isDiff(expr); }
 
-static bool isNumber(expression_t expr) { return isDoubleValue(expr) || isIntegral(expr); }
+static bool isNumber(const expression_t& expr) { return isDoubleValue(expr) || isIntegral(expr); }
 
-static bool isConstantInteger(expression_t expr) { return expr.getKind() == CONSTANT && isInteger(expr); }
+static bool isConstantInteger(const expression_t& expr) { return expr.getKind() == CONSTANT && isInteger(expr); }
 
-static bool isConstantDouble(expression_t expr) { return expr.getKind() == CONSTANT && isDouble(expr); }
+static bool isConstantDouble(const expression_t& expr) { return expr.getKind() == CONSTANT && isDouble(expr); }
 
-static bool isInvariant(expression_t expr) { return expr.getType().isInvariant(); }
+static bool isInvariant(const expression_t& expr) { return expr.getType().isInvariant(); }
 
-static bool isGuard(expression_t expr) { return expr.getType().isGuard(); }
+static bool isGuard(const expression_t& expr) { return expr.getType().isGuard(); }
 
-static bool isProbability(expression_t expr) { return expr.getType().isProbability(); }
+static bool isProbability(const expression_t& expr) { return expr.getType().isProbability(); }
 
-static bool isConstraint(expression_t expr) { return expr.getType().isConstraint(); }
+static bool isConstraint(const expression_t& expr) { return expr.getType().isConstraint(); }
 
-static bool isFormula(expression_t expr) { return expr.getType().isFormula(); }
+static bool isFormula(const expression_t& expr) { return expr.getType().isFormula(); }
 
-static bool isListOfFormulas(expression_t expr)
+static bool isListOfFormulas(const expression_t& expr)
 {
     if (expr.getKind() != LIST) {
         return false;
@@ -93,7 +95,7 @@ static bool isListOfFormulas(expression_t expr)
     return true;
 }
 
-static bool hasStrictLowerBound(expression_t expr)
+static bool hasStrictLowerBound(const expression_t& expr)
 {
     for (size_t i = 0; i < expr.getSize(); ++i) {
         if (hasStrictLowerBound(expr[i])) {
@@ -119,7 +121,7 @@ static bool hasStrictLowerBound(expression_t expr)
     return false;
 }
 
-static bool hasStrictUpperBound(expression_t expr)
+static bool hasStrictUpperBound(const expression_t& expr)
 {
     for (size_t i = 0; i < expr.getSize(); ++i) {
         if (hasStrictUpperBound(expr[i])) {
@@ -149,7 +151,7 @@ static bool hasStrictUpperBound(expression_t expr)
  * Returns true iff type is a valid invariant. A valid invariant is
  * either an invariant expression or an integer expression.
  */
-static bool isInvariantWR(expression_t expr) { return isInvariant(expr) || (expr.getType().is(INVARIANT_WR)); }
+static bool isInvariantWR(const expression_t& expr) { return isInvariant(expr) || (expr.getType().is(INVARIANT_WR)); }
 
 /**
  * Returns true if values of this type can be assigned. This is the
@@ -287,15 +289,15 @@ TypeChecker::TypeChecker(Document& doc, bool refinement): doc{doc}, syncUsed(0)
 }
 
 template <class T>
-void TypeChecker::handleWarning(T expr, const std::string& msg)
+void TypeChecker::handleWarning(T expr, const char* id, std::vector<std::string> args)
 {
-    doc.addWarning(expr.getPosition(), msg, "(typechecking)");
+    doc.addWarning(expr.getPosition(), id, std::move(args), "(typechecking)");
 }
 
 template <class T>
-void TypeChecker::handleError(T expr, const std::string& msg)
+void TypeChecker::handleError(T expr, const char* id, std::vector<std::string> args)
 {
-    doc.addError(expr.getPosition(), msg, "(typechecking)");
+    doc.addError(expr.getPosition(), id, std::move(args), "(typechecking)");
 }
 
 /**
@@ -530,6 +532,7 @@ void TypeChecker::visitSystemAfter(Document* doc)
             }
         }
     }
+    checked.clear();
 }
 
 void TypeChecker::visitHybridClock(expression_t e)
@@ -688,10 +691,8 @@ void TypeChecker::visitState(state_t& state)
     if (!state.invariant.empty()) {
         if (checkExpression(state.invariant)) {
             if (!isInvariantWR(state.invariant)) {
-                std::string s = "$Expression_of_type ";
-                s += state.invariant.getType().toString();
-                s += " $cannot_be_used_as_an_invariant";
-                handleError(state.invariant, s);
+                handleError(state.invariant, "$Expression_of_type %s $cannot_be_used_as_an_invariant",
+                            {state.invariant.getType().toString()});
             } else if (state.invariant.changesAnyVariable()) {
                 handleError(state.invariant, "$Invariant_must_be_side-effect_free");
             } else {
@@ -741,10 +742,8 @@ void TypeChecker::visitEdge(edge_t& edge)
     if (!edge.guard.empty()) {
         if (checkExpression(edge.guard)) {
             if (!isGuard(edge.guard)) {
-                std::string s = "$Expression_of_type ";
-                s += edge.guard.getType().toString();
-                s += " $cannot_be_used_as_a_guard";
-                handleError(edge.guard, s);
+                handleError(edge.guard, "$Expression_of_type %s $cannot_be_used_as_a_guard",
+                            {edge.guard.getType().toString()});
             } else if (edge.guard.changesAnyVariable()) {
                 handleError(edge.guard, "$Guard_must_be_side-effect_free");
             }
@@ -867,10 +866,8 @@ void TypeChecker::visitEdge(edge_t& edge)
     if (!edge.prob.empty()) {
         if (checkExpression(edge.prob)) {
             if (!isProbability(edge.prob)) {
-                std::string s = "$Expression_of_type ";
-                s += edge.prob.getType().toString();
-                s += " $cannot_be_used_as_a_probability";
-                handleError(edge.prob, s);
+                handleError(edge.prob, "$Expression_of_type %s $cannot_be_used_as_a_probability",
+                            {edge.prob.getType().toString()});
             } else if (edge.prob.changesAnyVariable()) {
                 handleError(edge.prob, "$Probability_must_be_side-effect_free");
             }
@@ -901,10 +898,8 @@ void TypeChecker::visitCondition(condition_t& condition)
     if (!condition.label.empty()) {
         if (checkExpression(condition.label)) {
             if (!isGuard(condition.label)) {
-                std::string s = "$Expression_of_type ";
-                s += condition.label.getType().toString();
-                s += " $cannot_be_used_as_a_condition";
-                handleError(condition.label, s);
+                handleError(condition.label, "$Expression_of_type %s $cannot_be_used_as_a_condition",
+                            {condition.label.getType().toString()});
             } else if (condition.label.changesAnyVariable()) {
                 handleError(condition.label, "$Condition_must_be_side-effect_free");
             }
@@ -1007,7 +1002,7 @@ void TypeChecker::visitInstance(instance_t& instance)
     }
 }
 
-static bool isGameProperty(expression_t expr)
+static bool isGameProperty(const expression_t& expr)
 {
     switch (expr.getKind()) {
     case CONTROL:
@@ -1021,7 +1016,7 @@ static bool isGameProperty(expression_t expr)
     }
 }
 
-static bool hasMITLInQuantifiedSub(expression_t expr)
+static bool hasMITLInQuantifiedSub(const expression_t& expr)
 {
     bool hasIt = (expr.getKind() == MITLFORALL || expr.getKind() == MITLEXISTS);
     if (!hasIt) {
@@ -1032,7 +1027,7 @@ static bool hasMITLInQuantifiedSub(expression_t expr)
     return hasIt;
 }
 
-static bool hasSpawnOrExit(expression_t expr)
+static bool hasSpawnOrExit(const expression_t& expr)
 {
     bool hasIt = (expr.getKind() == SPAWN || expr.getKind() == EXIT);
     if (!hasIt) {
@@ -1644,13 +1639,32 @@ bool TypeChecker::areEqCompatible(type_t t1, type_t t2) const
     out-of-range errors or warnings. Returns true if no type errors
     were found, false otherwise.
 */
-bool TypeChecker::checkExpression(expression_t expr)
+bool TypeChecker::checkExpression(const expression_t& expr)
 {
     /* Do not check empty expressions.
      */
     if (expr.empty())
         return true;
 
+    /* Check shared nodes once. Nodes with a single handle cannot be
+     * reached along another path. Failures are not remembered, so the
+     * errors are reported on every path, and neither are subtrees
+     * whose type depends on the template being checked.
+     */
+    if (!expr.isShared())
+        return checkNode(expr);
+    if (checked.count(expr) > 0)
+        return true;
+    const auto outer = std::exchange(contextual, false);
+    const auto ok = checkNode(expr);
+    if (ok && !contextual)
+        checked.insert(expr);
+    contextual = contextual || outer;
+    return ok;
+}
+
+bool TypeChecker::checkNode(const expression_t& expr)
+{
     /* CheckExpression sub-expressions.
      */
     bool ok = true;
@@ -1777,6 +1791,8 @@ bool TypeChecker::checkExpression(expression_t expr)
         break;
 
     case SPAWN: {
+        // Depends on whether the template has been defined yet
+        contextual = true;
         template_t* temp = doc.getDynamicTemplate(expr[0].getSymbol().getName());
         if (!temp) {
             handleError(expr, "It appears your trying to spawn a non-dynamic template");
@@ -1813,6 +1829,7 @@ bool TypeChecker::checkExpression(expression_t expr)
     }
 
     case EXIT: {
+        contextual = true;
         assert(temp);
         if (!temp->dynamic) {
             handleError(expr, "Exit can only be used in templates declared as dynamic");
@@ -2462,7 +2479,7 @@ bool TypeChecker::checkExpression(expression_t expr)
 /**
  * Returns true if expression evaluates to a modifiable l-value.
  */
-bool TypeChecker::isModifiableLValue(expression_t expr) const
+bool TypeChecker::isModifiableLValue(const expression_t& expr) const
 {
     type_t t, f;
     switch (expr.getKind()) {
@@ -2512,7 +2529,7 @@ bool TypeChecker::isModifiableLValue(expression_t expr) const
 /**
  * Returns true iff \a expr evaluates to an lvalue.
  */
-bool TypeChecker::isLValue(expression_t expr) const
+bool TypeChecker::isLValue(const expression_t& expr) const
 {
     type_t t, f;
     switch (expr.getKind()) {
@@ -2552,7 +2569,7 @@ bool TypeChecker::isLValue(expression_t expr) const
     expressions. Thus i[v] is a l-value, but if v is a non-constant
     variable, then it does not result in a unique reference.
 */
-bool TypeChecker::isUniqueReference(expression_t expr) const
+bool TypeChecker::isUniqueReference(const expression_t& expr) const
 {
     switch (expr.getKind()) {
     case IDENTIFIER: return true;
@@ -2594,6 +2611,8 @@ bool parseXTA(FILE* file, Document* doc, bool newxta)
     if (!doc->hasErrors()) {
         TypeChecker checker(*doc);
         doc->accept(checker);
+        if (!doc->hasErrors())
+            evaluateBounds(*doc);
     }
     return !doc->hasErrors();
 }
@@ -2605,6 +2624,8 @@ bool parseXTA(const char* buffer, Document* doc, bool newxta)
     if (!doc->hasErrors()) {
         TypeChecker checker(*doc);
         doc->accept(checker);
+        if (!doc->hasErrors())
+            evaluateBounds(*doc);
     }
     return !doc->hasErrors();
 }
@@ -2621,6 +2642,8 @@ int32_t parseXMLBuffer(const char* buffer, Document* doc, bool newxta, const std
     if (!doc->hasErrors()) {
         TypeChecker checker(*doc);
         doc->accept(checker);
+        if (!doc->hasErrors())
+            evaluateBounds(*doc);
         FeatureChecker fchecker(*doc);
         doc->setSupportedMethods(fchecker.getSupportedMethods());
     }
@@ -2639,6 +2662,8 @@ int32_t parseXMLFile(const char* file, Document* doc, bool newxta, const std::ve
     if (!doc->hasErrors()) {
         TypeChecker checker(*doc);
         doc->accept(checker);
+        if (!doc->hasErrors())
+            evaluateBounds(*doc);
     }
 
     return 0;
@@ -2655,6 +2680,8 @@ int32_t parseXMLFd(int fd, Document* doc, bool newxta, const std::vector<std::fi
     if (!doc->hasErrors()) {
         TypeChecker checker(*doc);
         doc->accept(checker);
+        if (!doc->hasErrors())
+            evaluateBounds(*doc);
     }
 
     return 0;
@@ -20,6 +20,7 @@
    USA
  */
 
+#include "decompress.h"
 #include "keywords.hpp"
 #include "libparser.h"
 
@@ -42,8 +43,16 @@
 #include <vector>
 #include <cassert>
 #include <charconv>
+#include <cerrno>
+#include <cstdio>
 #include <cstring>  // strncmp
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 namespace UTAP
 {
     enum class tag_t {
@@ -356,6 +365,10 @@ namespace UTAP
         }
         /** Returns the name of a location. */
         const std::string& getName(const char* id) const;
+        /** Adds the position of \a xpath to the builder, see parserMutex(). */
+        void locate(const std::string& xpath);
+        /** Locates \a xpath and sets the builder position to its first \a length positions. */
+        void locate(const std::string& xpath, uint32_t length);
         /** Invokes the bison generated parser to parse the given string. */
         int parse(const xmlChar*, xta_part_t syntax);
         /** Parse optional declaration. */
@@ -557,6 +570,19 @@ namespace UTAP
         throw XMLDocError("Missing reference");
     }
 
+    void XMLReader::locate(const std::string& xpath)
+    {
+        auto lock = std::lock_guard{parserMutex()};
+        tracker.setPath(parser, xpath);
+    }
+
+    void XMLReader::locate(const std::string& xpath, uint32_t length)
+    {
+        auto lock = std::lock_guard{parserMutex()};
+        tracker.setPath(parser, xpath);
+        tracker.increment(parser, length);
+    }
+
     int XMLReader::parse(const xmlChar* text, xta_part_t syntax)
     {
         return parseXTA((const char*)text, parser, newxta, syntax, path.get());
@@ -596,13 +622,13 @@ namespace UTAP
             xmlFree(kind);
             return true;
         } else if (required) {
-            tracker.setPath(parser, path.get());
+            locate(path.get());
             if (s_kind == "message")  // LSC
-                parser->handleError(TypeException{"$Message_label_is_required"});
+                parser->handleError("$Message_label_is_required");
             else if (s_kind == "update")  // LSC
-                parser->handleError(TypeException{"$Update_label_is_required"});
+                parser->handleError("$Update_label_is_required");
             else if (s_kind == "condition")  // LSC
-                parser->handleError(TypeException{"$Condition_label_is_required"});
+                parser->handleError("$Condition_label_is_required");
         }
         return false;
     }
@@ -639,7 +665,7 @@ namespace UTAP
     {
         std::string text = readString(tag_t::NAME, instanceLine);
         if (instanceLine && text.empty())
-            parser->handleError(TypeException{"$Instance_name_is_required"});
+            parser->handleError("$Instance_name_is_required");
         return text;
     }
 
@@ -649,8 +675,7 @@ namespace UTAP
             xmlChar* text = xmlTextReaderValue(reader.get());
             auto len = text ? std::strlen((const char*)text) : 0;
             auto text_sv = std::string_view{(const char*)text, len};
-            tracker.setPath(parser, path.get());
-            tracker.increment(parser, text_sv.size());
+            locate(path.get(), text_sv.size());
             try {
                 std::string_view id = (instanceLine) ? text_sv : symbol(text_sv);
                 if (!is_keyword(id, syntax_t::OLD_PROPERTY)) {
@@ -658,7 +683,7 @@ namespace UTAP
                     xmlFree(text);
                     return res;
                 }
-                parser->handleError(TypeException{"$Keywords_are_not_allowed_here"});
+                parser->handleError("$Keywords_are_not_allowed_here");
             } catch (std::logic_error& str) {
                 parser->handleError(TypeException{str.what()});
             }
@@ -671,11 +696,10 @@ namespace UTAP
     {
         read();
         if (getNodeType() == XML_READER_TYPE_TEXT) {  // text content of a node
-            tracker.setPath(parser, path.get());
             xmlChar* text = xmlTextReaderValue(reader.get());
             const char* pc = (const char*)text;
             auto len = std::strlen(pc);
-            tracker.increment(parser, len);
+            locate(path.get(), len);
             try {
                 int value;
                 if (auto [p, ec] = std::from_chars(pc, pc + len, value); ec != std::errc{})
@@ -769,8 +793,7 @@ namespace UTAP
                  * element. To do this, we add a dummy position of
                  * length 1.
                  */
-                tracker.setPath(parser, l_path);
-                tracker.increment(parser, 1);
+                locate(l_path, 1);
 
                 /* Push location to parser builder. */
                 parser->procState(l_name.c_str(), l_invariant, l_exponentialRate);
@@ -799,8 +822,7 @@ namespace UTAP
                     throw TypeException{"Instance tag must have a unique \"id\" attribute"};
 
                 /* Get name of the instance. */
-                tracker.setPath(parser, i_path);
-                tracker.increment(parser, 1);
+                locate(i_path, 1);
                 std::string i_name = name(true);
 
                 /* Remember the mapping from id to name */
@@ -812,8 +834,7 @@ namespace UTAP
                  * instance line element. To do this, we add a dummy
                  * position of length 1.
                  */
-                tracker.setPath(parser, i_path);
-                tracker.increment(parser, 1);
+                locate(i_path, 1);
                 /* Push instance to parser builder. */
                 parser->procInstanceLine();
                 parse((xmlChar*)i_name.c_str(), S_INSTANCELINE);
@@ -854,9 +875,8 @@ namespace UTAP
                 read();
                 bottomPrechart = lscLocation();
                 if (strcasecmp(currentType.c_str(), "existential") == 0) {
-                    tracker.setPath(parser, p_path);
-                    tracker.increment(parser, 1);
-                    parser->handleError(TypeException{"$Existential_charts_must_not_have_prechart"});
+                    locate(p_path, 1);
+                    parser->handleError("$Existential_charts_must_not_have_prechart");
                 }
                 parser->hasPrechart(true);
             } catch (TypeException& e) {
@@ -881,11 +901,9 @@ namespace UTAP
                 std::string to = target();
                 int location = lscLocation();
                 bool pch = (location < bottomPrechart);
-                tracker.setPath(parser, m_path);
-                tracker.increment(parser, 1);
+                locate(m_path, 1);
                 parser->procMessage(from.c_str(), to.c_str(), location, pch);
-                tracker.setPath(parser, m_path);
-                tracker.increment(parser, 1);
+                locate(m_path, 1);
                 label(true, "message");
             } catch (TypeException& e) {
                 parser->handleError(e);
@@ -906,8 +924,7 @@ namespace UTAP
                 int location = lscLocation();
                 bool pch = (location < bottomPrechart);
 
-                tracker.setPath(parser, c_path);
-                tracker.increment(parser, 1);
+                locate(c_path, 1);
                 std::string temp = temperature();
                 bool hot = (temp == "hot");
                 parser->procCondition(instance_anchors, location, pch, hot);
@@ -933,8 +950,7 @@ namespace UTAP
                 int location = lscLocation();
                 bool pch = (location < bottomPrechart);
 
-                tracker.setPath(parser, u_path);
-                tracker.increment(parser, 1);
+                locate(u_path, 1);
                 parser->procLscUpdate(instance_anchor.c_str(), location, pch);
                 label(true, "update");
             } catch (TypeException& e) {
@@ -965,8 +981,7 @@ namespace UTAP
                  * element. To do this, we add a dummy position of
                  * length 1.
                  */
-                tracker.setPath(parser, b_path);
-                tracker.increment(parser, 1);
+                locate(b_path, 1);
                 /* Push branchpoint to parser builder. */
                 parser->procBranchpoint(b_name.c_str());
             } catch (TypeException& e) {
@@ -992,13 +1007,13 @@ namespace UTAP
                     parser->handleError(te);
                 }
             } else {
-                parser->handleError(TypeException{"$Missing_initial_location"});
+                parser->handleError("$Missing_initial_location");
             }
             xmlFree(ref);
             read();
             return true;
         } else {
-            parser->handleError(TypeException{"$Missing_initial_location"});
+            parser->handleError("$Missing_initial_location");
         }
         return false;
     }
@@ -1099,8 +1114,7 @@ namespace UTAP
 
                 /* Push template start to parser builder. This might
                  * throw a TypeException. */
-                tracker.setPath(parser, t_path);
-                tracker.increment(parser, 1);
+                locate(t_path, 1);
                 parser->procBegin(t_name.c_str());
 
                 /* Parse declarations, locations, branchpoints,
@@ -1110,15 +1124,13 @@ namespace UTAP
                     ;
                 while (branchpoint())
                     ;
-                tracker.setPath(parser, t_path);
-                tracker.increment(parser, 1);
+                locate(t_path, 1);
                 init();
                 while (transition())
                     ;
 
                 /* Push template end to parser builder. */
-                tracker.setPath(parser, t_path);
-                tracker.increment(parser, 1);
+                locate(t_path, 1);
                 parser->procEnd();
             } catch (TypeException& e) {
                 parser->handleError(e);
@@ -1143,8 +1155,7 @@ namespace UTAP
                 currentMode = mode();
                 /* Push template start to parser builder. This might
                  * throw a TypeException. */
-                tracker.setPath(parser, t_path);
-                tracker.increment(parser, 1);
+                locate(t_path, 1);
                 parser->procBegin(t_name.c_str(), false, currentType, currentMode);
 
                 /* Parse declarations, locations, instances, prechart
@@ -1163,8 +1174,7 @@ namespace UTAP
                     ;
 
                 /* Push template end to parser builder. */
-                tracker.setPath(parser, t_path);
-                tracker.increment(parser, 1);
+                locate(t_path, 1);
                 parser->procEnd();
             } catch (TypeException& e) {
                 parser->handleError(e);
@@ -1199,9 +1209,8 @@ namespace UTAP
             // bison doesn't manage to properly set the position of errors,
             // leading to nonsense error placements.
             if (nodeType == XML_READER_TYPE_END_ELEMENT || is_blank(text)) {
-                tracker.setPath(parser, path.get(tag_t::SYSTEM));
-                tracker.increment(parser, 1);
-                parser->handleError(TypeException{"$syntax_error: $unexpected $end"});
+                locate(path.get(tag_t::SYSTEM), 1);
+                parser->handleError("$syntax_error: $unexpected $end");
                 close(tag_t::SYSTEM);
                 return;
             }
@@ -1209,9 +1218,8 @@ namespace UTAP
             close(tag_t::SYSTEM);
         } else {
             std::string s = (nta) ? path.get(tag_t::NTA) : path.get(tag_t::PROJECT);
-            tracker.setPath(parser, s);
-            tracker.increment(parser, 1);
-            parser->handleError(TypeException{"$Missing_system_tag"});
+            locate(s, 1);
+            parser->handleError("$Missing_system_tag");
         }
     }
 
@@ -1361,28 +1369,68 @@ namespace UTAP
 
 using namespace UTAP;
 
-int32_t parseXMLFd(int fd, ParserBuilder* pb, bool newxta)
+static int readInput(void* context, char* buffer, int len)
 {
-    xmlTextReaderPtr reader =
-        xmlReaderForFd(fd, "", "", XML_PARSE_NOCDATA | XML_PARSE_NOBLANKS | XML_PARSE_HUGE | XML_PARSE_RECOVER);
+    return (*static_cast<read_function_t*>(context))(buffer, len);
+}
+
+/** Initialises libxml2 once, since XML parses run on several threads. */
+static void initXML()
+{
+    static const bool initialised = (xmlInitParser(), true);
+    (void)initialised;
+}
+
+/** Parses the (possibly compressed) input obtained from \a read. */
+static int32_t parseXMLInput(read_function_t read, const char* url, ParserBuilder* pb, bool newxta)
+{
+    initXML();
+    auto input = decompressInput(std::move(read));
+    xmlTextReaderPtr reader = xmlReaderForIO(readInput, nullptr, &input, url, "",
+                                             XML_PARSE_NOCDATA | XML_PARSE_NOBLANKS | XML_PARSE_HUGE |
+                                                 XML_PARSE_RECOVER);
     if (reader == nullptr)
         return -1;
     XMLReader(reader, pb, newxta).project();
     return 0;
 }
 
+int32_t parseXMLFd(int fd, ParserBuilder* pb, bool newxta)
+{
+    auto read = [fd](char* buffer, int len) -> int {
+        for (;;) {
+#ifdef _WIN32
+            const auto count = _read(fd, buffer, len);
+#else
+            const auto count = ::read(fd, buffer, len);
+#endif
+            if (count >= 0 || errno != EINTR)
+                return static_cast<int>(count);
+        }
+    };
+    return parseXMLInput(read, "", pb, newxta);
+}
+
 int32_t parseXMLFile(const char* filename, ParserBuilder* pb, bool newxta)
 {
-    xmlTextReaderPtr reader =
-        xmlReaderForFile(filename, "", XML_PARSE_NOCDATA | XML_PARSE_NOBLANKS | XML_PARSE_HUGE | XML_PARSE_RECOVER);
-    if (reader == nullptr)
+    auto file = std::unique_ptr<FILE, decltype(&fclose)>{fopen(filename, "rb"), &fclose};
+    if (file == nullptr)
         return -1;
-    XMLReader(reader, pb, newxta).project();
-    return 0;
+    auto read = [f = file.get()](char* buffer, int len) -> int {
+        const auto count = fread(buffer, 1, len, f);
+        return (count == 0 && ferror(f)) ? -1 : static_cast<int>(count);
+    };
+    return parseXMLInput(read, filename, pb, newxta);
+}
+
+int32_t parseXMLInput(const std::function<int(char*, int)>& read, ParserBuilder* pb, bool newxta)
+{
+    return parseXMLInput(read_function_t{read}, "", pb, newxta);
 }
 
 int32_t parseXMLBuffer(const char* buffer, ParserBuilder* pb, bool newxta)
 {
+    initXML();
     size_t length = strlen(buffer);
     xmlTextReaderPtr reader =
         xmlReaderForMemory(buffer, length, "", "", XML_PARSE_NOCDATA | XML_PARSE_HUGE | XML_PARSE_RECOVER);
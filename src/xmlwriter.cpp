@@ -317,7 +317,7 @@ void XMLWriter::taTempl(const template_t& templ)
     writeElement("declaration", declarations.c_str());
 
     // locations
-    std::deque<state_t>::const_iterator s_itr;
+    std::pmr::deque<state_t>::const_iterator s_itr;
     for (s_itr = templ.states.begin(); s_itr != templ.states.end(); ++s_itr) {
         location(*s_itr);
         selfLoops.insert(std::pair<int, int>(s_itr->locNr, 0));
@@ -325,7 +325,7 @@ void XMLWriter::taTempl(const template_t& templ)
     // initial location
     init(templ);
     // transitions
-    std::deque<edge_t>::const_iterator e_itr;
+    std::pmr::deque<edge_t>::const_iterator e_itr;
     for (e_itr = templ.edges.begin(); e_itr != templ.edges.end(); ++e_itr) {
         transition(*e_itr);
     }
@@ -334,10 +334,10 @@ void XMLWriter::taTempl(const template_t& templ)
 
 void XMLWriter::system_instantiation()
 {  // TODO proc priority
-    const std::list<instance_t>* instances = &(doc->getProcesses());
+    const std::pmr::list<instance_t>* instances = &(doc->getProcesses());
     string str = "";
     string proc = "";
-    std::list<instance_t>::const_iterator itr;
+    std::pmr::list<instance_t>::const_iterator itr;
     for (itr = instances->begin(); itr != instances->end(); ++itr) {
         if (itr->uid.getName() != itr->templ->uid.getName()) {
             str += itr->uid.getName() + " = " + itr->templ->uid.getName() + "(" + itr->writeArguments() + ");\n";
@@ -0,0 +1,148 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "benchmark.h"
+
+#include "utap/utap.h"
+
+#include <zlib.h>
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+/**
+ * Compares parsing a gzip compressed XML model directly with parsing
+ * the uncompressed model and with decompressing it to a temporary file
+ * first. The model is generated with the given number of templates or
+ * read from the given file.
+ *
+ * Usage: bench_compressed [TEMPLATES | MODEL.xml] [ITERATIONS]
+ */
+
+namespace fs = std::filesystem;
+
+static std::string model(int templates)
+{
+    auto os = std::ostringstream{};
+    os << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<nta>\n<declaration>const int N = 8;\n"
+       << "typedef int[0,N-1] id_t;\nint v[N];\nbool flag[N];\nchan c[N];\n</declaration>\n";
+    for (int k = 0; k < templates; ++k) {
+        os << "<template><name>P" << k << "</name><parameter>const id_t id</parameter>\n"
+           << "<declaration>clock x;\nint local = " << k % 5 << ";</declaration>\n";
+        for (int l = 0; l < 3; ++l) {
+            os << "<location id=\"id" << k << "_" << l << "\" x=\"" << 100 * l << "\" y=\"0\"><name>L" << l
+               << "</name><label kind=\"invariant\">x &lt;= " << 10 - l << "</label></location>\n";
+        }
+        os << "<init ref=\"id" << k << "_0\"/>\n";
+        for (int l = 0; l < 3; ++l) {
+            os << "<transition><source ref=\"id" << k << "_" << l << "\"/><target ref=\"id" << k << "_"
+               << (l + 1) % 3 << "\"/>\n"
+               << "<label kind=\"guard\">v[id] &lt; " << l + 5 << " &amp;&amp; x &gt;= 2 &amp;&amp; !flag[id]</label>\n"
+               << "<label kind=\"synchronisation\">c[id]" << (l % 2 ? '?' : '!') << "</label>\n"
+               << "<label kind=\"assignment\">x = 0, local = (local + 1) % 10, v[id] = (v[id] + 1) % 7</label>\n"
+               << "</transition>\n";
+        }
+        os << "</template>\n";
+    }
+    os << "<system>system ";
+    for (int k = 0; k < templates; ++k)
+        os << (k ? ", P" : "P") << k;
+    os << ";</system>\n</nta>\n";
+    return os.str();
+}
+
+static bool compress(const fs::path& from, const fs::path& to)
+{
+    const auto data = bench::read_file(from.string());
+    auto* file = gzopen(to.string().c_str(), "wb");
+    if (file == nullptr)
+        return false;
+    const auto written = gzwrite(file, data.data(), data.size());
+    return gzclose(file) == Z_OK && written == static_cast<int>(data.size());
+}
+
+static bool decompress(const fs::path& from, const fs::path& to)
+{
+    auto* file = gzopen(from.string().c_str(), "rb");
+    if (file == nullptr)
+        return false;
+    auto out = std::ofstream{to, std::ios::binary};
+    auto buffer = std::vector<char>(64 * 1024);
+    int count;
+    while ((count = gzread(file, buffer.data(), buffer.size())) > 0)
+        out.write(buffer.data(), count);
+    return gzclose(file) == Z_OK && count == 0 && out.good();
+}
+
+static double parse(const fs::path& file)
+{
+    auto doc = std::make_unique<UTAP::Document>();
+    const auto start = bench::clock_type::now();
+    parseXMLFile(file.string().c_str(), doc.get(), true);
+    const auto ms = bench::elapsed_ms(start);
+    if (doc->hasErrors() || doc->getTemplates().empty()) {
+        std::cerr << "Failed to parse " << file << std::endl;
+        std::exit(2);
+    }
+    return ms;
+}
+
+int main(int argc, char* argv[])
+{
+    const auto dir = fs::temp_directory_path();
+    const auto raw = dir / "utap_bench_compressed.xml";
+    const auto gz = dir / "utap_bench_compressed.xml.gz";
+    const auto tmp = dir / "utap_bench_decompressed.xml";
+    const auto iterations = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    if (argc > 1 && bench::is_xml(argv[1])) {
+        fs::copy_file(argv[1], raw, fs::copy_options::overwrite_existing);
+    } else {
+        std::ofstream{raw, std::ios::binary} << model(argc > 1 ? std::atoi(argv[1]) : 5000);
+    }
+    if (!compress(raw, gz)) {
+        std::cerr << "Failed to compress the model" << std::endl;
+        return 2;
+    }
+
+    auto plain = 0.0, direct = 0.0, staged = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        plain += parse(raw);
+        direct += parse(gz);
+        const auto start = bench::clock_type::now();
+        if (!decompress(gz, tmp))
+            return 2;
+        staged += bench::elapsed_ms(start) + parse(tmp);
+    }
+    std::cout << "model: " << fs::file_size(raw) << " bytes, compressed " << fs::file_size(gz) << " bytes\n"
+              << "uncompressed: " << plain / iterations << " ms/document\n"
+              << "gzip, streamed: " << direct / iterations << " ms/document\n"
+              << "gzip, via temporary file: " << staged / iterations << " ms/document" << std::endl;
+    fs::remove(raw);
+    fs::remove(gz);
+    fs::remove(tmp);
+    return 0;
+}
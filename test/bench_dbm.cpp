@@ -0,0 +1,107 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "benchmark.h"
+
+#include "utap/dbm.h"
+
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <vector>
+#include <cstdlib>
+
+/**
+ * Measures the DBM operations with the scalar and the AVX2 kernels over
+ * the dimensions 2 to 64: the closure of a matrix of random constraints,
+ * adding constraints to a closed matrix, and the inclusion check of two
+ * zones.
+ *
+ * Usage: bench_dbm [ITERATIONS]
+ */
+
+using UTAP::DBM;
+
+using constraints_t = std::vector<std::tuple<uint32_t, uint32_t, DBM::raw_t>>;
+
+/** Constraints which are satisfied by the valuation x_i = i. */
+static constraints_t constraints(uint32_t dimension, std::mt19937& rng)
+{
+    auto pick = std::uniform_int_distribution<uint32_t>{0, dimension - 1};
+    auto slack = std::uniform_int_distribution<int32_t>{0, 100};
+    auto result = constraints_t{};
+    for (uint32_t n = 0; n < 2 * dimension; ++n) {
+        const auto i = pick(rng), j = pick(rng);
+        if (i != j)
+            result.emplace_back(i, j, DBM::bound(int32_t(i) - int32_t(j) + slack(rng), false));
+    }
+    return result;
+}
+
+static DBM zone(uint32_t dimension, const constraints_t& constraints, bool close)
+{
+    auto zone = DBM::createUnbounded(dimension);
+    for (const auto& [i, j, bound] : constraints)
+        zone.constrain(i, j, bound, close);
+    return zone;
+}
+
+int main(int argc, char* argv[])
+{
+    const auto iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+    auto kernels = std::vector<DBM::kernel_t>{DBM::SCALAR};
+    if (DBM::isSupported(DBM::AVX2))
+        kernels.push_back(DBM::AVX2);
+
+    auto rng = std::mt19937{1};
+    for (const auto dimension : {2u, 4u, 8u, 16u, 24u, 32u, 48u, 64u}) {
+        const auto cs = constraints(dimension, rng);
+        const auto open = zone(dimension, cs, false);
+        auto larger = zone(dimension, {cs.begin(), cs.begin() + cs.size() / 2}, true);
+        for (const auto kernel : kernels) {
+            DBM::setKernel(kernel);
+            auto start = bench::clock_type::now();
+            for (int n = 0; n < iterations; ++n) {
+                auto copy = open;
+                copy.close();
+            }
+            const auto close = bench::elapsed_ms(start) * 1e3 / iterations;
+
+            start = bench::clock_type::now();
+            for (int n = 0; n < iterations; ++n)
+                zone(dimension, cs, true);
+            const auto constrain = bench::elapsed_ms(start) * 1e3 / iterations / cs.size();
+
+            auto closed = zone(dimension, cs, true);
+            auto included = 0;
+            start = bench::clock_type::now();
+            for (int n = 0; n < iterations; ++n)
+                included += closed.isSubsetOf(larger);
+            const auto subset = bench::elapsed_ms(start) * 1e3 / iterations;
+
+            std::cout << "dimension " << dimension << ", " << (kernel == DBM::AVX2 ? "avx2" : "scalar")
+                      << ": close " << close << " us, constrain " << constrain << " us, inclusion " << subset
+                      << " us" << (included == iterations ? "" : " (not included)") << std::endl;
+        }
+    }
+    return 0;
+}
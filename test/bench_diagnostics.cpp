@@ -0,0 +1,100 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "benchmark.h"
+
+#include "utap/utap.h"
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+
+/**
+ * Measures the cost of reporting warnings: the model is an XML document
+ * whose functions consist of statements without effect, thus type
+ * checking issues a warning for every statement. Recording the same
+ * number of warnings directly in a document is timed separately, once
+ * by message id like the type checker and once as formatted messages.
+ *
+ * Usage: bench_diagnostics [WARNINGS] [ITERATIONS]
+ */
+
+static std::string model(int warnings)
+{
+    auto os = std::ostringstream{};
+    os << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<nta>\n<declaration>int x;\n";
+    for (int i = 0; i < warnings; ++i) {
+        if (i % 100 == 0)
+            os << (i > 0 ? "}\n" : "") << "void f" << i << "() {\n";
+        os << "    x == " << i << ";\n";
+    }
+    if (warnings > 0)
+        os << "}\n";
+    os << "</declaration>\n<template><name>P</name><location id=\"id0\"/><init ref=\"id0\"/></template>\n"
+       << "<system>system P;</system>\n</nta>\n";
+    return os.str();
+}
+
+int main(int argc, char* argv[])
+{
+    const auto count = argc > 1 ? std::atoi(argv[1]) : 50000;
+    const auto iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+    const auto xml = model(count);
+
+    auto parsing = 0.0;
+    auto rendering = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        auto doc = std::make_unique<UTAP::Document>();
+        auto start = bench::clock_type::now();
+        parseXMLBuffer(xml.c_str(), doc.get(), true);
+        parsing += bench::elapsed_ms(start);
+        start = bench::clock_type::now();
+        const auto& warnings = doc->getWarnings();
+        rendering += bench::elapsed_ms(start);
+        if (doc->hasErrors() || warnings.size() != static_cast<size_t>(count)) {
+            std::cerr << "Unexpected diagnostics: " << doc->getErrors().size() << " errors, " << warnings.size()
+                      << " warnings" << std::endl;
+            return 2;
+        }
+    }
+    auto byId = 0.0;
+    auto formatted = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        auto doc = UTAP::Document{};
+        auto start = bench::clock_type::now();
+        for (int w = 0; w < count; ++w)
+            doc.addWarning({}, "$Expression_does_not_have_any_effect", {}, "(typechecking)");
+        byId += bench::elapsed_ms(start);
+        doc.clearWarnings();
+        start = bench::clock_type::now();
+        for (int w = 0; w < count; ++w)
+            doc.addWarning({}, std::string{"$Expression_does_not_have_any_effect"}, "(typechecking)");
+        formatted += bench::elapsed_ms(start);
+    }
+    std::cout << "parsing and type checking: " << parsing / iterations << " ms/document\n"
+              << "rendering " << count << " warnings: " << rendering / iterations << " ms/document\n"
+              << "recording " << count << " warnings by message id: " << byId / iterations << " ms/document\n"
+              << "recording " << count << " formatted warnings: " << formatted / iterations << " ms/document"
+              << std::endl;
+    return 0;
+}
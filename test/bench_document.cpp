@@ -0,0 +1,95 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/utap.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+
+/**
+ * Benchmark of build-and-destroy cycles of documents: parses the same
+ * model repeatedly using the global heap, a pool resource and a
+ * monotonic arena which is released after each document.
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+template <typename Setup>
+static double run(const std::string& xml, int iterations, Setup&& resource_for)
+{
+    auto start = clock_type::now();
+    for (int i = 0; i < iterations; ++i) {
+        std::pmr::memory_resource* resource = resource_for(i);
+        {
+            UTAP::Document doc{resource};
+            parseXMLBuffer(xml.c_str(), &doc, true);
+            if (doc.hasErrors()) {
+                std::cerr << "model has errors" << std::endl;
+                std::exit(2);
+            }
+        }
+    }
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+static void report(const char* name, double ms, int iterations)
+{
+    std::cout << name << ": " << ms << " ms total, " << (ms * 1000.0 / iterations) << " us/document" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " MODEL.xml [ITERATIONS]\n";
+        return 1;
+    }
+    auto file = std::ifstream{argv[1]};
+    if (!file) {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    auto buffer = std::ostringstream{};
+    buffer << file.rdbuf();
+    const auto xml = buffer.str();
+    const int iterations = (argc == 3) ? std::atoi(argv[2]) : 1000;
+
+    run(xml, 10, [](int) { return std::pmr::get_default_resource(); });  // warm up
+
+    auto heap = run(xml, iterations, [](int) { return std::pmr::get_default_resource(); });
+    report("global heap", heap, iterations);
+
+    auto pool = std::pmr::unsynchronized_pool_resource{};
+    auto pooled = run(xml, iterations, [&pool](int) { return &pool; });
+    report("pool resource", pooled, iterations);
+
+    auto arena = std::pmr::monotonic_buffer_resource{1 << 20};
+    auto monotonic = run(xml, iterations, [&arena](int) {
+        arena.release();  // drops the previous document in O(1)
+        return &arena;
+    });
+    report("monotonic arena", monotonic, iterations);
+    return 0;
+}
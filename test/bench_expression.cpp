@@ -0,0 +1,112 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "benchmark.h"
+
+#include "utap/DocumentBuilder.hpp"
+#include "utap/expression.h"
+#include "utap/utap.h"
+
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+/**
+ * Reports the heap footprint of expression nodes: bytes and heap
+ * allocations per node for leaves, unary, binary, ternary and n-ary
+ * nodes, and the live heap of a parsed document.
+ *
+ * Usage: bench_expression [MODEL | -s TEMPLATES]
+ */
+
+static size_t allocated_bytes = 0;
+static size_t allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    allocated_bytes += size;
+    ++allocations;
+    if (auto* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace UTAP;
+using namespace UTAP::Constants;
+
+template <typename Make>
+static void report(const char* shape, Make&& make)
+{
+    constexpr size_t count = 100000;
+    auto nodes = std::vector<expression_t>{};
+    nodes.reserve(count);
+    const auto bytes = allocated_bytes;
+    const auto allocs = allocations;
+    for (size_t i = 0; i < count; ++i)
+        nodes.push_back(make());
+    std::cout << shape << ": " << double(allocated_bytes - bytes) / count << " bytes/node, "
+              << double(allocations - allocs) / count << " allocations/node\n";
+}
+
+int main(int argc, char* argv[])
+{
+    auto model = std::string{};
+    auto xml = false;
+    if (argc == 3 && std::string{argv[1]} == "-s") {
+        model = bench::synthetic_model(std::atoi(argv[2]));
+    } else if (argc == 2) {
+        model = bench::read_file(argv[1]);
+        xml = bench::is_xml(argv[1]);
+    } else if (argc == 1) {
+        model = bench::synthetic_model(100);
+    } else {
+        std::cerr << "Usage: " << argv[0] << " [MODEL | -s TEMPLATES]\n";
+        return 1;
+    }
+
+    // the children are shared, thus only the new node is accounted for
+    const auto leaf = expression_t::createConstant(1);
+    report("leaf", [] { return expression_t::createIdentifier(symbol_t{}); });
+    report("unary", [&] { return expression_t::createUnary(UNARY_MINUS, leaf); });
+    report("binary", [&] { return expression_t::createBinary(PLUS, leaf, leaf); });
+    report("ternary", [&] { return expression_t::createTernary(INLINEIF, leaf, leaf, leaf); });
+    report("5-ary", [&] { return expression_t::createNary(LIST, {leaf, leaf, leaf, leaf, leaf}); });
+
+    const auto bytes = allocated_bytes;
+    const auto allocs = allocations;
+    {
+        auto doc = std::make_unique<Document>();
+        auto builder = DocumentBuilder{*doc};
+        if (xml) {
+            parseXMLBuffer(model.c_str(), &builder, true);
+        } else {
+            parseXTA(model.c_str(), &builder, true);
+        }
+        std::cout << "document: " << (allocated_bytes - bytes) / 1024 << " KiB allocated in "
+                  << allocations - allocs << " allocations" << std::endl;
+    }
+    return 0;
+}
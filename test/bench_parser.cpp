@@ -0,0 +1,110 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "benchmark.h"
+
+#include "utap/DocumentBuilder.hpp"
+#include "utap/utap.h"
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+
+/**
+ * Measures the lexer and parser throughput on a large block of global
+ * declarations (or on the given model), including the construction of
+ * the document but not the type checking, with and without recording
+ * the position of every line.
+ *
+ * Usage: bench_parser [MODEL | -d DECLARATIONS] [ITERATIONS]
+ */
+
+/** Generates \a count variable declarations and a function using them. */
+static std::string declarations(int count)
+{
+    auto os = std::ostringstream{};
+    os << "const int N = 16;\n"
+       << "typedef struct { int[0,N] level; bool active; } record_t;\n";
+    for (int i = 0; i < count; ++i) {
+        os << "int[-1000,1000] counter_variable_" << i << " = " << i % 1000 << ";\n"
+           << "record_t record_variable_" << i << " = { " << i % 16 << ", " << (i % 2 ? "true" : "false") << " };\n"
+           << "bool flag_variable_" << i << "[N];\n";
+        if (i % 16 == 15) {
+            os << "int update_" << i << "(int bound) {\n"
+               << "    int local_sum = 0;\n"
+               << "    for (i : int[0,N-1]) { local_sum += counter_variable_" << i << " * i; }\n"
+               << "    if (local_sum > bound && record_variable_" << i << ".active) { local_sum = bound; }\n"
+               << "    return local_sum;\n"
+               << "}\n";
+        }
+    }
+    os << "process P() { state A; init A; }\nsystem P;\n";
+    return os.str();
+}
+
+int main(int argc, char* argv[])
+{
+    auto model = std::string{};
+    auto xml = false;
+    auto iterations = 10;
+    if (argc >= 3 && std::string{argv[1]} == "-d") {
+        model = declarations(std::atoi(argv[2]));
+        if (argc > 3)
+            iterations = std::atoi(argv[3]);
+    } else if (argc == 2 || argc == 3) {
+        model = bench::read_file(argv[1]);
+        xml = bench::is_xml(argv[1]);
+        if (argc > 2)
+            iterations = std::atoi(argv[2]);
+    } else if (argc == 1) {
+        model = declarations(20000);
+    } else {
+        std::cerr << "Usage: " << argv[0] << " [MODEL | -d DECLARATIONS] [ITERATIONS]\n";
+        return 1;
+    }
+
+    for (const auto tracking : {true, false}) {
+        auto total = 0.0;
+        for (int i = 0; i < iterations; ++i) {
+            auto doc = std::make_unique<UTAP::Document>();
+            doc->setLineTracking(tracking);
+            auto builder = UTAP::DocumentBuilder{*doc};
+            const auto start = bench::clock_type::now();
+            if (xml) {
+                parseXMLBuffer(model.c_str(), &builder, true);
+            } else {
+                parseXTA(model.c_str(), &builder, true);
+            }
+            total += bench::elapsed_ms(start);
+            if (doc->hasErrors()) {
+                for (const auto& err : doc->getErrors())
+                    std::cerr << err << std::endl;
+                return 2;
+            }
+        }
+        const auto ms = total / iterations;
+        std::cout << "parsing " << (tracking ? "with" : "without") << " line tracking: " << ms << " ms/document, "
+                  << model.size() / ms / 1000 << " MB/s" << std::endl;
+    }
+    return 0;
+}
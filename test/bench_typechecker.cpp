@@ -0,0 +1,98 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "benchmark.h"
+
+#include "utap/DocumentBuilder.hpp"
+#include "utap/typechecker.h"
+#include "utap/utap.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+/**
+ * Measures the time spent in the TypeChecker, excluding parsing, and
+ * the number of reference count updates of the AST handles (only
+ * reported when the library is compiled with UTAP_REFCOUNT_STATISTICS).
+ *
+ * Usage: bench_typechecker [MODEL | -s TEMPLATES | -p TEMPLATES] [ITERATIONS]
+ *
+ * With -s a synthetic model is generated, and with -p a model with
+ * heavily parameterised templates sharing their typedefs.
+ */
+
+static std::unique_ptr<UTAP::Document> build(const std::string& model, bool xml)
+{
+    auto doc = std::make_unique<UTAP::Document>();
+    auto builder = UTAP::DocumentBuilder{*doc};
+    if (xml) {
+        parseXMLBuffer(model.c_str(), &builder, true);
+    } else {
+        parseXTA(model.c_str(), &builder, true);
+    }
+    if (doc->hasErrors()) {
+        for (const auto& err : doc->getErrors())
+            std::cerr << err << std::endl;
+        std::exit(2);
+    }
+    return doc;
+}
+
+int main(int argc, char* argv[])
+{
+    auto model = std::string{};
+    auto xml = false;
+    auto iterations = 20;
+    if (argc >= 3 && (std::string{argv[1]} == "-s" || std::string{argv[1]} == "-p")) {
+        const auto templates = std::atoi(argv[2]);
+        model = argv[1][1] == 's' ? bench::synthetic_model(templates) : bench::parameterised_model(templates);
+        if (argc > 3)
+            iterations = std::atoi(argv[3]);
+    } else if (argc == 2 || argc == 3) {
+        model = bench::read_file(argv[1]);
+        xml = bench::is_xml(argv[1]);
+        if (argc > 2)
+            iterations = std::atoi(argv[2]);
+    } else {
+        std::cerr << "Usage: " << argv[0] << " [MODEL | -s TEMPLATES | -p TEMPLATES] [ITERATIONS]\n";
+        return 1;
+    }
+
+    auto total = 0.0;
+    auto updates = uint64_t{0};
+    for (int i = 0; i < iterations; ++i) {
+        auto doc = build(model, xml);
+        const auto before = UTAP::counted_t::updates();
+        const auto start = bench::clock_type::now();
+        UTAP::TypeChecker checker{*doc};
+        doc->accept(checker);
+        total += bench::elapsed_ms(start);
+        updates += UTAP::counted_t::updates() - before;
+    }
+    std::cout << "type checking: " << total / iterations << " ms/document";
+    if (updates > 0)
+        std::cout << ", " << updates / iterations << " reference count updates/document";
+    std::cout << std::endl;
+    return 0;
+}
@@ -0,0 +1,144 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_TEST_BENCHMARK_H
+#define UTAP_TEST_BENCHMARK_H
+
+/* Helpers shared by the bench_* programs. */
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace bench
+{
+    using clock_type = std::chrono::steady_clock;
+
+    /** Milliseconds elapsed since \a start. */
+    inline double elapsed_ms(clock_type::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+    }
+
+    inline std::string read_file(const std::string& path)
+    {
+        auto file = std::ifstream{path, std::ios::binary};
+        if (!file)
+            throw std::runtime_error("Cannot open " + path);
+        auto buffer = std::ostringstream{};
+        buffer << file.rdbuf();
+        return buffer.str();
+    }
+
+    /** Returns true if \a path names an XML model (as opposed to XTA). */
+    inline bool is_xml(const std::string& path)
+    {
+        return path.size() > 4 && path.compare(path.size() - 4, 4, ".xml") == 0;
+    }
+
+    /**
+     * Generates an XTA model (new syntax) with \a templates templates,
+     * each instantiated \a width times. The templates use arrays,
+     * functions, selects, channel arrays, clocks and invariants so
+     * that all parts of the parser and the type checker are exercised.
+     */
+    inline std::string synthetic_model(int templates, int width = 8)
+    {
+        auto os = std::ostringstream{};
+        os << "const int N = " << width << ";\n"
+           << "typedef int[0,N-1] id_t;\n"
+           << "int v[N];\n"
+           << "bool flag[N];\n"
+           << "clock t[N];\n"
+           << "chan c[N];\n"
+           << "int add(int a, int b) { return a + b; }\n"
+           << "bool differs(int a, int b) { return a > b && v[b % N] != a; }\n"
+           << "void step(id_t i) { v[i] = (v[i] + 1) % 7; flag[i] = !flag[i]; }\n";
+        for (int k = 0; k < templates; ++k) {
+            os << "process P" << k << "(const id_t id) {\n"
+               << "  clock x;\n"
+               << "  int local = " << k % 5 << ";\n"
+               << "  int[0,10] bounded[3];\n"
+               << "  state L0 { x <= 10 }, L1 { x <= 5 }, L2;\n"
+               << "  init L0;\n"
+               << "  trans\n"
+               << "    L0 -> L1 { guard v[id] < 5 && x >= 2 && !flag[id]; sync c[id]!; assign step(id), x = 0; },\n"
+               << "    L1 -> L2 { guard add(v[id], local) > 1 || t[id] > 3; assign local = (local + 1) % 10; },\n"
+               << "    L1 -> L0 { guard differs(v[(id + 1) % N], local) && x < 4;"
+               << " assign bounded[local % 3] = local, x = 0; },\n"
+               << "    L2 -> L0 { select j : id_t; guard v[j] != v[id]; sync c[j]?; assign v[j] = v[id], x = 0; };\n"
+               << "}\n";
+        }
+        os << "system ";
+        for (int k = 0; k < templates; ++k)
+            os << (k ? ", P" : "P") << k;
+        os << ";\n";
+        return os.str();
+    }
+
+    /**
+     * Generates an XTA model of \a templates templates with many
+     * parameters of shared typedefs, whose range bounds are compound
+     * constant expressions, instantiated through chains of \a depth
+     * partial instances. Every use of a typedef refers to the same
+     * bound expressions, so the type checker meets the same subtrees
+     * along many paths.
+     */
+    inline std::string parameterised_model(int templates, int depth = 4)
+    {
+        auto os = std::ostringstream{};
+        os << "const int N = 8;\n"
+           << "const int M = 3;\n"
+           << "const int K[4] = { 1, 2, 3, 4 };\n"
+           << "typedef int[0, (N * M + K[1] * K[2]) / 2 - K[0]] index_t;\n"
+           << "typedef int[-(N * M) / (K[3] - K[2]), (N * M) * (K[3] + K[0]) / M] level_t;\n"
+           << "typedef struct { index_t first; level_t second[(N + M) % 5 + 2]; } pair_t;\n"
+           << "typedef pair_t row_t[(N - M) % 4 + 2];\n"
+           << "row_t table[N];\n";
+        for (int k = 0; k < templates; ++k) {
+            os << "process T" << k << "(const index_t a, const index_t b, const level_t c, const level_t d, "
+               << "row_t &row, pair_t &p, const pair_t q) {\n"
+               << "  index_t i = a;\n"
+               << "  level_t l = c;\n"
+               << "  pair_t local[(N + M) % 3 + 1];\n"
+               << "  state A, B;\n"
+               << "  init A;\n"
+               << "  trans\n"
+               << "    A -> B { select s : index_t; guard s != b && l < d; assign i = s, p.first = i; },\n"
+               << "    B -> A { guard q.second[0] <= c; assign row[0].second[1] = l, local[0] = p; };\n"
+               << "}\n"
+               << "I" << k << "_0(const index_t a) = T" << k << "(a, (a + 1) % N, a - N, a + N, table[a % N], "
+               << "table[(a + 1) % N][0], table[0][1]);\n";
+            for (int level = 1; level < depth; ++level)
+                os << "I" << k << '_' << level << "(const index_t a) = I" << k << '_' << level - 1 << "((a * M + "
+                   << level << ") % N);\n";
+        }
+        os << "system ";
+        for (int k = 0; k < templates; ++k)
+            os << (k ? ", I" : "I") << k << '_' << depth - 1;
+        os << ";\n";
+        return os.str();
+    }
+}  // namespace bench
+
+#endif /* UTAP_TEST_BENCHMARK_H */
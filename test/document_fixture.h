@@ -0,0 +1,41 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#ifndef UTAP_TEST_DOCUMENT_FIXTURE_H
+#define UTAP_TEST_DOCUMENT_FIXTURE_H
+
+/* Helpers shared by the test_* programs. Include it after doctest. */
+
+#include "utap/utap.h"
+
+#include <memory>
+#include <string>
+
+/** Parses the XTA model \a text in the new syntax and requires it to have no errors. */
+inline std::unique_ptr<UTAP::Document> parse_document(const std::string& text)
+{
+    auto doc = std::make_unique<UTAP::Document>();
+    parseXTA(text.c_str(), doc.get(), true);
+    REQUIRE(!doc->hasErrors());
+    return doc;
+}
+
+#endif /* UTAP_TEST_DOCUMENT_FIXTURE_H */
@@ -44,7 +44,11 @@ int main(int argc, char* argv[])
         Document system;
         auto name = std::string{argv[argc - 1]};
 
-        if (name.substr(name.length() - 4) == ".xml") {
+        const auto ends_with = [&name](const std::string& suffix) {
+            return name.size() >= suffix.size() &&
+                   name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+        };
+        if (ends_with(".xml") || ends_with(".xml.gz") || ends_with(".xml.zst")) {
             parseXMLFile(name.c_str(), &system, !old);
         } else {
             FILE* file = fopen(name.c_str(), "r");
@@ -0,0 +1,217 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/asyncparse.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace UTAP;
+
+static const auto model_path = std::filesystem::path{MODELS_DIR} / "simpleHandshakeSystem.xml";
+
+TEST_CASE("Asynchronous parsing reports its progress")
+{
+    auto reports = std::vector<parse_progress_t>{};
+    auto options = parse_options_t{};
+    options.progress = [&reports](const parse_progress_t& progress) { reports.push_back(progress); };
+    auto document = parseXMLFileAsync(model_path, options).get();
+    REQUIRE(document);
+    CHECK(!document->hasErrors());
+    CHECK(document->getTemplates().size() == 2);
+
+    REQUIRE(reports.size() >= 4);
+    CHECK(reports.front().phase == parse_progress_t::PARSING);
+    CHECK(reports.front().bytes == 0);
+    const auto size = std::filesystem::file_size(model_path);
+    CHECK(reports.back().phase == parse_progress_t::DONE);
+    CHECK(reports.back().bytes == size);
+    CHECK(reports.back().total == size);
+    CHECK(reports.back().templates == 2);
+    CHECK(reports[reports.size() - 2].phase == parse_progress_t::TYPE_CHECKING);
+    for (size_t i = 1; i < reports.size(); ++i) {
+        CHECK(reports[i - 1].bytes <= reports[i].bytes);
+        CHECK(reports[i - 1].phase <= reports[i].phase);
+    }
+}
+
+TEST_CASE("Asynchronous parsing gives the same document")
+{
+    auto expected = Document{};
+    REQUIRE(parseXMLFile(model_path.string().c_str(), &expected, true) == 0);
+    auto os = std::ostringstream{};
+    os << std::ifstream{model_path}.rdbuf();
+    auto document = parseXMLBufferAsync(os.str()).get();
+    CHECK(document->getGlobals().variables.size() == expected.getGlobals().variables.size());
+    REQUIRE(document->getTemplates().size() == expected.getTemplates().size());
+    auto templ = document->getTemplates().begin();
+    for (const auto& other : expected.getTemplates()) {
+        CHECK(templ->uid.getName() == other.uid.getName());
+        CHECK(templ->states.size() == other.states.size());
+        CHECK(templ->edges.size() == other.edges.size());
+        ++templ;
+    }
+    CHECK(document->getProcesses().size() == expected.getProcesses().size());
+}
+
+TEST_CASE("Asynchronous parsing on an executor")
+{
+    auto threads = std::vector<std::thread>{};
+    auto options = parse_options_t{};
+    options.executor = [&threads](std::function<void()> task) { threads.emplace_back(std::move(task)); };
+    auto first = parseXMLFileAsync(model_path, options);
+    auto second = parseXMLFileAsync(model_path, options);
+    CHECK(threads.size() == 2);
+    CHECK(first.get()->getTemplates().size() == 2);
+    CHECK(second.get()->getTemplates().size() == 2);
+    for (auto& thread : threads)
+        thread.join();
+
+    auto missing = parseXMLFileAsync(std::filesystem::path{MODELS_DIR} / "missing.xml");
+    CHECK_THROWS_AS(missing.get(), std::runtime_error);
+}
+
+TEST_CASE("Synchronous parses take turns with asynchronous ones")
+{
+    auto futures = std::vector<std::future<std::unique_ptr<Document>>>{};
+    for (int i = 0; i < 4; ++i)
+        futures.push_back(parseXMLFileAsync(model_path));
+    for (int i = 0; i < 4; ++i) {
+        auto document = Document{};
+        REQUIRE(parseXMLFile(model_path.string().c_str(), &document, true) == 0);
+        CHECK(!document.hasErrors());
+        CHECK(document.getTemplates().size() == 2);
+    }
+    for (auto& future : futures) {
+        const auto document = future.get();
+        CHECK(!document->hasErrors());
+        CHECK(document->getTemplates().size() == 2);
+    }
+}
+
+TEST_CASE("Parse sessions build templates as the chunks arrive")
+{
+    auto os = std::ostringstream{};
+    os << std::ifstream{model_path}.rdbuf();
+    const auto model = os.str();
+    const auto end = model.find("</template>") + std::string{"</template>"}.size();
+    REQUIRE(end < model.find("</template>", end));
+
+    auto mutex = std::mutex{};
+    auto parsed = std::condition_variable{};
+    auto templates = size_t{0};
+    auto options = parse_options_t{};
+    options.progress = [&](const parse_progress_t& progress) {
+        auto lock = std::lock_guard{mutex};
+        templates = progress.templates;
+        parsed.notify_all();
+    };
+    auto session = ParseSession{options, 16};
+    for (size_t i = 0; i < end; i += 7)
+        session.feed(std::string_view{model}.substr(i, std::min<size_t>(7, end - i)));
+    session.feed(std::string_view{model}.substr(end, 100));
+    {
+        // the first template is built before the rest of the model is fed
+        auto lock = std::unique_lock{mutex};
+        CHECK(parsed.wait_for(lock, std::chrono::seconds{10}, [&] { return templates == 1; }));
+    }
+    session.feed(std::string_view{model}.substr(end + 100));
+    auto document = session.finish();
+    CHECK(!document->hasErrors());
+    CHECK(document->getTemplates().size() == 2);
+    CHECK(document->getProcesses().size() == 2);
+}
+
+TEST_CASE("Parse sessions fed alternately from one thread")
+{
+    auto os = std::ostringstream{};
+    os << std::ifstream{model_path}.rdbuf();
+    const auto model = os.str();
+    auto first = ParseSession{{}, 16};
+    auto second = ParseSession{{}, 16};
+    for (size_t i = 0; i < model.size(); i += 7) {
+        // the sessions parse at once, thus feeding one never waits for the other
+        first.feed(std::string_view{model}.substr(i, 7));
+        second.feed(std::string_view{model}.substr(i, 7));
+    }
+    const auto a = first.finish();
+    const auto b = second.finish();
+    CHECK(!a->hasErrors());
+    CHECK(!b->hasErrors());
+    CHECK(a->getTemplates().size() == 2);
+    CHECK(b->getTemplates().size() == 2);
+}
+
+TEST_CASE("Abandoned parse sessions stop")
+{
+    auto session = ParseSession{};
+    session.feed("<?xml version=\"1.0\" encoding=\"utf-8\"?><nta><declaration>int x;</declaration>");
+}
+
+TEST_CASE("Parse sessions finish in any order")
+{
+    auto os = std::ostringstream{};
+    os << std::ifstream{model_path}.rdbuf();
+    const auto model = os.str();
+    auto first = ParseSession{{}, 16};
+    first.feed(std::string_view{model}.substr(0, 100));
+    {
+        // the input of the later session stays bounded while the first one is open
+        auto second = ParseSession{{}, 16};
+        for (size_t i = 0; i < model.size(); i += 7)
+            second.feed(std::string_view{model}.substr(i, 7));
+        const auto document = second.finish();
+        CHECK(!document->hasErrors());
+        CHECK(document->getTemplates().size() == 2);
+    }
+    auto document = Document{};
+    REQUIRE(parseXMLFile(model_path.string().c_str(), &document, true) == 0);
+    CHECK(document.getTemplates().size() == 2);
+    first.feed(std::string_view{model}.substr(100));
+    const auto a = first.finish();
+    CHECK(!a->hasErrors());
+    CHECK(a->getTemplates().size() == 2);
+}
+
+TEST_CASE("Unfinished parse sessions are abandoned in reverse order")
+{
+    const auto start = "<?xml version=\"1.0\" encoding=\"utf-8\"?><nta><declaration>int x;</declaration>";
+    auto unwind = [&] {
+        auto first = ParseSession{};
+        auto second = ParseSession{};
+        first.feed(start);
+        second.feed(start);
+        throw std::runtime_error{"connection lost"};
+    };
+    CHECK_THROWS_AS(unwind(), std::runtime_error);
+}
@@ -0,0 +1,162 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/callgraph.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "document_fixture.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace UTAP;
+
+static const char* model = R"(
+int a, b, c;
+int r[3];
+int get() { return a; }
+void setB() { b = 1; }
+void incC() { c++; }
+void both() { setB(); b = get() + b; }
+int twice() { return 2 * get(); }
+void reset(int &x) { x = 0; }
+void bump(int &x) { x = x + 1; }
+void store(int i) { r[i] = a; }
+double draw() { return random(3.0); }
+process P() {
+  int local;
+  void touch() { local = get(); reset(c); }
+  state A;
+  init A;
+}
+system P;
+)";
+
+static std::set<std::string> names(const std::set<symbol_t>& symbols)
+{
+    auto result = std::set<std::string>{};
+    for (const auto& symbol : symbols)
+        result.insert(symbol.getName());
+    return result;
+}
+
+static const CallGraph::summary_t& summary(const CallGraph& graph, const std::string& name)
+{
+    const auto& nodes = graph.getNodes();
+    const auto it = std::find_if(nodes.begin(), nodes.end(),
+                                 [&](const CallGraph::node_t& node) { return node.symbol.getName() == name; });
+    REQUIRE(it != nodes.end());
+    return graph.getSummary(it->symbol);
+}
+
+TEST_CASE("Call graph and components")
+{
+    auto document = parse_document(model);
+    const auto graph = CallGraph{*document};
+    CHECK(graph.getNodes().size() == 10);
+    CHECK(graph.getComponents().size() == 10);
+    const auto& nodes = graph.getNodes();
+    const auto position = [&](const std::string& name) {
+        for (size_t n = 0; n < nodes.size(); ++n)
+            if (nodes[n].symbol.getName() == name)
+                return nodes[n].component;
+        return size_t{0};
+    };
+    // callees come first
+    CHECK(position("get") < position("both"));
+    CHECK(position("setB") < position("both"));
+    CHECK(position("reset") < position("touch"));
+    CHECK(graph.find(nodes[0].symbol) == 0);
+}
+
+TEST_CASE("Transitive effects")
+{
+    auto document = parse_document(model);
+    const auto graph = CallGraph{*document};
+    const auto& both = summary(graph, "both");
+    CHECK(names(both.reads) == std::set<std::string>{"a", "b"});
+    CHECK(names(both.writes) == std::set<std::string>{"b"});
+    const auto& touch = summary(graph, "touch");
+    CHECK(names(touch.reads) == std::set<std::string>{"a", "c"});
+    CHECK(names(touch.writes) == std::set<std::string>{"local", "c"});
+    CHECK(names(summary(graph, "store").writes) == std::set<std::string>{"r"});
+    CHECK(names(summary(graph, "twice").reads) == std::set<std::string>{"a"});
+    // recursion is rejected by the type checker
+    CHECK(!summary(graph, "both").recursive);
+}
+
+TEST_CASE("Purity and idempotence")
+{
+    auto document = parse_document(model);
+    const auto graph = CallGraph{*document};
+    const auto check = [&](const std::string& name, bool pure, bool idempotent) {
+        CAPTURE(name);
+        const auto& s = summary(graph, name);
+        CHECK(s.pure == pure);
+        CHECK(s.idempotent == idempotent);
+    };
+    check("get", true, true);
+    check("twice", true, true);
+    check("setB", false, true);
+    check("incC", false, false);
+    check("both", false, false);
+    check("reset", false, true);
+    check("bump", false, false);
+    check("store", false, true);
+    check("draw", false, false);
+    CHECK(summary(graph, "draw").random);
+}
+
+TEST_CASE("External functions")
+{
+    auto document = parse_document(R"(
+import "libm.so.6" { double j0(double x); };
+double y;
+void move() { y = j0(y); }
+double look() { return j0(1.0); }
+process P() {
+  state A;
+  init A;
+}
+system P;
+)");
+    const auto graph = CallGraph{*document};
+    const auto& nodes = graph.getNodes();
+    const auto it = std::find_if(nodes.begin(), nodes.end(),
+                                 [](const CallGraph::node_t& node) { return node.symbol.getName() == "j0"; });
+    REQUIRE(it != nodes.end());
+    CHECK(it->isExternal());
+    CHECK(it->callees.empty());
+    const auto& j0 = graph.getSummary(it->symbol);
+    CHECK(j0.external);
+    CHECK(!j0.pure);
+    const auto& look = summary(graph, "look");
+    CHECK(look.external);
+    CHECK(!look.pure);
+    CHECK(!look.idempotent);
+    const auto& move = summary(graph, "move");
+    CHECK(move.external);
+    CHECK(names(move.writes) == std::set<std::string>{"y"});
+}
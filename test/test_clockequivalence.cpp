@@ -0,0 +1,131 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/clockequivalence.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "document_fixture.h"
+
+#include <sstream>
+#include <string>
+
+using namespace UTAP;
+
+static const char* model = R"(
+chan go;
+clock g1, g2, s, t;
+process P() {
+  clock x;
+  state A, B;
+  init A;
+  trans A -> B { sync go!; assign x = 0, g1 = 0, g2 = 0; },
+        B -> A { guard x > 2 && g1 > 1 && g2 < 5; };
+}
+process Q() {
+  clock y, z;
+  state A { z <= 4 && s' == 0 }, B;
+  init A;
+  trans A -> B { sync go?; assign y = 0; },
+        B -> A { guard y >= 1 && t > 2; assign z = 0; };
+}
+system P, Q;
+)";
+
+TEST_CASE("Clocks reset on the same synchronisation are equivalent")
+{
+    auto document = parse_document(model);
+    const auto equivalence = findEquivalentClocks(*document);
+    REQUIRE(equivalence.classes.size() == 1);
+    auto names = std::vector<std::string>{};
+    for (const auto& clock : equivalence.classes.front())
+        names.push_back(clock.name);
+    CHECK(names == std::vector<std::string>{"g1", "g2", "P.x", "Q.y"});
+    CHECK(equivalence.redundant() == 3);
+}
+
+TEST_CASE("Partners which do not reset break the equivalence")
+{
+    auto text = std::string{model};
+    text.replace(text.find("system P, Q;"), 12, "process R() { state A; init A; trans A -> A { sync go?; }; }\n"
+                                                 "system P, Q, R;");
+    auto document = parse_document(text);
+    const auto equivalence = findEquivalentClocks(*document);
+    REQUIRE(equivalence.classes.size() == 1);
+    CHECK(equivalence.classes.front().size() == 3);
+    auto os = std::ostringstream{};
+    os << equivalence;
+    CHECK(os.str() == "g1 == g2 == P.x\nredundant clocks: 2\n");
+}
+
+TEST_CASE("Merging removes the redundant clocks")
+{
+    auto document = parse_document(model);
+    const auto removed = mergeEquivalentClocks(*document, findEquivalentClocks(*document));
+    CHECK(removed == std::vector<std::string>{"g2", "P.x", "Q.y"});
+
+    auto& templates = document->getTemplates();
+    const auto& p = templates.front();
+    const auto& q = templates.back();
+    CHECK(p.variables.empty());
+    CHECK(p.edges.front().assign.toString() == "g1 = 0");
+    CHECK(p.edges.back().guard.toString() == "g1 > 2 && g1 > 1 && g1 < 5");
+    CHECK(q.variables.size() == 1);
+    CHECK(q.edges.front().assign.toString() == "1");
+    CHECK(q.edges.back().guard.toString() == "g1 >= 1 && t > 2");
+    CHECK(document->getGlobals().frame.getIndexOf("g2") == -1);
+    CHECK(findEquivalentClocks(*document).classes.empty());
+}
+
+TEST_CASE("Clocks named by queries are kept")
+{
+    auto text = std::string{model};
+    text.replace(text.find("system P, Q;"), 12, "Q1 = Q();\nsystem P, Q1;");
+    auto document = parse_document(text);
+    auto query = query_t{};
+    query.formula = "A[] Q1.y <= 10";
+    document->addQuery(query);
+    const auto equivalence = findEquivalentClocks(*document);
+    CHECK(mergeEquivalentClocks(*document, equivalence, {"E<> g2 > 1"}) == std::vector<std::string>{"P.x"});
+}
+
+TEST_CASE("Clocks passed to processes are kept")
+{
+    auto document = parse_document(R"(
+clock x, y, z;
+process P(clock &c) {
+  state A;
+  init A;
+  trans A -> A { assign c = 0, x = 0, z = 0; };
+}
+Q = P(y);
+system Q;
+)");
+    const auto equivalence = findEquivalentClocks(*document);
+    REQUIRE(equivalence.classes.size() == 1);
+    CHECK(equivalence.classes.front().size() == 3);
+    CHECK(mergeEquivalentClocks(*document, equivalence) == std::vector<std::string>{"z"});
+    CHECK(document->getGlobals().frame.getIndexOf("y") != -1);
+    CHECK(document->getProcesses().front().mapping.begin()->second.toString() == "y");
+}
@@ -0,0 +1,136 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/DocumentBuilder.hpp"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#ifdef UTAP_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef UTAP_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace UTAP;
+
+static const auto model_path = std::filesystem::path{MODELS_DIR} / "simpleHandshakeSystem.xml";
+
+static std::string read_model()
+{
+    auto os = std::ostringstream{};
+    os << std::ifstream{model_path, std::ios::binary}.rdbuf();
+    return os.str();
+}
+
+/** Writes \a contents to a temporary file, removed at the end of the scope. */
+struct temporary_file
+{
+    std::filesystem::path path;
+
+    temporary_file(const std::string& name, const std::string& contents):
+        path{std::filesystem::temp_directory_path() / name}
+    {
+        std::ofstream{path, std::ios::binary} << contents;
+    }
+    ~temporary_file() { std::filesystem::remove(path); }
+};
+
+/** Parses with parseXMLFile and parseXMLFd and checks the result against the uncompressed model. */
+static void check_parse(const std::string& name, const std::string& contents)
+{
+    auto expected = Document{};
+    REQUIRE(parseXMLFile(model_path.string().c_str(), &expected, true) == 0);
+    REQUIRE(!expected.hasErrors());
+
+    const auto file = temporary_file{name, contents};
+    auto document = Document{};
+    REQUIRE(parseXMLFile(file.path.string().c_str(), &document, true) == 0);
+    CHECK(!document.hasErrors());
+    CHECK(document.getTemplates().size() == expected.getTemplates().size());
+    CHECK(document.getProcesses().size() == expected.getProcesses().size());
+    CHECK(document.getGlobals().variables.size() == expected.getGlobals().variables.size());
+
+    const auto fd = open(file.path.string().c_str(), O_RDONLY);
+    REQUIRE(fd >= 0);
+    auto other = Document{};
+    CHECK(parseXMLFd(fd, &other, true) == 0);
+    close(fd);
+    CHECK(!other.hasErrors());
+    CHECK(other.getTemplates().size() == expected.getTemplates().size());
+}
+
+TEST_CASE("Uncompressed models")
+{
+    check_parse("utap_plain.xml", read_model());
+}
+
+#ifdef UTAP_WITH_ZLIB
+static std::string gzip(const std::string& data)
+{
+    auto stream = z_stream{};
+    REQUIRE(deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+    auto result = std::string(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef*>(result.data());
+    stream.avail_out = result.size();
+    REQUIRE(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+    result.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result;
+}
+
+TEST_CASE("Gzip compressed models")
+{
+    const auto model = read_model();
+    check_parse("utap_model.xml.gz", gzip(model));
+    // gzip files may consist of several members
+    const auto half = model.size() / 2;
+    check_parse("utap_members.xml.gz", gzip(model.substr(0, half)) + gzip(model.substr(half)));
+}
+#endif /* UTAP_WITH_ZLIB */
+
+#ifdef UTAP_WITH_ZSTD
+TEST_CASE("Zstd compressed models")
+{
+    const auto model = read_model();
+    auto compressed = std::string(ZSTD_compressBound(model.size()), '\0');
+    const auto size = ZSTD_compress(compressed.data(), compressed.size(), model.data(), model.size(), 3);
+    REQUIRE(!ZSTD_isError(size));
+    compressed.resize(size);
+    check_parse("utap_model.xml.zst", compressed);
+}
+#endif /* UTAP_WITH_ZSTD */
@@ -0,0 +1,116 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/costmodel.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "document_fixture.h"
+
+#include <sstream>
+#include <string>
+
+using namespace UTAP;
+
+static const char* model = R"(
+const int N = 10;
+int a[N];
+int i, j;
+int f(int x) {
+  int s = 0;
+  for (k : int[0,N-1]) { s += a[k] * x; }
+  return s;
+}
+process P() {
+  clock x;
+  state A { x <= 5 && i < N }, B, C;
+  init A;
+  trans A -> B { guard f(i) > 0 && x >= 2 && i == 3 && j != 1; },
+        B -> C { guard i < N && a[i] > 0 && j == 2; },
+        C -> A { guard i == 1 && j == 1; };
+}
+system P;
+)";
+
+static const template_t& process(Document& document) { return document.getTemplates().front(); }
+
+static const edge_t& edge(Document& document, size_t n)
+{
+    auto it = process(document).edges.begin();
+    std::advance(it, n);
+    return *it;
+}
+
+TEST_CASE("Cost of expressions")
+{
+    auto document = parse_document(model);
+    auto model = CostModel{};
+    const auto& weights = model.getWeights();
+    const auto& guard = edge(*document, 1).guard;  // (i < N && a[i] > 0) && j == 2
+    const auto& less = guard[0][0];
+    CHECK(model.cost(less) == weights.operation + weights.variable);
+    CHECK(model.cost(guard[0][1]) == weights.operation + weights.arrayIndex + 2 * weights.variable);
+    CHECK(model.selectivity(guard[1]) == weights.equality);
+    CHECK(model.selectivity(guard) == doctest::Approx(weights.ordering * weights.unknown * weights.equality));
+
+    // the call includes the loop in the body of f
+    const auto& call = edge(*document, 0).guard[0][0][0][0];
+    CHECK(call.getKind() == Constants::FUNCALL);
+    CHECK(model.cost(call) > weights.loop * weights.arrayIndex);
+}
+
+TEST_CASE("Conjuncts are ordered cheapest and most selective first")
+{
+    auto document = parse_document(model);
+    auto model = CostModel{};
+    const auto savings = reorderConjuncts(*document, model);
+    REQUIRE(savings.size() == 1);
+    CHECK(savings[0].templ == "P");
+    CHECK(savings[0].expressions == 4);
+    CHECK(savings[0].reordered == 3);
+    CHECK(savings[0].after < savings[0].before);
+
+    CHECK(process(*document).states.front().invariant.toString() == "i < N && x <= 5");
+    CHECK(edge(*document, 0).guard.toString() == "i == 3 && x >= 2 && j != 1 && f(i) > 0");
+    // a[i] must not be evaluated before the bounds check
+    CHECK(edge(*document, 1).guard.toString() == "j == 2 && i < N && a[i] > 0");
+    CHECK(edge(*document, 2).guard.toString() == "i == 1 && j == 1");
+
+    auto os = std::ostringstream{};
+    os << savings[0];
+    CHECK(os.str().find("P: 3 of 4 reordered") == 0);
+}
+
+TEST_CASE("Reordered expressions keep their types")
+{
+    auto document = parse_document(model);
+    auto model = CostModel{};
+    const auto& invariant = process(*document).states.front().invariant;
+    const auto reordered = reorderConjuncts(invariant, model);
+    CHECK(reordered.getType().toString() == invariant.getType().toString());
+    CHECK(reordered[0].getType().isIntegral());
+
+    const auto& guard = edge(*document, 2).guard;
+    CHECK(reorderConjuncts(guard, model).equal(guard));
+}
@@ -0,0 +1,226 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/clockbounds.h"
+#include "utap/dbm.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <random>
+#include <sstream>
+
+using namespace UTAP;
+
+static constexpr auto le = [](int32_t value) { return DBM::bound(value, false); };
+static constexpr auto lt = [](int32_t value) { return DBM::bound(value, true); };
+
+/** The zone 1 <= x <= 3, y - x <= 2 over the clocks x and y. */
+static DBM createZone()
+{
+    auto zone = DBM::createUnbounded(3);
+    REQUIRE(zone.constrain(1, 0, le(3)));
+    REQUIRE(zone.constrain(0, 1, le(-1)));
+    REQUIRE(zone.constrain(2, 1, le(2)));
+    return zone;
+}
+
+TEST_CASE("Bound encoding")
+{
+    CHECK(lt(3) < le(3));
+    CHECK(le(2) < lt(3));
+    CHECK(DBM::add(le(2), lt(3)) == lt(5));
+    CHECK(DBM::add(le(2), le(-3)) == le(-1));
+    CHECK(DBM::add(le(2), DBM::unbounded) == DBM::unbounded);
+    CHECK(DBM::valueOf(lt(-4)) == -4);
+    CHECK(DBM::isStrict(lt(-4)));
+    CHECK(!DBM::isStrict(le(-4)));
+}
+
+TEST_CASE("Constraints are closed")
+{
+    const auto zone = createZone();
+    CHECK(zone(2, 0) == le(5));  // y <= x + 2 <= 5
+    CHECK(zone(0, 2) == le(0));
+    CHECK(zone(1, 2) == le(3));  // x <= 3 and y >= 0
+
+    auto closed = DBM::createUnbounded(3);
+    closed.constrain(1, 0, le(3), false);
+    closed.constrain(0, 1, le(-1), false);
+    closed.constrain(2, 1, le(2), false);
+    CHECK(closed != zone);
+    CHECK(closed.close());
+    CHECK(closed == zone);
+
+    auto empty = zone;
+    CHECK(!empty.constrain(2, 0, lt(-1)));
+    CHECK(empty.isEmpty());
+    auto other = DBM::createZero(3);
+    CHECK(!other.constrain(1, 0, lt(0)));
+    CHECK(other == empty);
+}
+
+TEST_CASE("Delay, past and reset")
+{
+    auto zone = DBM::createZero(3);
+    zone.up();
+    CHECK(zone(1, 0) == DBM::unbounded);
+    CHECK(zone(1, 2) == le(0));  // the clocks stay equal
+    zone.constrain(1, 0, le(4));
+    zone.reset(2);
+    CHECK(zone(1, 2) == le(4));
+    CHECK(zone(2, 1) == le(0));
+    zone.reset(2, 2);
+    CHECK(zone(2, 0) == le(2));
+    CHECK(zone(0, 2) == le(-2));
+    CHECK(zone(2, 1) == le(2));
+    zone.down();
+    CHECK(zone(0, 1) == le(0));
+    CHECK(zone(0, 2) == le(0));
+    CHECK(zone(2, 1) == le(2));
+    std::ostringstream os;
+    os << DBM::createZero(2);
+    CHECK(os.str() == "[<=0 <=0; <=0 <=0]");
+}
+
+TEST_CASE("Inclusion and intersection")
+{
+    const auto zone = createZone();
+    auto smaller = zone;
+    smaller.constrain(1, 0, lt(2));
+    CHECK(smaller.isSubsetOf(zone));
+    CHECK(!zone.isSubsetOf(smaller));
+    CHECK(zone.isSubsetOf(DBM::createUnbounded(3)));
+    CHECK(smaller.intersects(zone));
+
+    auto later = DBM::createUnbounded(3);
+    later.constrain(0, 1, lt(-3));  // x > 3
+    CHECK(!later.intersects(zone));
+    CHECK(!later.intersect(zone));
+    CHECK(later.isEmpty());
+    CHECK(later.isSubsetOf(zone));
+
+    auto both = DBM::createUnbounded(3);
+    both.constrain(0, 2, le(-4));  // y >= 4
+    CHECK(both.intersects(zone));
+    CHECK(both.intersect(zone));
+    CHECK(both(0, 1) == le(-2));  // x >= y - 2 >= 2
+}
+
+TEST_CASE("LU-extrapolation")
+{
+    auto zone = DBM::createZero(3);
+    zone.up();
+    zone.constrain(0, 1, le(-10));  // x >= 10
+    // x is compared to at most 5 from below and 3 from above, y to 20 from above
+    zone.extrapolateLU({0, 5, ClockBounds::none}, {0, 3, 20});
+    CHECK(zone(0, 1) == lt(-3));  // x > 3
+    CHECK(zone(1, 0) == DBM::unbounded);
+    CHECK(zone(0, 2) == le(-10));  // y = x >= 10 is kept
+    CHECK(zone(1, 2) == DBM::unbounded);
+    CHECK(zone(2, 1) == DBM::unbounded);
+
+    auto bounded = createZone();
+    const auto copy = bounded;
+    bounded.extrapolateLU({0, 10, 10}, {0, 10, 10});
+    CHECK(bounded == copy);
+}
+
+TEST_CASE("Scalar and AVX2 kernels agree")
+{
+    if (!DBM::isSupported(DBM::AVX2))
+        return;
+    const auto initial = DBM::getKernel();
+    auto rng = std::mt19937{42};
+    for (const auto dimension : {2u, 7u, 17u, 33u}) {
+        auto constraints = std::vector<std::tuple<uint32_t, uint32_t, DBM::raw_t>>{};
+        auto pick = std::uniform_int_distribution<uint32_t>{0, dimension - 1};
+        auto value = std::uniform_int_distribution<int32_t>{-20, 40};
+        for (uint32_t n = 0; n < 4 * dimension; ++n) {
+            const auto i = pick(rng), j = pick(rng);
+            if (i != j)
+                constraints.emplace_back(i, j, DBM::bound(value(rng), n % 2));
+        }
+        auto results = std::vector<DBM>{};
+        for (const auto kernel : {DBM::SCALAR, DBM::AVX2}) {
+            REQUIRE(DBM::setKernel(kernel));
+            auto zone = DBM::createZero(dimension);
+            zone.up();
+            auto lazy = zone;
+            for (const auto& [i, j, bound] : constraints) {
+                zone.constrain(i, j, bound);
+                lazy.constrain(i, j, bound, false);
+            }
+            lazy.close();
+            CHECK(zone == lazy);
+            CHECK(zone.isSubsetOf(lazy));
+            results.push_back(zone);
+        }
+        CHECK(results[0] == results[1]);
+    }
+    DBM::setKernel(initial);
+}
+
+TEST_CASE("Clock bounds of locations")
+{
+    auto document = std::make_unique<Document>();
+    parseXTA(R"(
+const int N = 2;
+clock g;
+clock c[N];
+process P(const int k) {
+  clock x;
+  state A { x <= 5 + k }, B, C;
+  init A;
+  trans A -> B { guard x >= 3; assign x = 0; },
+        B -> C { guard x > 7 && g < 10 && c[1] >= k; },
+        C -> A { assign x = 0; };
+}
+P1 = P(1);
+system P1;
+)",
+             document.get(), true);
+    REQUIRE(!document->hasErrors());
+    const auto bounds = ClockBounds{*document};
+    CHECK(bounds.getDimension() == 5);
+    CHECK(bounds.getClocks() == std::vector<std::string>{"t(0)", "g", "c[0]", "c[1]", "P1.x"});
+    CHECK(!bounds.hasDiagonals());
+    const auto g = bounds.find("g");
+    const auto c1 = bounds.find("c[1]");
+    const auto x = bounds.find("P1.x");
+
+    const auto& a = bounds.getBounds(0, 0);
+    CHECK(a.lower == std::map<uint32_t, int32_t>{{c1, 1}, {x, 3}});
+    CHECK(a.upper == std::map<uint32_t, int32_t>{{g, 10}, {x, 6}});
+    const auto& b = bounds.getBounds(0, 1);
+    CHECK(b.lower == std::map<uint32_t, int32_t>{{c1, 1}, {x, 7}});
+    CHECK(b.upper == std::map<uint32_t, int32_t>{{g, 10}});
+    const auto& c = bounds.getBounds(0, 2);
+    CHECK(c.lower == std::map<uint32_t, int32_t>{{c1, 1}});
+
+    auto lower = std::vector<int32_t>(bounds.getDimension(), ClockBounds::none);
+    auto upper = lower;
+    bounds.addBounds(0, 1, lower, upper);
+    CHECK(lower == std::vector<int32_t>{-1, -1, -1, 1, 7});
+    CHECK(upper == std::vector<int32_t>{-1, 10, -1, -1, -1});
+}
@@ -0,0 +1,150 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/deadcode.h"
+#include "utap/typechecker.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "document_fixture.h"
+
+#include <sstream>
+#include <string>
+
+using namespace UTAP;
+
+static const char* model = R"(
+int[0,7] used, history, trace;
+bool flag;
+int counter;
+int[0,3] copy;
+int queried;
+int shared;
+clock unusedClock;
+int f(int x) { return x + 1; }
+int g() { shared = shared + 1; return shared; }
+int unusedFun() { return 1; }
+process P() {
+  clock x;
+  int[0,1] localDead;
+  state A { x <= 5 }, B;
+  init A;
+  trans A -> B { guard flag && f(used) > 0; assign used = g(), counter++, copy = used, localDead = 1, x = 0; },
+        B -> A { assign history = copy + 1; };
+}
+process Unused() { state A; init A; }
+system P;
+)";
+
+static std::string names(const dead_code_t& dead)
+{
+    auto result = std::string{};
+    for (const auto& entry : dead.entries)
+        result += entry.name + " ";
+    return result;
+}
+
+TEST_CASE("Write-only and unreferenced declarations are dead")
+{
+    auto document = parse_document(model);
+    const auto dead = findDeadCode(*document, {"A[] queried >= 0"});
+    CHECK(names(dead) == "Unused history trace counter copy unusedClock unusedFun P.localDead ");
+    CHECK(dead.entries[0].entity == dead_code_t::TEMPLATE);
+    CHECK(dead.entries[1].bits == 3);
+    CHECK(dead.entries[3].bits == 16);
+    CHECK(dead.entries[5].entity == dead_code_t::CLOCK);
+    CHECK(dead.entries[6].entity == dead_code_t::FUNCTION);
+    CHECK(dead.stateBits() == 3 + 3 + 16 + 2 + 1);
+    CHECK(dead.clocks() == 1);
+
+    // without the query, the queried variable is unreferenced
+    CHECK(findDeadCode(*document).entries.size() == dead.entries.size() + 1);
+    // finding does not change the document
+    CHECK(document->getTemplates().size() == 2);
+
+    auto os = std::ostringstream{};
+    os << dead;
+    CHECK(os.str().find("variable P.localDead (1 bits x 1)\n") != std::string::npos);
+    CHECK(os.str().find("state bits saved: 25, clocks saved: 1") != std::string::npos);
+}
+
+TEST_CASE("Dead declarations are removed")
+{
+    auto document = parse_document(model);
+    const auto dead = eliminateDeadCode(*document, {"A[] queried >= 0"});
+    CHECK(dead.entries.size() == 8);
+
+    auto& globals = document->getGlobals();
+    CHECK(globals.frame.getIndexOf("history") == -1);
+    CHECK(globals.frame.getIndexOf("unusedFun") == -1);
+    CHECK(globals.frame.getIndexOf("Unused") == -1);
+    CHECK(globals.frame.getIndexOf("shared") != -1);
+    auto variables = std::string{};
+    for (const auto& variable : globals.variables)
+        if (!variable.uid.getType().isConstant())
+            variables += variable.uid.getName() + " ";
+    CHECK(variables == "used flag queried shared ");
+    CHECK(globals.functions.size() == 2);
+    REQUIRE(document->getTemplates().size() == 1);
+    const auto& templ = document->getTemplates().front();
+    CHECK(templ.variables.size() == 1);
+    CHECK(templ.edges.front().assign.toString() == "used = g(), x = 0");
+    CHECK(templ.edges.back().assign.toString() == "1");
+
+    // the result is still a valid model
+    auto checker = TypeChecker{*document};
+    document->accept(checker);
+    CHECK(!document->hasErrors());
+    CHECK(findDeadCode(*document, {"A[] queried >= 0"}).empty());
+}
+
+TEST_CASE("Before and after updates and channel priorities are scanned")
+{
+    auto document = std::make_unique<Document>();
+    parseXTA(R"(
+int y, z;
+int w = 5;
+int v = 1;
+chan a[2], b;
+chan priority a[0] < b;
+before_update { y = w }
+after_update { z = v }
+process P() {
+  state A;
+  init A;
+  trans A -> A { guard y == 5; sync a[0]!; };
+}
+system P;
+)",
+             document.get(), true);
+    REQUIRE(!document->hasErrors());
+    CHECK(names(findDeadCode(*document)) == "z v ");
+
+    eliminateDeadCode(*document);
+    CHECK(document->getBeforeUpdate().toString() == "y = w");
+    CHECK(document->getAfterUpdate().empty());
+    auto checker = TypeChecker{*document};
+    document->accept(checker);
+    CHECK(!document->hasErrors());
+}
@@ -0,0 +1,88 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/engineview.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+using namespace UTAP;
+using namespace UTAP::Constants;
+
+static const char* model = R"(
+chan c[2];
+int v;
+process P() {
+  clock x;
+  state A { x <= 4 }, B, C;
+  urgent B;
+  commit C;
+  init A;
+  trans
+    C -> A { sync c[1]?; },
+    A -> B { guard x > 2; sync c[0]!; assign v = 1; },
+    A -> C { guard v == 1; },
+    B -> A { assign x = 0; };
+}
+system P;
+)";
+
+TEST_CASE("Engine view of locations and edges")
+{
+    auto document = std::make_unique<Document>();
+    REQUIRE(parseXTA(model, document.get(), true));
+    REQUIRE(!document->hasErrors());
+    auto view = EngineView{*document};
+    REQUIRE(view.getTemplates().size() == 1);
+    const auto& templ = view.getTemplates().front();
+
+    const auto& locs = templ.locations;
+    REQUIRE(locs.size() == 3);
+    CHECK(locs.flags[0] == EngineView::INITIAL_LOCATION);
+    CHECK(locs.flags[1] == EngineView::URGENT_LOCATION);
+    CHECK(locs.flags[2] == EngineView::COMMITTED_LOCATION);
+    REQUIRE(locs.invariant[0] != EngineView::none);
+    CHECK(view.getExpression(locs.invariant[0]).toString().find("x <= 4") != std::string::npos);
+    CHECK(locs.invariant[1] == EngineView::none);
+
+    const auto& edges = templ.edges;
+    REQUIRE(edges.size() == 4);
+    CHECK(edges.outgoing(0) == std::pair<uint32_t, uint32_t>{0, 2});
+    CHECK(edges.outgoing(1) == std::pair<uint32_t, uint32_t>{2, 3});
+    CHECK(edges.outgoing(2) == std::pair<uint32_t, uint32_t>{3, 4});
+    CHECK(edges.src == std::vector<int32_t>{0, 0, 1, 2});
+    CHECK(edges.dst == std::vector<int32_t>{1, 2, 0, 0});
+
+    // A -> B keeps its place before A -> C
+    REQUIRE(edges.guard[0] != EngineView::none);
+    CHECK(view.getExpression(edges.guard[0]).toString() == "x > 2");
+    CHECK(edges.syncKind[0] == SYNC_BANG);
+    CHECK(edges.syncKind[3] == SYNC_QUE);
+    REQUIRE(view.getChannels().size() == 1);
+    CHECK(edges.channel[0] == 0);
+    CHECK(edges.channel[3] == 0);
+    CHECK(view.getChannel(0).getName() == "c");
+    CHECK(view.getExpression(edges.channelExpr[0]).toString() == "c[0]");
+    CHECK(edges.channel[1] == EngineView::none);
+    CHECK(edges.controllable[1] == 1);
+    CHECK(edges.edge[2]->src->uid.getName() == "B");
+}
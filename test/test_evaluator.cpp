@@ -0,0 +1,89 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/evaluator.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <string>
+
+using namespace UTAP;
+
+static const char* model = R"(
+const int N = 4;
+const int M = N * 2 + (N > 3 ? 1 : 0);
+const int sizes[3] = { 1, N, M };
+typedef int[-N, sizes[2] - 1] value_t;
+int[0, M] counter;
+value_t values[N];
+int[0, 1 << N] big;
+process P(const int[0, N - 1] id) {
+  int[0, id] mine;
+  state A;
+  init A;
+  trans A -> A { select i : int[0, sizes[1]]; };
+}
+system P;
+)";
+
+static type_t find(const frame_t& frame, const std::string& name)
+{
+    const auto index = frame.getIndexOf(name);
+    REQUIRE(index >= 0);
+    return frame[index].getType();
+}
+
+TEST_CASE("Bounds are evaluated after type checking")
+{
+    auto document = std::make_unique<Document>();
+    REQUIRE(parseXTA(model, document.get(), true));
+    const auto& globals = document->getGlobals().frame;
+
+    CHECK(find(globals, "counter").getBounds() == range_t<int32_t>{0, 9});
+    CHECK(find(globals, "big").getBounds() == range_t<int32_t>{0, 16});
+    const auto values = find(globals, "values");
+    CHECK(values.getArraySize().getBounds() == range_t<int32_t>{0, 3});
+    CHECK(values.getSub().getBounds() == range_t<int32_t>{-4, 8});
+
+    const auto& templ = document->getTemplates().front();
+    CHECK(find(templ.parameters, "id").getBounds() == range_t<int32_t>{0, 3});
+    // depends on a parameter
+    CHECK(!find(templ.frame, "mine").getBounds());
+    CHECK(find(templ.edges.front().select, "i").getBounds() == range_t<int32_t>{0, 4});
+}
+
+TEST_CASE("Constant evaluation")
+{
+    auto document = std::make_unique<Document>();
+    REQUIRE(parseXTA(model, document.get(), true));
+    auto evaluator = ConstantEvaluator{};
+    const auto evaluate = [&](const char* text) {
+        return evaluator.evaluate(parseExpression(text, document.get(), true));
+    };
+    CHECK(evaluate("M % 4 + sizes[1]") == 5);
+    CHECK(evaluate("N / (M - 9)") == std::nullopt);
+    CHECK(evaluate("2147483647 + N") == std::nullopt);
+    CHECK(evaluate("counter + 1") == std::nullopt);
+    CHECK(evaluate("(N < M) + (M >? 100)") == 101);
+}
@@ -0,0 +1,149 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/modelbuilder.h"
+#include "utap/modeldiff.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <sstream>
+#include <string>
+
+using namespace UTAP;
+using E = ModelBuilder::Expr;
+using T = ModelBuilder::Type;
+
+static const char* text_model = R"(
+const int N = 3;
+typedef int[0,N-1] id_t;
+chan go[N];
+broadcast chan reset;
+int count = 0;
+bool done[N] = { false, false, true };
+process P(const id_t id) {
+  clock x;
+  int[0,5] n = id + 1;
+  state A { x <= 5 }, B, C;
+  commit C;
+  init A;
+  trans A -> B { select k : id_t; guard x >= 2 && k != id; sync go[k]!; assign x = 0, count++; },
+        B -> C { sync reset?; assign n = -1 + n * 2; },
+        C -> A { guard !done[id] || count > 10; assign done[id] = true; };
+}
+Q = P(1);
+system P, Q;
+)";
+
+static void build(Document& document)
+{
+    auto builder = ModelBuilder{document};
+    builder.declare(T::Int().constant(), "N", 3);
+    builder.declareType(T::Int(0, E::id("N") - 1), "id_t");
+    builder.declare(T::Chan().array(E::id("N")), "go");
+    builder.declare(T::Chan().broadcast(), "reset");
+    builder.declare(T::Int(), "count", 0);
+    builder.declare({T::Bool().array(E::id("N")), "done", {}, {E::boolean(false), E::boolean(false), E::boolean(true)}});
+
+    const auto id = E::id("id"), x = E::id("x"), n = E::id("n"), k = E::id("k"), count = E::id("count");
+    const auto done = E::id("done");
+    auto p = ModelBuilder::Template{"P"};
+    p.parameter(T::Named("id_t").constant(), "id")
+        .declare(T::Clock(), "x")
+        .declare(T::Int(0, 5), "n", id + 1)
+        .location("A", x <= 5)
+        .location("B")
+        .location("C")
+        .committed("C")
+        .initial("A")
+        .edge(ModelBuilder::Edge{"A", "B"}
+                  .select("k", T::Named("id_t"))
+                  .guard(x >= 2 && k != id)
+                  .send(E::id("go")[k])
+                  .update(x.assign(0))
+                  .update(count.increment()))
+        .edge(ModelBuilder::Edge{"B", "C"}.receive(E::id("reset")).update(n.assign(-1 + n * 2)))
+        .edge(ModelBuilder::Edge{"C", "A"}
+                  .guard(!done[id] || count > 10)
+                  .update(done[id].assign(E::boolean(true))));
+    builder.add(p);
+    builder.instantiate("Q", "P", {1});
+    builder.system({"P", "Q"});
+    CHECK(builder.check());
+}
+
+static std::string describe(Document& document)
+{
+    auto os = std::ostringstream{};
+    for (const auto& templ : document.getTemplates()) {
+        os << templ.uid.getName() << ':';
+        for (const auto& variable : templ.variables)
+            os << ' ' << variable.uid.getName() << '=' << variable.expr;
+        for (const auto& state : templ.states)
+            os << ' ' << state.uid.getName() << '{' << state.invariant << '}';
+        for (const auto& edge : templ.edges)
+            os << " [" << edge.guard << ';' << edge.sync << ';' << edge.assign << ']';
+        os << '\n';
+    }
+    for (const auto& process : document.getProcesses())
+        os << process.uid.getName() << ' ';
+    return os.str();
+}
+
+TEST_CASE("Constructed model equals the parsed model")
+{
+    auto parsed = Document{};
+    parseXTA(text_model, &parsed, true);
+    REQUIRE(!parsed.hasErrors());
+    auto built = Document{};
+    build(built);
+    REQUIRE(!built.hasErrors());
+
+    CHECK(diffDocuments(parsed, built).empty());
+    CHECK(describe(built) == describe(parsed));
+    CHECK(built.getGlobals().variables.size() == parsed.getGlobals().variables.size());
+    CHECK(built.getProcesses().size() == 2);
+}
+
+TEST_CASE("Errors are located by their path")
+{
+    auto document = Document{};
+    auto builder = ModelBuilder{document};
+    auto p = ModelBuilder::Template{"P"};
+    p.location("A").initial("A").edge(ModelBuilder::Edge{"A", "A"}.guard(E::id("undeclared") > 0));
+    builder.add(p);
+    builder.system({"P"});
+    REQUIRE(document.hasErrors());
+    auto os = std::ostringstream{};
+    os << document.getErrors().front();
+    CHECK(os.str().find("/template/P/edge/A->A") != std::string::npos);
+}
+
+TEST_CASE("Type errors are found by check")
+{
+    auto document = Document{};
+    auto builder = ModelBuilder{document};
+    builder.declare(T::Bool(), "b", 2.5);
+    builder.system({});
+    CHECK(!builder.check());
+}
@@ -0,0 +1,118 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/modeldiff.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "document_fixture.h"
+
+#include <string>
+
+using namespace UTAP;
+
+static const char* base_model = R"(
+int a, b, c;
+int f(int x) { return x + 1; }
+process P() {
+  state A, B;
+  init A;
+  trans A -> B { guard a > 0; assign b = 1; };
+}
+process Q() {
+  state A, B;
+  init A;
+  trans A -> B { guard b > 0; assign c = f(c); };
+}
+process R() {
+  state A;
+  init A;
+  trans A -> A { guard c < 0; };
+}
+system P, Q, R;
+)";
+
+static std::string replace(std::string text, const std::string& from, const std::string& to)
+{
+    const auto pos = text.find(from);
+    REQUIRE(pos != std::string::npos);
+    return text.replace(pos, from.size(), to);
+}
+
+TEST_CASE("Identical models have no differences")
+{
+    auto before = parse_document(base_model);
+    auto after = parse_document(base_model);
+    const auto diff = diffDocuments(*before, *after);
+    CHECK(diff.empty());
+    CHECK(diff.affectedProcesses.empty());
+    CHECK(diff.affectedVariables.empty());
+}
+
+TEST_CASE("Changed guard affects the dependent processes")
+{
+    auto before = parse_document(base_model);
+    auto after = parse_document(replace(base_model, "guard a > 0", "guard a > 1"));
+    const auto diff = diffDocuments(*before, *after);
+    REQUIRE(diff.entries.size() == 1);
+    CHECK(diff.entries[0].change == model_diff_t::CHANGED);
+    CHECK(diff.entries[0].entity == model_diff_t::EDGE);
+    CHECK(diff.entries[0].name == "P.A->B");
+    // P writes b, which Q reads, and Q writes c, which R reads
+    CHECK(diff.affectedProcesses == std::set<std::string>{"P", "Q", "R"});
+    CHECK(diff.affectedVariables == std::set<std::string>{"b", "c"});
+}
+
+TEST_CASE("Changed function affects its callers only")
+{
+    auto before = parse_document(base_model);
+    auto after = parse_document(replace(base_model, "return x + 1;", "return x + 2;"));
+    const auto diff = diffDocuments(*before, *after);
+    REQUIRE(diff.entries.size() == 1);
+    CHECK(diff.entries[0].entity == model_diff_t::FUNCTION);
+    CHECK(diff.entries[0].name == "f");
+    CHECK(diff.affectedProcesses == std::set<std::string>{"Q", "R"});
+    CHECK(diff.affectedVariables == std::set<std::string>{"c", "f"});
+}
+
+TEST_CASE("Added and removed entities")
+{
+    auto before = parse_document(base_model);
+    auto model = replace(base_model, "int a, b, c;", "int a, b, c, d;");
+    model = replace(model, "process Q() {\n  state A, B;", "process Q() {\n  state A, B, C;");
+    auto after = parse_document(model);
+    const auto diff = diffDocuments(*before, *after);
+    REQUIRE(diff.entries.size() == 2);
+    CHECK(diff.entries[0].change == model_diff_t::ADDED);
+    CHECK(diff.entries[0].entity == model_diff_t::VARIABLE);
+    CHECK(diff.entries[0].name == "d");
+    CHECK(diff.entries[1].change == model_diff_t::ADDED);
+    CHECK(diff.entries[1].entity == model_diff_t::LOCATION);
+    CHECK(diff.entries[1].name == "Q.C");
+    CHECK(diff.affectedProcesses == std::set<std::string>{"Q", "R"});
+
+    const auto reverse = diffDocuments(*after, *before);
+    REQUIRE(reverse.entries.size() == 2);
+    CHECK(reverse.entries[0].change == model_diff_t::REMOVED);
+    CHECK(reverse.entries[1].change == model_diff_t::REMOVED);
+}
@@ -0,0 +1,121 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/ownership.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "document_fixture.h"
+
+#include <sstream>
+#include <string>
+
+using namespace UTAP;
+
+static const char* model = R"(
+typedef int[0,2] id_t;
+int[0,3] counter;
+int total;
+bool flag[3];
+int mixed[3];
+int hidden;
+void bump() { hidden++; }
+process P(const id_t id) {
+  state A;
+  init A;
+  trans A -> A { guard !flag[id]; assign flag[id] = true, mixed[id] = id, total++; };
+}
+process Main() {
+  state S;
+  init S;
+  trans S -> S { guard counter < 3; assign counter++, bump(), total = mixed[0]; };
+}
+system P, Main;
+)";
+
+TEST_CASE("Ownership of global variables")
+{
+    auto document = parse_document(model);
+    const auto ownership = analyseOwnership(*document);
+
+    const auto* counter = ownership.find("counter");
+    REQUIRE(counter);
+    CHECK(counter->isLocal());
+    CHECK(counter->direct);
+    CHECK(*counter->users.begin() == "Main");
+
+    const auto* total = ownership.find("total");
+    REQUIRE(total);
+    CHECK(total->isShared());
+    CHECK(total->users.size() == 4);
+
+    const auto* flag = ownership.find("flag");
+    REQUIRE(flag);
+    CHECK(flag->isPartitioned());
+    CHECK(flag->owners == std::map<int32_t, std::string>{{0, "P(0)"}, {1, "P(1)"}, {2, "P(2)"}});
+
+    // Main reads the element written by P(0)
+    const auto* mixed = ownership.find("mixed");
+    REQUIRE(mixed);
+    CHECK(mixed->isShared());
+
+    const auto* hidden = ownership.find("hidden");
+    REQUIRE(hidden);
+    CHECK(hidden->isLocal());
+    CHECK(!hidden->direct);
+}
+
+TEST_CASE("Queries observe variables")
+{
+    auto document = parse_document(model);
+    const auto ownership = analyseOwnership(*document, {"A[] counter <= 3"});
+    CHECK(ownership.find("counter")->observed);
+    CHECK(!ownership.find("total")->observed);
+}
+
+TEST_CASE("Promotion moves the owned variables into the templates")
+{
+    auto document = parse_document(model);
+    const auto promoted = promoteOwnedVariables(*document, analyseOwnership(*document));
+    CHECK(promoted == std::vector<std::string>{"counter", "flag"});
+
+    auto& templates = document->getTemplates();
+    auto& p = templates.front();
+    auto& main = templates.back();
+    REQUIRE(p.variables.size() == 1);
+    CHECK(p.variables.front().uid.getType().isBoolean());
+    CHECK(p.edges.front().guard.toString() == "!flag");
+    REQUIRE(main.variables.size() == 1);
+    CHECK(main.variables.front().uid.getName() == "counter");
+    CHECK(main.frame.getIndexOf("counter") != -1);
+    CHECK(document->getGlobals().frame.getIndexOf("counter") == -1);
+
+    // the promoted variables are now accessed by their own processes only
+    const auto after = analyseOwnership(*document);
+    CHECK(after.find("counter") == nullptr);
+    CHECK(after.find("flag") == nullptr);
+    auto os = std::ostringstream{};
+    os << after;
+    CHECK(os.str() == "total: shared by 4 processes\nmixed: shared by 4 processes\nhidden: local to Main (indirect)\n");
+}
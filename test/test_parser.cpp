@@ -20,8 +20,13 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 
+#include "document_fixture.h"
+
 #include <filesystem>
 #include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 inline std::string read_content(const std::string& file_name)
 {
@@ -113,3 +118,156 @@ TEST_CASE("SMC bounds in queries")
         CHECK(expr.get(0).getValue() == -1);  // number of runs
     }
 }
+
+TEST_CASE("Identifier length limit")
+{
+    const auto parse = [](const std::string& name) {
+        auto doc = std::make_unique<UTAP::Document>();
+        auto model = "const int " + name + " = 1;\nint y = " + name + ";\n";
+        model += "process P() { state A; init A; }\nsystem P;\n";
+        parseXTA(model.c_str(), doc.get(), true);
+        return doc;
+    };
+    CHECK(parse(std::string(4000, 'x'))->getErrors().size() == 0);
+    const auto doc = parse(std::string(4001, 'x'));
+    REQUIRE(doc->getErrors().size() > 0);
+    CHECK(doc->getErrors().front().msg == "$Identifier_is_too_long._Limit_length_is_4000.");
+}
+
+TEST_CASE("Type names follow the scopes")
+{
+    const auto parse = [](const std::string& decls) {
+        auto doc = std::make_unique<UTAP::Document>();
+        auto model = decls + "\nprocess P() { state A; init A; }\nsystem P;\n";
+        parseXTA(model.c_str(), doc.get(), true);
+        return doc;
+    };
+    // a local typedef is visible in its block only
+    CHECK(parse("void f() { typedef int[0,3] T; T x = 1; }")->getErrors().size() == 0);
+    CHECK(parse("void f() { { typedef int[0,3] T; } T x = 1; }")->getErrors().size() > 0);
+    // a global type name is visible in nested scopes
+    CHECK(parse("typedef int[0,3] T;\nint f() { for (i : T) { T x = i; } return 0; }")->getErrors().size() == 0);
+    // a local type name shadows a global variable
+    CHECK(parse("int T;\nvoid f() { typedef bool T; T b = true; }\nint g() { return T; }")->getErrors().size() == 0);
+}
+
+TEST_CASE("Numeric literals")
+{
+    const auto parse = [](const std::string& decls) {
+        auto doc = std::make_unique<UTAP::Document>();
+        auto model = decls + "\nprocess P() { state A; init A; }\nsystem P;\n";
+        parseXTA(model.c_str(), doc.get(), true);
+        return doc;
+    };
+    auto doc = parse("int a = 0x7fFF;\nint b = 0b101;\nint c = 000123;\nint d = -2147483648;\n"
+                     "int e = -0x80000000;\ndouble f = 2.5e-1;");
+    REQUIRE(doc->getErrors().size() == 0);
+    auto values = std::vector<std::string>{};
+    for (const auto& variable : doc->getGlobals().variables)
+        values.push_back(variable.expr.toString());
+    REQUIRE(values.size() >= 6);  // after the built-in constants
+    values.erase(values.begin(), values.end() - 6);
+    CHECK(values == std::vector<std::string>{"32767", "5", "123", "-2147483648", "-2147483648", "0.250000"});
+    CHECK(parse("int a = 2147483647;")->getErrors().size() == 0);
+    CHECK(parse("int a = 2147483648;")->getErrors().size() > 0);
+    CHECK(parse("int a = 0x100000000;")->getErrors().size() > 0);
+    CHECK(parse("double a = 1e999;")->getErrors().size() > 0);
+    CHECK(parse("double a = 123456.0e305;")->getErrors().size() > 0);
+
+    // values too close to zero become zero
+    doc = parse("const double tiny = 1e-400;\ndouble b = 0.000001e-320;\ndouble c = 0.0e999;");
+    REQUIRE(doc->getErrors().size() == 0);
+    values.clear();
+    for (const auto& variable : doc->getGlobals().variables)
+        values.push_back(variable.expr.toString());
+    values.erase(values.begin(), values.end() - 3);
+    CHECK(values == std::vector<std::string>{"0.000000", "0.000000", "0.000000"});
+}
+
+TEST_CASE("Error lines without line tracking")
+{
+    const auto errors = [](bool tracking, const char* model) {
+        auto doc = std::make_unique<UTAP::Document>();
+        doc->setLineTracking(tracking);
+        if (model[0] == '<')
+            parseXMLBuffer(model, doc.get(), true);
+        else
+            parseXTA(model, doc.get(), true);
+        auto res = std::vector<std::string>{};
+        for (const auto& error : doc->getErrors())
+            res.push_back(error.toString());
+        return res;
+    };
+    const auto* xta = "int x;\n\nint y = z;\r\nint w = \\\n  v;\nsystem;\n";
+    CHECK(errors(false, xta) == errors(true, xta));
+    CHECK(errors(false, xta).size() == 3);
+    const auto* xml = R"(<?xml version="1.0" encoding="utf-8"?>
+<nta>
+<declaration>int x;
+int y = z;</declaration>
+<template><name>P</name><declaration>
+int a;
+
+int b = c;</declaration><location id="id0"/><init ref="id0"/></template>
+<system>system P;</system>
+</nta>
+)";
+    const auto expected = errors(true, xml);
+    REQUIRE(expected.size() == 2);
+    CHECK(errors(false, xml) == expected);
+}
+
+TEST_CASE("Errors read from several threads")
+{
+    auto model = std::string{};
+    for (auto i = 0; i < 1000; ++i)
+        model += "int x" + std::to_string(i) + " = y;\n";
+    model += "process P() { state A; init A; }\nsystem P;\n";
+    auto doc = std::make_unique<UTAP::Document>();
+    parseXTA(model.c_str(), doc.get(), true);
+    auto counts = std::vector<size_t>(4);
+    auto readers = std::vector<std::thread>{};
+    for (auto& count : counts)
+        readers.emplace_back([&] {
+            for (const auto& error : doc->getErrors())
+                count += error.start.line > 0;
+        });
+    for (auto& reader : readers)
+        reader.join();
+    CHECK(counts == std::vector<size_t>(4, 1000));
+}
+
+TEST_CASE("Shared expressions are type checked on every path")
+{
+    const auto* model = "const int N = 2;\ntypedef int[0, N + 1] T;\nT a;\nT b;\n"
+                        "process P() { T c; state A; init A; }\nsystem P;\n";
+    auto doc = parse_document(model);
+    auto bounds = std::vector<UTAP::expression_t>{};
+    for (const auto& variable : doc->getGlobals().variables)
+        if (variable.uid.getName() == "a" || variable.uid.getName() == "b")
+            bounds.push_back(variable.uid.getType().getRange().second);
+    bounds.push_back(doc->getTemplates().front().variables.front().uid.getType().getRange().second);
+    REQUIRE(bounds.size() == 3);  // a, b and c
+    CHECK(bounds[0] == bounds[1]);
+    CHECK(bounds[0] == bounds[2]);
+    CHECK(bounds[0].getType().isIntegral());
+
+    // An ill-typed bound is reported for each variable declared with it
+    doc = std::make_unique<UTAP::Document>();
+    parseXTA("chan c;\ntypedef int[0, c + 1] T;\nT a;\nT b;\nT d;\nprocess P() { state A; init A; }\nsystem P;\n",
+             doc.get(), true);
+    CHECK(doc->getErrors().size() == 3);
+}
+
+TEST_CASE("Diagnostics are formed from their message ids")
+{
+    auto doc = std::make_unique<UTAP::Document>();
+    parseXTA("int x;\nvoid f() { x == 1; }\nprocess P() { state A; init A; trans A -> A { guard f(); }; }\n"
+             "system P;\n",
+             doc.get(), true);
+    REQUIRE(doc->getWarnings().size() == 1);
+    CHECK(doc->getWarnings().front().msg == "$Expression_does_not_have_any_effect");
+    CHECK(doc->getWarnings().front().context == "(typechecking)");
+    REQUIRE(doc->getErrors().size() == 1);
+    CHECK(doc->getErrors().front().msg == "$Expression_of_type (void) $cannot_be_used_as_a_guard");
+}
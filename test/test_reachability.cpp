@@ -0,0 +1,110 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/reachability.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "document_fixture.h"
+
+#include <string>
+
+using namespace UTAP;
+
+static const char* model = R"(
+typedef int[0,2] id_t;
+int[0,5] v;
+chan go, lost;
+broadcast chan tick;
+process P(const id_t id) {
+  clock x;
+  state A, B, C, D { x <= 3 }, E;
+  init A;
+  trans A -> B { guard id == 5; },
+        A -> C { guard v > 10; },
+        A -> D { guard id == 1; sync go!; },
+        D -> E { guard x >= 1; sync lost!; },
+        C -> E { },
+        A -> A { sync tick?; };
+}
+process Q() {
+  state S;
+  init S;
+  trans S -> S { sync go?; };
+}
+P1 = P(1);
+P2 = P(2);
+system P1, P2, Q;
+)";
+
+static std::set<std::string> names(const std::set<const state_t*>& locations)
+{
+    auto result = std::set<std::string>{};
+    for (const auto* location : locations)
+        result.insert(location->uid.getName());
+    return result;
+}
+
+TEST_CASE("Reachable locations per process")
+{
+    auto document = parse_document(model);
+    const auto reachability = analyseReachability(*document);
+    REQUIRE(reachability.processes.size() == 3);
+    const auto& p1 = reachability.processes[0];
+    const auto& p2 = reachability.processes[1];
+    const auto& q = reachability.processes[2];
+    CHECK(p1.name == "P1");
+    // B is guarded by id == 5, C by v > 10, E by the lost channel without receivers
+    CHECK(names(p1.locations) == std::set<std::string>{"A", "D"});
+    CHECK(p1.edges.size() == 1);
+    // the broadcast receiver has no sender either
+    CHECK(names(p2.locations) == std::set<std::string>{"A"});
+    CHECK(p2.edges.empty());
+    CHECK(names(q.locations) == std::set<std::string>{"S"});
+    CHECK(q.edges.size() == 1);
+}
+
+TEST_CASE("Receivers need a reachable sender")
+{
+    auto text = std::string{model};
+    text.replace(text.find("P1 = P(1);"), 10, "P1 = P(0);");
+    auto document = parse_document(text);
+    const auto reachability = analyseReachability(*document);
+    REQUIRE(reachability.processes.size() == 3);
+    CHECK(names(reachability.processes[0].locations) == std::set<std::string>{"A"});
+    CHECK(reachability.processes[2].edges.empty());
+}
+
+TEST_CASE("Pruning removes the dead edges")
+{
+    auto document = parse_document(model);
+    const auto pruning = pruneUnreachable(*document);
+    CHECK(pruning.edges == 5);
+    CHECK(pruning.locations == 3);
+    auto& templates = document->getTemplates();
+    CHECK(templates.front().edges.size() == 1);
+    CHECK(templates.front().states.size() == 5);
+    CHECK(templates.back().edges.size() == 1);
+    CHECK(analyseReachability(*document).processes[0].edges.size() == 1);
+}
@@ -0,0 +1,134 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+
+#include "utap/subexpressions.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <map>
+#include <set>
+#include <string>
+
+using namespace UTAP;
+
+static const char* model = R"(
+const int N = 4;
+typedef struct { int len; int data[N]; } buffer_t;
+buffer_t buf[N];
+int q[N];
+int head, i;
+int f(int x) { return x * x + 1; }
+process P(const int[0,N-1] id) {
+  clock x;
+  state A { x <= 5 }, B, C;
+  init A;
+  trans A -> B { guard buf[id].len > 0 && q[head] == id && i * i + head > 3; },
+        A -> C { guard buf[id].len < N && f(i) > 2 && q[head] + 1 > 2; },
+        A -> A { guard f(i) < 10 && i * i + head < 7 && q[head] + 1 < 4; },
+        B -> A { select k : int[0,N-1]; guard q[k] > 0 && x > 1; },
+        B -> C { select k : int[0,N-1]; guard q[k] > 0; };
+}
+system P;
+)";
+
+TEST_CASE("Shared subexpressions of the outgoing guards become temporaries")
+{
+    auto document = Document{};
+    parseXTA(model, &document, true);
+    REQUIRE(!document.hasErrors());
+    auto costs = CostModel{};
+    const auto result = eliminateCommonSubexpressions(document, costs);
+    REQUIRE(result.size() == 1);
+    REQUIRE(result[0].locations.size() == 1);  // nothing is shared at B: k is bound per edge
+    const auto& location = result[0].locations[0];
+    CHECK(location.location->uid.getName() == "A");
+    REQUIRE(location.precompute.size() == 5);
+    CHECK(result[0].temporaries.getSize() == 5);
+
+    auto values = std::map<std::string, std::string>{};
+    auto lazy = std::map<std::string, bool>{};
+    auto computed = std::set<symbol_t>{};
+    for (const auto& temporary : location.precompute) {
+        // every temporary is computed before it is used
+        auto symbols = std::set<symbol_t>{};
+        temporary.value.getSymbols(symbols);
+        for (uint32_t k = 0; k < result[0].temporaries.getSize(); ++k)
+            if (symbols.count(result[0].temporaries[k]))
+                CHECK(computed.count(result[0].temporaries[k]));
+        computed.insert(temporary.symbol);
+        values[temporary.symbol.getName()] = temporary.value.toString();
+        lazy[temporary.symbol.getName()] = temporary.lazy;
+        CHECK(temporary.uses >= 2);
+    }
+    CHECK(values["_t0"] == "i * i + head");
+    CHECK(values["_t1"] == "_t3 + 1");
+    CHECK(values["_t2"] == "buf[id].len");
+    CHECK(values["_t3"] == "q[head]");
+    CHECK(values["_t4"] == "f(i)");
+    CHECK(!lazy["_t0"]);
+    CHECK(lazy["_t2"]);
+    CHECK(lazy["_t4"]);
+
+    REQUIRE(location.guards.size() == 3);
+    CHECK(location.guards[0].second.toString() == "_t2 > 0 && _t3 == id && _t0 > 3");
+    CHECK(location.guards[1].second.toString() == "_t2 < N && _t4 > 2 && _t1 > 2");
+    CHECK(location.guards[2].second.toString() == "_t4 < 10 && _t0 < 7 && _t1 < 4");
+    CHECK(location.invariant.toString() == location.location->invariant.toString());
+
+    // the document is unchanged
+    CHECK(location.guards[0].first->guard.toString() == "buf[id].len > 0 && q[head] == id && i * i + head > 3");
+}
+
+TEST_CASE("Cheap subexpressions are kept")
+{
+    auto document = Document{};
+    parseXTA(model, &document, true);
+    REQUIRE(!document.hasErrors());
+    auto costs = CostModel{};
+    const auto result = eliminateCommonSubexpressions(document, costs, 1000);
+    REQUIRE(result.size() == 1);
+    CHECK(result[0].locations.empty());
+}
+
+TEST_CASE("Subexpressions of quantified variables are kept")
+{
+    auto document = Document{};
+    parseXTA(R"(
+int a[3];
+process P() {
+  state A;
+  init A;
+  trans A -> A { guard forall (k : int[0,2]) a[k] * a[k] > 0; },
+        A -> A { guard (sum (k : int[0,2]) a[k] * a[k]) < 5; };
+}
+system P;
+)",
+             &document, true);
+    REQUIRE(!document.hasErrors());
+    auto costs = CostModel{};
+    const auto result = eliminateCommonSubexpressions(document, costs, 0);
+    REQUIRE(result.size() == 1);
+    // a[k] has no value outside of the quantifiers
+    CHECK(result[0].locations.empty());
+}
@@ -0,0 +1,120 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+/* libutap - Uppaal Timed Automata Parser.
+   Copyright (C) 2023 Aalborg University.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+   USA
+*/
+
+#include "utap/systemview.h"
+#include "utap/utap.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "document_fixture.h"
+
+#include <string>
+
+using namespace UTAP;
+
+static const char* model = R"(
+const int N = 3;
+int a[N], b;
+clock x;
+process P(const int[0,N-1] id, int& r, int start, const int k) {
+  int local = k * 2;
+  state A;
+  init A;
+  trans A -> A { assign r = local + id + k; };
+}
+Q(const int[1,2] i) = P(i, a[i], i * 10, N + 1);
+R = Q(2);
+S = P(0, b, 7, 2);
+system Q, R, S;
+)";
+
+TEST_CASE("Processes are expanded over their unbound parameters")
+{
+    auto document = parse_document(model);
+    const auto view = SystemView{*document};
+    const auto& processes = view.getProcesses();
+    REQUIRE(processes.size() == 4);
+    CHECK(processes[0].name == "Q(1)");
+    CHECK(processes[1].name == "Q(2)");
+    CHECK(processes[2].name == "R");
+    CHECK(processes[3].name == "S");
+    CHECK(processes[1].values == std::vector<int32_t>{2});
+    for (const auto& process : processes)
+        CHECK(process.templ->uid.getName() == "P");
+}
+
+TEST_CASE("Parameters are bound to values and slots")
+{
+    auto document = parse_document(model);
+    const auto view = SystemView{*document};
+    const auto& slots = view.getSlots();
+    const auto& globals = document->getGlobals().frame;
+    const auto a = view.getSlot(SystemView::none, globals[globals.getIndexOf("a")]);
+    const auto b = view.getSlot(SystemView::none, globals[globals.getIndexOf("b")]);
+    REQUIRE(a != SystemView::none);
+    REQUIRE(b != SystemView::none);
+    CHECK(view.getSlot(SystemView::none, globals[globals.getIndexOf("N")]) == SystemView::none);
+    CHECK(slots[a].process == SystemView::none);
+
+    const auto& q2 = view.getProcesses()[1];
+    REQUIRE(q2.parameters.size() == 4);
+    CHECK(q2.parameters[0].kind == SystemView::VALUE);
+    CHECK(q2.parameters[0].value == 2);
+    CHECK(q2.parameters[1].kind == SystemView::REFERENCE);
+    CHECK(q2.parameters[1].slot == a);
+    CHECK(q2.parameters[1].argument.toString() == "a[2]");
+    CHECK(q2.parameters[2].kind == SystemView::VALUE);
+    CHECK(q2.parameters[2].value == 20);
+    CHECK(q2.parameters[2].slot != SystemView::none);
+    CHECK(slots[q2.parameters[2].slot].process == 1);
+    CHECK(q2.parameters[3].value == 4);
+
+    const auto& r = view.getProcesses()[2];
+    CHECK(r.parameters[0].value == 2);
+    CHECK(r.parameters[2].value == 20);
+    CHECK(view.getProcesses()[3].parameters[1].slot == b);
+
+    // Local variables and value parameters have a slot per process
+    const auto& templ = *q2.templ;
+    const auto local = templ.frame[templ.frame.getIndexOf("local")];
+    const auto r_slot = view.getSlot(1, templ.parameters[1]);
+    CHECK(r_slot == a);
+    CHECK(view.getIndex(templ, local) == 4);
+    CHECK(view.getSlot(0, local) != view.getSlot(1, local));
+    CHECK(slots[view.getSlot(1, local)].process == 1);
+    CHECK(view.getSlot(0, templ.parameters[0]) == SystemView::none);
+    // Globals, x and one local and value parameter for each of the four processes
+    CHECK(slots.size() == 3 + 4 * 2);
+}
+
+TEST_CASE("Templates with unbound parameters are expanded")
+{
+    auto document = parse_document(R"(
+process P(const int[0,1] id) { state A; init A; }
+system P;
+)");
+    const auto view = SystemView{*document};
+    REQUIRE(view.getProcesses().size() == 2);
+    CHECK(view.getProcesses()[0].name == "P(0)");
+    CHECK(view.getProcesses()[0].parameters[0].kind == SystemView::VALUE);
+    CHECK(view.getProcesses()[1].parameters[0].value == 1);
+}